@@ -146,8 +146,11 @@ void DirectedAcyclicGraph::orderNodes() {
 		m_nodeOrder.push_back(id);
 	}
 
+	// nodes of the same depth go by id, so the order does not depend on how the hash table iterates
 	std::sort(m_nodeOrder.begin(), m_nodeOrder.end(), [this](id_t i, id_t j) {
-		return m_nodes.find(i)->second.depth < m_nodes.find(j)->second.depth;
+		const uint32_t depthI = m_nodes.find(i)->second.depth;
+		const uint32_t depthJ = m_nodes.find(j)->second.depth;
+		return depthI < depthJ || (depthI == depthJ && i < j);
 	});
 }
 
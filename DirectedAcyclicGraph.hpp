@@ -9,6 +9,8 @@
 #include "util/types.hpp"
 
 class DirectedAcyclicGraph {
+	friend class Checkpoint;
+
 public:
 	struct Node {
 		uint32_t numInputs;
@@ -6,7 +6,20 @@
 #include "util/NumberGenerator.hpp"
 
 #include <iostream>
-#include "rendering/DAGRenderer.hpp"
+
+namespace {
+	// in ascending order, so walking the neuron genes does not depend on how their hash table iterates
+	std::vector<id_t> getNeuronIds(const Genotype& genotype) {
+		std::vector<id_t> neuronIds;
+		neuronIds.reserve(genotype.getNeuronGenes().size());
+		for (const auto& neuronGeneIt : genotype.getNeuronGenes()) {
+			neuronIds.push_back(neuronGeneIt.first);
+		}
+		std::sort(neuronIds.begin(), neuronIds.end());
+
+		return neuronIds;
+	}
+}
 
 GenePool::GenePool(const uint64_t numGenotypes, const uint16_t numInputs, const uint16_t numOutputs)
 	: m_numGenotypes(numGenotypes)
@@ -16,17 +29,22 @@ GenePool::GenePool(const uint64_t numGenotypes, const uint16_t numInputs, const
 	, m_neuronIndex(numOutputs)
 	, m_speciesIndex(0)
 	, m_species()
-	, m_speciesIds()
-	, m_speciesNumberOfNextGeneration()
-	, m_championIds()
 	, m_speciesRecord()
-	, m_genotypeIndex(numGenotypes-1)
+	, m_genotypes()
+	, m_genotypeScores(numGenotypes, 0.0)
+	, m_numSharedSeeds(0)
+	, m_sharedSeedScores()
+	, m_isChampion(numGenotypes, 0)
+	, m_parentSlots(numGenotypes, noParent)
 	, m_generationId(0)
 	, m_genotypeFitnessRecord(0) {
 
+	std::vector<Genotype> genotypes;
+	genotypes.reserve(numGenotypes);
 	for (uint64_t i(0); i < numGenotypes; ++i) {
-		m_genotypes[i] = Genotype(numInputs, numOutputs);
+		genotypes.emplace_back(numInputs, numOutputs);
 	}
+	m_genotypes.replace(std::move(genotypes));
 }
 
 double GenePool::findGeneticDistance(const Genotype &genotype1, const Genotype &genotype2) {
@@ -94,9 +112,8 @@ double GenePool::findGeneticDistance(const Genotype &genotype1, const Genotype &
 	//std::cout << "		Excess: " << numExcessGenes << ", Disjoint: " << numDisjointGenes << ", W: " << weightDifferenceAverage << ", Matching: " << numMatchingGenes << std::endl;
 
 	double biasDifferenceSum = 0;
-	for (const auto& neuronGeneIt1 : genotype1.getNeuronGenes()) {
-		const id_t neuronGeneId = neuronGeneIt1.first;
-		const double bias1 = neuronGeneIt1.second;
+	for (const id_t neuronGeneId : getNeuronIds(genotype1)) {
+		const double bias1 = genotype1.getNeuronGenes().find(neuronGeneId)->second;
 
 		const auto& neuronGeneIt2 = genotype2.getNeuronGenes().find(neuronGeneId);
 		if (neuronGeneIt2 != genotype2.getNeuronGenes().end()) {
@@ -110,29 +127,28 @@ double GenePool::findGeneticDistance(const Genotype &genotype1, const Genotype &
 	return (c1 * numExcessGenes + c2 * numDisjointGenes) / normalizationConstant + c3 * (weightDifferenceAverage + biasDifferenceAverage);
 }
 
-const id_t GenePool::getRandomSpeciesId() const {
+size_t GenePool::getRandomSpeciesIndex() const {
 	uint64_t total = 0;
 	const uint64_t randomRoll = std::floor(NumberGenerator::getASym(m_numGenotypes));
 
-	for (const id_t id : m_speciesIds) {
-		const auto& species = m_species.find(id)->second;
-		uint64_t numGenotypesInSpecies = species.genotypeIds.size();
+	for (size_t i(0); i < m_species.size(); ++i) {
+		uint64_t numGenotypesInSpecies = m_species[i].genotypeSlots.size();
 
 		if (randomRoll >= total && randomRoll < total + numGenotypesInSpecies) {
-			return id;
+			return i;
 		}
 
 		total += numGenotypesInSpecies;
 	}
 
-	std::cerr << "Failed to find random speciesId" << std::endl;
+	std::cerr << "Failed to find random species" << std::endl;
 	return 0;
 }
 
-const std::vector<double> GenePool::getCumulativeFitness(const std::vector<id_t> &genotypeIds) const {
+const std::vector<double> GenePool::getCumulativeFitness(const std::vector<slot_t> &genotypeSlots) const {
 	double minimumFitness = -1;
-	for (const id_t genotypeId : genotypeIds) {
-		const double genotypeFitness = m_genotypeScores.find(genotypeId)->second;
+	for (const slot_t genotypeSlot : genotypeSlots) {
+		const double genotypeFitness = m_genotypeScores[genotypeSlot];
 
 		if (genotypeFitness < minimumFitness || minimumFitness < 0) {
 			minimumFitness = genotypeFitness;
@@ -140,16 +156,16 @@ const std::vector<double> GenePool::getCumulativeFitness(const std::vector<id_t>
 	}
 
 	double totalFitness = 0.0;
-	for (const id_t genotypeId : genotypeIds) {
-		const double genotypeFitness = m_genotypeScores.find(genotypeId)->second - minimumFitness;
+	for (const slot_t genotypeSlot : genotypeSlots) {
+		const double genotypeFitness = m_genotypeScores[genotypeSlot] - minimumFitness;
 		totalFitness += genotypeFitness;
 	}
 
 //	std::cout << "Shares: ";
 	std::vector<double> cumulativeFitness;
 	double partialFitness = 0.0;
-	for (const id_t genotypeId : genotypeIds) {
-		const double genotypeFitness = m_genotypeScores.find(genotypeId)->second - minimumFitness;
+	for (const slot_t genotypeSlot : genotypeSlots) {
+		const double genotypeFitness = m_genotypeScores[genotypeSlot] - minimumFitness;
 		const double genotypeShare = genotypeFitness / totalFitness;
 		partialFitness += genotypeShare;
 		cumulativeFitness.push_back(partialFitness);
@@ -161,57 +177,48 @@ const std::vector<double> GenePool::getCumulativeFitness(const std::vector<id_t>
 }
 
 
-const id_t GenePool::getRandomGenotypeId(const std::vector<id_t> &genotypeIds, const std::vector<double> &cumulativeFitness) const {
+slot_t GenePool::getRandomGenotypeSlot(const std::vector<slot_t> &genotypeSlots, const std::vector<double> &cumulativeFitness) const {
 	double randomValue = NumberGenerator::getASym(1.0);
 
 	for (size_t i = 0; i < cumulativeFitness.size(); ++i) {
 		if (randomValue < cumulativeFitness[i]) {
-			return genotypeIds[i];
+			return genotypeSlots[i];
 		}
 	}
 
 	// Fallback: return the first element
-	return genotypeIds[0];
+	return genotypeSlots[0];
 }
 
-void GenePool::speciate() {
-//	std::cout << "Speciating!" << std::endl;
-
+std::vector<size_t> GenePool::findSpeciesIndices(std::vector<slot_t>& newRepresentativeSlots) const {
 	/*
-	 * For every genotype, go through each species and check the genetic distance between
-	 * the genotype and that species' representative genotype. If the genetic distance is
-	 * within the genetic distance boundary, assign the genotype to that species and stop
-	 * the search.
-	 *
-	 * If no matching species is found, a new species is created with that genotype as its
-	 * representative genotype.
-	 *
-	 * Some of the old species might not recieve any genotypes at all. In that case, they
-	 * will be deleted later, as they have gone extinct.
+	 * Species indices past the existing species are the new species, in order of
+	 * creation, and newRepresentativeSlots receives their representatives. A new
+	 * species takes part in the search for the genotypes after its representative.
 	 */
-	for (const auto& genotypeIt : m_genotypes) {
-		const id_t genotypeId = genotypeIt.first;
-		const auto& genotype = genotypeIt.second;
+	std::vector<size_t> speciesIndices(m_genotypes.size());
+	newRepresentativeSlots.clear();
 
-//		std::cout << "Attempting to determine species of genotype " << genotypeId << std::endl;
+	for (slot_t genotypeSlot(0); genotypeSlot < m_genotypes.size(); ++genotypeSlot) {
+		const auto& genotype = m_genotypes[genotypeSlot];
+
+//		std::cout << "Attempting to determine species of genotype " << genotypeSlot << std::endl;
 
 		/*
 		 * Here is the loop to go through all species.
 		 */
 		bool speciesFound = false;
-		for (auto& speciesIt : m_species) {
+		for (size_t speciesIndex(0); speciesIndex < m_species.size() + newRepresentativeSlots.size(); ++speciesIndex) {
 			// Find representativeGenotype of the species.
-			auto& species = speciesIt.second;
-			const auto& representativeGenotype = species.representativeGenotype;
+			const auto& representativeGenotype = speciesIndex < m_species.size() ? m_species[speciesIndex].representativeGenotype : m_genotypes[newRepresentativeSlots[speciesIndex - m_species.size()]];
 
-//			auto& speciesId = speciesIt.first;
-//			std::cout << "	Comparing to species " << speciesId << std::endl;
+//			std::cout << "	Comparing to species " << speciesIndex << std::endl;
 
 			// Assign the genotype to the species if the geneticDistance is within the threshold.
 			const double geneticDistance = findGeneticDistance(genotype, representativeGenotype);
 			if (geneticDistance <= geneticDistanceBoundary) {
 				speciesFound = true;
-				species.genotypeIds.push_back(genotypeId);
+				speciesIndices[genotypeSlot] = speciesIndex;
 
 //				std::cout << "		Match!" << std::endl;
 				break;
@@ -221,36 +228,128 @@ void GenePool::speciate() {
 		/*
 		 * If no matching species is found, create a new one with the genotype
 		 * as its representative.
-		 *
-		 * Note here that the species index is assigned and then incremented.
 		 */
 		if (!speciesFound) {
-//			std::cout << "	No species found! Creating species " << m_speciesIndex << std::endl;
-
-			Species species;
-			species.genotypeIds.push_back(genotypeId);
-			species.representativeGenotype = genotype;
-			m_species[m_speciesIndex] = species;
-			m_speciesIds.push_back(m_speciesIndex);
-			++m_speciesIndex;
+			speciesIndices[genotypeSlot] = m_species.size() + newRepresentativeSlots.size();
+			newRepresentativeSlots.push_back(genotypeSlot);
 		}
 	}
 
-//	for (auto &speciesIt : m_species) {
-//		const id_t speciesId = speciesIt.first;
-//		auto &species = speciesIt.second;
-//		auto &genotypeIds = species.genotypeIds;
-//		const uint64_t numGenotypesInSpecies = genotypeIds.size();
+	return speciesIndices;
+}
+
+std::vector<id_t> GenePool::findSpeciesIds() const {
+	std::vector<slot_t> newRepresentativeSlots;
+	const std::vector<size_t> speciesIndices = findSpeciesIndices(newRepresentativeSlots);
+
+	std::vector<id_t> speciesIds(speciesIndices.size());
+	for (slot_t genotypeSlot(0); genotypeSlot < speciesIndices.size(); ++genotypeSlot) {
+		const size_t speciesIndex = speciesIndices[genotypeSlot];
+		speciesIds[genotypeSlot] = speciesIndex < m_species.size() ? m_species[speciesIndex].id : m_speciesIndex + static_cast<id_t>(speciesIndex - m_species.size());
+	}
+
+	return speciesIds;
+}
+
+void GenePool::speciate() {
+//	std::cout << "Speciating!" << std::endl;
+
+	/*
+	 * For every genotype, go through each species and check the genetic distance between
+	 * the genotype and that species' representative genotype. If the genetic distance is
+	 * within the genetic distance boundary, assign the genotype to that species and stop
+	 * the search.
+	 *
+	 * If no matching species is found, a new species is created with that genotype as its
+	 * representative genotype.
+	 *
+	 * Some of the old species might not recieve any genotypes at all. In that case, they
+	 * will be deleted later, as they have gone extinct.
+	 */
+	std::vector<slot_t> newRepresentativeSlots;
+	const std::vector<size_t> speciesIndices = findSpeciesIndices(newRepresentativeSlots);
+
+	/*
+	 * Note here that the species index is assigned and then incremented.
+	 */
+	for (const slot_t representativeSlot : newRepresentativeSlots) {
+//		std::cout << "	No species found! Creating species " << m_speciesIndex << std::endl;
+
+		Species species;
+		species.id = m_speciesIndex;
+		species.representativeGenotype = m_genotypes[representativeSlot];
+		m_species.push_back(species);
+		++m_speciesIndex;
+	}
+
+	for (slot_t genotypeSlot(0); genotypeSlot < m_genotypes.size(); ++genotypeSlot) {
+		m_species[speciesIndices[genotypeSlot]].genotypeSlots.push_back(genotypeSlot);
+	}
+
+//	for (auto &species : m_species) {
+//		auto &genotypeSlots = species.genotypeSlots;
+//		const uint64_t numGenotypesInSpecies = genotypeSlots.size();
 //
-//		std::cout << "Species " << speciesId << " has " << numGenotypesInSpecies << " genotypes:" << std::endl;
+//		std::cout << "Species " << species.id << " has " << numGenotypesInSpecies << " genotypes:" << std::endl;
 //
-//		for (const id_t genotypeId : genotypeIds) {
-//			const auto& genotype = m_genotypes[genotypeId];
-//			std::cout << "	" << genotypeId << ": Genetic distance " << findGeneticDistance(genotype, species.representativeGenotype) << " to species representative" << std::endl;
+//		for (const slot_t genotypeSlot : genotypeSlots) {
+//			const auto& genotype = m_genotypes[genotypeSlot];
+//			std::cout << "	" << genotypeSlot << ": Genetic distance " << findGeneticDistance(genotype, species.representativeGenotype) << " to species representative" << std::endl;
 //		}
 //	}
 }
 
+void GenePool::setNumSharedSeeds(const size_t numSharedSeeds) {
+	m_numSharedSeeds = numSharedSeeds;
+	m_sharedSeedScores.assign(m_genotypes.size() * numSharedSeeds, 0.0);
+}
+
+std::vector<double> GenePool::getPairedRanks(const std::vector<slot_t>& genotypeSlots) const {
+	/*
+	 * The genotypes are ranked against each other on every seed separately, and
+	 * the ranks are averaged over the seeds. As all of them played the same seeds,
+	 * a seed that is easy or hard for everyone moves every score alike and does not
+	 * change the ranks. Ranking also keeps a single seed with a very large score
+	 * from outweighing the others, which the mean score does not. Equal scores share
+	 * their average rank.
+	 */
+	const size_t numGenotypes = genotypeSlots.size();
+	std::vector<double> ranks(numGenotypes, 0.0);
+	std::vector<size_t> order(numGenotypes);
+
+	for (size_t seed(0); seed < m_numSharedSeeds; ++seed) {
+		const auto getScore = [this, &genotypeSlots, seed](const size_t i) {
+			return m_sharedSeedScores[genotypeSlots[i] * m_numSharedSeeds + seed];
+		};
+
+		for (size_t i(0); i < numGenotypes; ++i) {
+			order[i] = i;
+		}
+		std::sort(order.begin(), order.end(), [&getScore](const size_t i, const size_t j) {
+			return getScore(i) > getScore(j);
+		});
+
+		for (size_t begin(0); begin < numGenotypes;) {
+			size_t end = begin + 1;
+			while (end < numGenotypes && getScore(order[end]) == getScore(order[begin])) {
+				++end;
+			}
+
+			const double rank = (begin + end - 1) / 2.0;
+			for (size_t i(begin); i < end; ++i) {
+				ranks[order[i]] += rank;
+			}
+			begin = end;
+		}
+	}
+
+	for (double& rank : ranks) {
+		rank /= m_numSharedSeeds;
+	}
+
+	return ranks;
+}
+
 void GenePool::removeWeakerGenotypes() {
 	/*
 	 * Each species will firstly sum the fitnesses of its genotypes to determine the
@@ -276,11 +375,11 @@ void GenePool::removeWeakerGenotypes() {
 	 * one more generation without improvement. Species which do not improve over many
 	 * generations will later be eliminated.
 	 */
-	for (auto &speciesIt : m_species) {
+	uint64_t numRemainingGenotypes = 0;
+	for (auto &species : m_species) {
 		// Species info
-		auto &species = speciesIt.second;
-		auto &genotypeIds = species.genotypeIds;
-		const uint64_t numGenotypesInSpecies = genotypeIds.size();
+		auto &genotypeSlots = species.genotypeSlots;
+		const uint64_t numGenotypesInSpecies = genotypeSlots.size();
 
 		/*
 		 * Here the adjusted species fitness and the top genotype fitness are calculated.
@@ -288,8 +387,8 @@ void GenePool::removeWeakerGenotypes() {
 		double speciesFitness = 0;
 		double topFitnessInGeneration = 0;
 
-		for (const id_t genotypeId : genotypeIds) {
-			const double genotypeFitness = m_genotypeScores[genotypeId];
+		for (const slot_t genotypeSlot : genotypeSlots) {
+			const double genotypeFitness = m_genotypeScores[genotypeSlot];
 			speciesFitness += genotypeFitness;
 
 			topFitnessInGeneration = std::max(topFitnessInGeneration, genotypeFitness);
@@ -298,39 +397,61 @@ void GenePool::removeWeakerGenotypes() {
 
 		species.adjustedFitness = speciesFitness / numGenotypesInSpecies;
 
-		//	const id_t speciesId = speciesIt.first;
-		//	std::cout << "Species " << speciesId << " has unadjusted fitness: " << unadjustedSpeciesFitness << " from " << numGenotypesInSpecies << " genotypes." << std::endl;
+		//	std::cout << "Species " << species.id << " has unadjusted fitness: " << unadjustedSpeciesFitness << " from " << numGenotypesInSpecies << " genotypes." << std::endl;
 
 		/*
 		 * Here we sort the genotypes from highest fitness to lowest fitness.
 		 * The best genotype is declared the champion of the species. Then,
 		 * the worst performing 50% are eliminated.
+		 *
+		 * When every genotype played the same environment seeds, they are sorted by
+		 * their mean rank over the seeds instead, with the mean score breaking ties.
 		 */
-		std::sort(genotypeIds.begin(), genotypeIds.end(), [this](const id_t i, const id_t j) {
-		    return m_genotypeScores[i] > m_genotypeScores[j];
-		});
+		if (m_numSharedSeeds > 0 && numGenotypesInSpecies > 1) {
+			const std::vector<double> pairedRanks = getPairedRanks(genotypeSlots);
 
-		// Crown species champion as the first genotype in the list.
-		species.championId = genotypeIds[0];
+			std::vector<size_t> order(numGenotypesInSpecies);
+			for (size_t i(0); i < numGenotypesInSpecies; ++i) {
+				order[i] = i;
+			}
+			std::sort(order.begin(), order.end(), [this, &pairedRanks, &genotypeSlots](const size_t i, const size_t j) {
+				if (pairedRanks[i] != pairedRanks[j]) {
+					return pairedRanks[i] < pairedRanks[j];
+				}
+				return m_genotypeScores[genotypeSlots[i]] > m_genotypeScores[genotypeSlots[j]];
+			});
+
+			std::vector<slot_t> sortedSlots;
+			sortedSlots.reserve(numGenotypesInSpecies);
+			for (const size_t i : order) {
+				sortedSlots.push_back(genotypeSlots[i]);
+			}
+			genotypeSlots = std::move(sortedSlots);
+		} else {
+			std::sort(genotypeSlots.begin(), genotypeSlots.end(), [this](const slot_t i, const slot_t j) {
+			    return m_genotypeScores[i] > m_genotypeScores[j];
+			});
+		}
+
+		// Crown species champion as the first genotype in the list. A species without genotypes dies out in removeWeakerSpecies.
+		if (!genotypeSlots.empty()) {
+			species.championSlot = genotypeSlots[0];
+		}
 
 //		std::cout << "Scored order: ";
-//		for (const id_t id : genotypeIds) {
-//			std::cout << id << " (" << m_genotypeScores[id] << ")" << "	";
+//		for (const slot_t slot : genotypeSlots) {
+//			std::cout << slot << " (" << m_genotypeScores[slot] << ")" << "	";
 //		}
 //		std::cout << std::endl;
 
+		/*
+		 * The removed genotypes stay in their slots until the next generation replaces
+		 * the whole pool. Dropping them from the species is enough to exclude them from
+		 * mating.
+		 */
 		const size_t keepingIndex = std::ceil(numGenotypesInSpecies / 2.0);
-		const int genotypesToRemove = numGenotypesInSpecies - keepingIndex;
-
-//		std::cout << "	Erasing genotypes: ";
-		for (int i(0); i < genotypesToRemove; ++i) {
-			const id_t genotypeId = genotypeIds.back();
-			genotypeIds.pop_back();
-			m_genotypes.erase(genotypeId);
-			m_genotypeScores.erase(genotypeId);
-//			std::cout << genotypeId << " ";
-		}
-//		std::cout << std::endl;
+		genotypeSlots.resize(keepingIndex);
+		numRemainingGenotypes += keepingIndex;
 
 		/*
 		 * Here, the species tracks its current fitness in comparison to
@@ -347,14 +468,14 @@ void GenePool::removeWeakerGenotypes() {
 	/*
 	 * Species record.
 	 */
-	m_speciesRecord.emplace_back();
-	m_speciesRecord.back().reserve(m_species.size());
-	for (auto &speciesIt : m_species) {
-		auto &species = speciesIt.second;
-		const uint64_t numGenotypesInSpecies = species.genotypeIds.size();
+	std::vector<double> speciesShares;
+	speciesShares.reserve(m_species.size());
+	for (const auto &species : m_species) {
+		const uint64_t numGenotypesInSpecies = species.genotypeSlots.size();
 
-		m_speciesRecord.back().push_back(static_cast<double>(numGenotypesInSpecies) / static_cast<double>(m_genotypes.size()));
+		speciesShares.push_back(static_cast<double>(numGenotypesInSpecies) / static_cast<double>(numRemainingGenotypes));
 	}
+	m_speciesRecord.push(speciesShares);
 }
 
 template <typename T>
@@ -371,39 +492,29 @@ void GenePool::removeWeakerSpecies() {
 	 * which seem to be progressing. There is now the possibility that all species
 	 * will die out, resulting in the failure of the program.
 	 */
-	const size_t startingNumOfSpecies = m_speciesIds.size();
-	size_t removed = 0;
-	for (size_t i(0); i < startingNumOfSpecies - removed;) {
-		const id_t speciesId = m_speciesIds[i];
-
-		const bool speciesIsExtinct = m_species[speciesId].genotypeIds.size() == 0;
-		const bool speciesIsNotImproving = m_species[speciesId].generationsWithoutImprovement >= 15;
+	const auto speciesIsRemoved = [this](const Species& species) {
+		const bool speciesIsExtinct = species.genotypeSlots.size() == 0;
+		const bool speciesIsNotImproving = species.generationsWithoutImprovement >= 15;
 		bool speciesIsNotImprovingAndBad = false;
 
 		if (speciesIsNotImproving) {
-			const double topGenerationFitness = m_species[speciesId].speciesGenotypeFitnessRecord;
+			const double topGenerationFitness = species.speciesGenotypeFitnessRecord;
 
 			if (topGenerationFitness < 0.9*m_genotypeFitnessRecord) {
 				speciesIsNotImprovingAndBad = true;
 			}
 		}
 
-		// || m_species[speciesId].generationsWithoutImprovement >= 15
-		if (speciesIsExtinct || speciesIsNotImprovingAndBad) {
-
-//			std::cout << "Deleted a species with top fitness: " << m_species[speciesId].speciesGenotypeFitnessRecord << " / " << m_genotypeFitnessRecord << " and " << m_species[speciesId].genotypeIds.size() << " genotypes." << std::endl;
+//		if (speciesIsExtinct || speciesIsNotImprovingAndBad) {
+//			std::cout << "Deleted a species with top fitness: " << species.speciesGenotypeFitnessRecord << " / " << m_genotypeFitnessRecord << " and " << species.genotypeSlots.size() << " genotypes." << std::endl;
+//		}
 
-			std::swap(m_speciesIds[i], m_speciesIds.back());
-			m_speciesIds.pop_back();
-			m_species.erase(speciesId);
-			++removed;
+		// || species.generationsWithoutImprovement >= 15
+		return speciesIsExtinct || speciesIsNotImprovingAndBad;
+	};
 
-//			std::cout << speciesId << " ";
-		} else {
-			++i;
-		}
-	}
-//	std::cout << std::endl;
+	// the survivors keep their order of creation
+	m_species.erase(std::remove_if(m_species.begin(), m_species.end(), speciesIsRemoved), m_species.end());
 
 	if (m_species.size() == 0) {
 		std::cerr << "Extinction!" << std::endl;
@@ -424,11 +535,9 @@ void GenePool::assignOffspringToSpecies() {
 	 */
 //	std::cout << "Species fitnesses: ";
 	double genePoolAdjustedFitness = 0;
-	for (const auto &speciesIt : m_species) {
-//		const id_t speciesId = speciesIt.first;
-		const auto &species = speciesIt.second;
+	for (const auto &species : m_species) {
 		genePoolAdjustedFitness += species.adjustedFitness;
-//		std::cout << species.totalFitness << " (" << speciesId << ") ";
+//		std::cout << species.adjustedFitness << " (" << species.id << ") ";
 	}
 //	std::cout << std::endl;
 
@@ -437,14 +546,10 @@ void GenePool::assignOffspringToSpecies() {
 	 * with its share of the total adjusted fitness.
 	 */
 //	std::cout << "Species offspring: ";
-	m_speciesNumberOfNextGeneration.clear();
-	for (const auto &speciesIt : m_species) {
-		const id_t speciesId = speciesIt.first;
-		const auto &species = speciesIt.second;
-
+	for (auto &species : m_species) {
 		const uint64_t number = std::floor(species.adjustedFitness / genePoolAdjustedFitness * m_numGenotypes);
-		m_speciesNumberOfNextGeneration[speciesId] = number;
-//		std::cout << number << " (" << speciesId << ") ";
+		species.numberOfNextGeneration = number;
+//		std::cout << number << " (" << species.id << ") ";
 	}
 //	std::cout << std::endl;
 
@@ -452,28 +557,24 @@ void GenePool::assignOffspringToSpecies() {
 	 * Here the last few left over genotypes are allotted randomly.
 	 */
 	uint64_t unadjustedNumber = 0;
-	for (const auto &numberIt : m_speciesNumberOfNextGeneration) {
-		const uint64_t number = numberIt.second;
-		unadjustedNumber += number;
+	for (const auto &species : m_species) {
+		unadjustedNumber += species.numberOfNextGeneration;
 	}
 	const int numberDifference = m_numGenotypes - unadjustedNumber;
 //	std::cout << "Has crudely alloted " << unadjustedNumber << " genotypes to the next generation!" << std::endl;
 
-	auto it = m_speciesNumberOfNextGeneration.begin();
-	for (int i(0); i < std::abs(numberDifference); ++i) {
-		++it->second;
-		it++;
+	for (int i(0); i < std::abs(numberDifference) && !m_species.empty(); ++i) {
+		++m_species[i % m_species.size()].numberOfNextGeneration;
 	}
 
 	//TODO: fixa om ingen förbättring på 20 generationer så får bara två arter fortplantas
 
 //	uint64_t adjustedNumber = 0;
-//	for (const auto &numberIt : m_speciesNumberOfNextGeneration) {
-//		const uint64_t number = numberIt.second;
+//	for (const auto &species : m_species) {
+//		const uint64_t number = species.numberOfNextGeneration;
 //		adjustedNumber += number;
 //
-//		const id_t speciesId = numberIt.first;
-//		std::cout << "	Species " << speciesId << " has been allotted " << number << " offspring" << std::endl;
+//		std::cout << "	Species " << species.id << " has been allotted " << number << " offspring" << std::endl;
 //	}
 //	std::cout << "Has adjusted and allotted " << adjustedNumber << " genotypes to the next generation!" << std::endl;
 //
@@ -488,7 +589,7 @@ void GenePool::mateGenotypes() {
 	 * in the next generation.
 	 *
 	 * Before this, however, the species champions from species with 5 or more genotypyes
-	 * are copied directly into the next generation. Their ids are also stored to spare
+	 * are copied directly into the next generation. Their slots are also flagged to spare
 	 * them from later mutations.
 	 *
 	 * The remaining allotted slots for each species are then to be filled from the offspring
@@ -510,48 +611,46 @@ void GenePool::mateGenotypes() {
 	 * these representatives therefore come from the current ("old") generation. The genotypes
 	 * of the next generation will not be assigned to any species until after their evaluation.
 	 */
-	std::unordered_map<id_t, Genotype> nextGenotypes;
+	std::vector<Genotype> nextGenotypes;
+	nextGenotypes.reserve(m_numGenotypes);
+	std::vector<slot_t> nextParentSlots;
+	nextParentSlots.reserve(m_numGenotypes);
 
 	/*
-	 * Here we copy over each champion unchanged.
+	 * Here we copy over each champion unchanged. Champions take the first slots of
+	 * the next generation.
 	 */
-	m_championIds.clear();
-	for (const auto &speciesIt : m_species) {
-		const id_t speciesId = speciesIt.first;
-		const Species& species = speciesIt.second;
+	for (auto &species : m_species) {
+		// species.genotypeSlots.size() >= 5 &&
+		if (species.genotypeSlots.size() >= 5 && species.numberOfNextGeneration > 0) {
+			const slot_t speciesChampionSlot = species.championSlot;
 
-		// species.genotypeIds.size() >= 5 &&
-		if (species.genotypeIds.size() >= 5 && m_speciesNumberOfNextGeneration.find(speciesId)->second > 0) {
-			const id_t speciesChampionId = species.championId;
+			nextGenotypes.push_back(m_genotypes[speciesChampionSlot]);
+			nextParentSlots.push_back(speciesChampionSlot);
+			--species.numberOfNextGeneration;
 
-			nextGenotypes[speciesChampionId] = m_genotypes[speciesChampionId];
-			--m_speciesNumberOfNextGeneration.find(speciesId)->second;
-
-			m_championIds.insert(speciesChampionId);
-//			std::cout << "	Saving champion " << speciesChampionId << " with score: " << m_genotypeScores[speciesChampionId] << " from species " << speciesId << std::endl;
+//			std::cout << "	Saving champion " << speciesChampionSlot << " with score: " << m_genotypeScores[speciesChampionSlot] << " from species " << species.id << std::endl;
 		}
 	}
+	const size_t numChampions = nextGenotypes.size();
 
 	/*
 	 * Creating m_numGenotypes new genotypes through crossover
 	 */
-	for (const auto &numberIt : m_speciesNumberOfNextGeneration) {
-		const uint64_t allottedGenotypesForSpecies = numberIt.second;
-
-		const uint64_t firstParentSpeciesId = numberIt.first;
-		const auto& firstParentSpecies = m_species[firstParentSpeciesId];
+	for (const auto &firstParentSpecies : m_species) {
+		const uint64_t allottedGenotypesForSpecies = firstParentSpecies.numberOfNextGeneration;
 
-		const auto& firstParentSpeciesCumulativeFitness = getCumulativeFitness(firstParentSpecies.genotypeIds);
+		const auto& firstParentSpeciesCumulativeFitness = getCumulativeFitness(firstParentSpecies.genotypeSlots);
 
 		for (uint64_t i(0); i < allottedGenotypesForSpecies; ++i) {
-			++m_genotypeIndex;
+			const slot_t childSlot = nextGenotypes.size();
 
 			// Selecting the first parent genotype at random
-			const uint64_t firstParentGenotypeId = getRandomGenotypeId(firstParentSpecies.genotypeIds, firstParentSpeciesCumulativeFitness);
-			const auto& firstParentGenotype = m_genotypes[firstParentGenotypeId];
-			const double firstParentFitness = m_genotypeScores[firstParentGenotypeId];
+			const slot_t firstParentGenotypeSlot = getRandomGenotypeSlot(firstParentSpecies.genotypeSlots, firstParentSpeciesCumulativeFitness);
+			const auto& firstParentGenotype = m_genotypes[firstParentGenotypeSlot];
+			const double firstParentFitness = m_genotypeScores[firstParentGenotypeSlot];
 
-//			std::cout << "First parent is " << firstParentGenotypeId << " (" << m_genotypeScores[firstParentGenotypeId] << ") " <<" of species " << firstParentSpeciesId << ", ";
+//			std::cout << "First parent is " << firstParentGenotypeSlot << " (" << m_genotypeScores[firstParentGenotypeSlot] << ") " <<" of species " << firstParentSpecies.id << ", ";
 
 			// Selecting the second parent using a random crossover type
 			const double rollForCrossover = NumberGenerator::getASym(1.0);
@@ -559,56 +658,63 @@ void GenePool::mateGenotypes() {
 			// No crossover
 			if (rollForCrossover >= 1.0 - noCrossoverProbability) {
 //				std::cout << "no crossover";
-				nextGenotypes[m_genotypeIndex] = firstParentGenotype;
+				nextGenotypes.push_back(firstParentGenotype);
+				nextParentSlots.push_back(firstParentGenotypeSlot);
 			} else {
 
-				id_t secondParentGenotypeId;
+				slot_t secondParentGenotypeSlot;
 
 				// Interspecies crossover: choose any genotype for the second parent
 				if (rollForCrossover < interspeciesCrossoverProbability) {
-					const id_t secondParentSpeciesId = m_speciesIds[std::floor(NumberGenerator::getASym(m_speciesIds.size()))];
-					const auto& secondParentSpecies = m_species[secondParentSpeciesId];
+					const auto& secondParentSpecies = m_species[std::floor(NumberGenerator::getASym(m_species.size()))];
 
-					const auto& secondParentSpeciesCumulativeFitness = getCumulativeFitness(secondParentSpecies.genotypeIds);
-					secondParentGenotypeId = getRandomGenotypeId(secondParentSpecies.genotypeIds, secondParentSpeciesCumulativeFitness);
+					const auto& secondParentSpeciesCumulativeFitness = getCumulativeFitness(secondParentSpecies.genotypeSlots);
+					secondParentGenotypeSlot = getRandomGenotypeSlot(secondParentSpecies.genotypeSlots, secondParentSpeciesCumulativeFitness);
 
-//					std::cout << "Second parent (interspecies) is " << secondParentGenotypeId << " of species " << secondParentSpeciesId;
+//					std::cout << "Second parent (interspecies) is " << secondParentGenotypeSlot << " of species " << secondParentSpecies.id;
 				} // Intraspecies crossover: choose a genotype from the same species for the second parent
 				else {
-					secondParentGenotypeId = getRandomGenotypeId(firstParentSpecies.genotypeIds, firstParentSpeciesCumulativeFitness);
-//					std::cout << "Second parent is " << secondParentGenotypeId << " of species " << firstParentSpeciesId;
+					secondParentGenotypeSlot = getRandomGenotypeSlot(firstParentSpecies.genotypeSlots, firstParentSpeciesCumulativeFitness);
+//					std::cout << "Second parent is " << secondParentGenotypeSlot << " of species " << firstParentSpecies.id;
 				}
 
-				const auto& secondParentGenotype = m_genotypes[secondParentGenotypeId];
-				const double secondParentFitness = m_genotypeScores[secondParentGenotypeId];
+				const auto& secondParentGenotype = m_genotypes[secondParentGenotypeSlot];
+				const double secondParentFitness = m_genotypeScores[secondParentGenotypeSlot];
 
+				// the gene picks of the crossover depend only on the child, not on the order of creation
+				NumberGenerator::ScopedStream stream(m_generationId, childSlot, NumberGenerator::Purpose::Crossover);
 				if (firstParentFitness > secondParentFitness) {
-					nextGenotypes[m_genotypeIndex] = Genotype(firstParentGenotype, secondParentGenotype);
+					nextGenotypes.emplace_back(firstParentGenotype, secondParentGenotype);
+					nextParentSlots.push_back(firstParentGenotypeSlot);
 				} else {
-					nextGenotypes[m_genotypeIndex] = Genotype(secondParentGenotype, firstParentGenotype);
+					nextGenotypes.emplace_back(secondParentGenotype, firstParentGenotype);
+					nextParentSlots.push_back(secondParentGenotypeSlot);
 				}
 			}
 
 //			std::cout << ". Roll was: " << rollForCrossover << std::endl;
-//			std::cout << "	Created child " << m_genotypeIndex << std::endl;
+//			std::cout << "	Created child " << childSlot << std::endl;
 		}
 	}
 
 	// set new species representatives
-	for (auto& speciesIt : m_species) {
-//		auto& speciesId = speciesIt.first;
-		auto& species = speciesIt.second;
-		if (species.genotypeIds.size() > 0) {
-			const id_t representativeGenotypeId = species.genotypeIds[std::floor(NumberGenerator::getASym(species.genotypeIds.size()))];
-			species.representativeGenotype = m_genotypes[representativeGenotypeId];
-
-//			std::cout << "New representative for species " << speciesId << " is genotype " << representativeGenotypeId << std::endl;
-			species.genotypeIds.clear();
+	for (auto& species : m_species) {
+		if (species.genotypeSlots.size() > 0) {
+			const slot_t representativeGenotypeSlot = species.genotypeSlots[std::floor(NumberGenerator::getASym(species.genotypeSlots.size()))];
+			species.representativeGenotype = m_genotypes[representativeGenotypeSlot];
+
+//			std::cout << "New representative for species " << species.id << " is genotype " << representativeGenotypeSlot << std::endl;
+			species.genotypeSlots.clear();
 		}
 	}
 
-	m_genotypes = nextGenotypes;
-	m_genotypeScores.clear();
+	m_genotypes.replace(std::move(nextGenotypes));
+	m_parentSlots = std::move(nextParentSlots);
+
+	m_genotypeScores.assign(m_genotypes.size(), 0.0);
+	m_sharedSeedScores.assign(m_genotypes.size() * m_numSharedSeeds, 0.0);
+	m_isChampion.assign(m_genotypes.size(), 0);
+	std::fill(m_isChampion.begin(), m_isChampion.begin() + numChampions, 1);
 }
 
 void GenePool::mutateGenotypes() {
@@ -630,25 +736,28 @@ void GenePool::mutateGenotypes() {
 	 *
 	 * After these structural mutations have been applied, every synapse in every genotype has
 	 * a probability of shifting its weight a little, and every node its bias.
+	 *
+	 * Each step draws its random numbers from a stream derived from the generation and the
+	 * genotype slot, so the outcome does not depend on the order the genotypes are visited in.
 	 */
 
-	std::unordered_map<innov_t,std::vector<id_t>> synapseSplitMutations;
-	std::unordered_map<std::pair<id_t, id_t>, std::vector<id_t>, SzudzikHash> growSynapseMutations;
+	std::unordered_map<innov_t,std::vector<slot_t>> synapseSplitMutations;
+	std::unordered_map<std::pair<id_t, id_t>, std::vector<slot_t>, SzudzikHash> growSynapseMutations;
 
 	// track all structural mutations
-	for (auto& genotypeIt : m_genotypes) {
-		const id_t genotypeId = genotypeIt.first;
-		const auto& genotype = genotypeIt.second;
+	for (slot_t genotypeSlot(0); genotypeSlot < m_genotypes.size(); ++genotypeSlot) {
+		const auto& genotype = m_genotypes[genotypeSlot];
 
 		// champions should be unchanged
-		if (m_championIds.count(genotypeId)) {
-//			std::cout << "Champion " << genotypeId << " is not mutated structurally" << std::endl;
+		if (m_isChampion[genotypeSlot]) {
+//			std::cout << "Champion " << genotypeSlot << " is not mutated structurally" << std::endl;
 			continue;
 		}
 
+		NumberGenerator::ScopedStream stream(m_generationId, genotypeSlot, NumberGenerator::Purpose::StructuralMutation);
 		double rollForGrowSynapseMutation = NumberGenerator::getASym(1.0);
 		double rollForSplitSynapseMutation = NumberGenerator::getASym(1.0);
-//		std::cout << "Structural mutation step for new genotype " << genotypeId << " with rolls " << rollForGrowSynapseMutation << " (grow synapse) and " << rollForSplitSynapseMutation << " (split synapse)" << std::endl;
+//		std::cout << "Structural mutation step for new genotype " << genotypeSlot << " with rolls " << rollForGrowSynapseMutation << " (grow synapse) and " << rollForSplitSynapseMutation << " (split synapse)" << std::endl;
 
 		// grow synapse mutation
 		if (rollForGrowSynapseMutation <= growSynapseProbability) {
@@ -658,7 +767,7 @@ void GenePool::mutateGenotypes() {
 			if (neuronIds.first < -m_numInputs && neuronIds.second < -m_numInputs) {
 //				std::cout << "Failed to find connectable neurons!" << std::endl;
 			} else {
-				growSynapseMutations[neuronIds].push_back(genotypeId);
+				growSynapseMutations[neuronIds].push_back(genotypeSlot);
 			}
 		}
 
@@ -669,7 +778,7 @@ void GenePool::mutateGenotypes() {
 			const auto& it = genotype.getSynapseGenes().find(randomSynapseGeneId);
 			if (it != genotype.getSynapseGenes().end()) {
 //				std::cout << "	Splitting synapse gene " << randomSynapseGeneId << std::endl;
-				synapseSplitMutations[randomSynapseGeneId].push_back(genotypeId);
+				synapseSplitMutations[randomSynapseGeneId].push_back(genotypeSlot);
 			}
 		}
 	}
@@ -677,14 +786,15 @@ void GenePool::mutateGenotypes() {
 	// apply the split synapse mutations
 	for (const auto& synapseSplitIt : synapseSplitMutations) {
 		const innov_t synapseToSplitId = synapseSplitIt.first;
-		const auto& genotypeIds = synapseSplitIt.second;
+		const auto& genotypeSlots = synapseSplitIt.second;
 
 //		std::cout << "Splitting synapse " << synapseToSplitId << " in genotypes: ";
 
-		for (const id_t genotypeId : genotypeIds) {
-//			std::cout << genotypeId << " ";
+		for (const slot_t genotypeSlot : genotypeSlots) {
+//			std::cout << genotypeSlot << " ";
 
-			auto& genotype = m_genotypes[genotypeId];
+			auto& genotype = m_genotypes[genotypeSlot];
+			NumberGenerator::ScopedStream stream(m_generationId, genotypeSlot, NumberGenerator::Purpose::SplitSynapse);
 			genotype.splitSynapse(m_innovationIndex+1, m_innovationIndex+2, m_neuronIndex, synapseToSplitId);
 		}
 		++m_neuronIndex;
@@ -698,41 +808,42 @@ void GenePool::mutateGenotypes() {
 		const std::pair<id_t, id_t>& neuronIds = growSynapseIt.first;
 		const id_t startId = neuronIds.first;
 		const id_t endId = neuronIds.second;
-		const auto& genotypeIds = growSynapseIt.second;
+		const auto& genotypeSlots = growSynapseIt.second;
 
 //		std::cout << "Growing synapse " << startId << " -> " << endId << " in genotypes: ";
 
 		++m_innovationIndex;
-		for (const id_t genotypeId : genotypeIds) {
-//			std::cout << genotypeId << " ";
+		for (const slot_t genotypeSlot : genotypeSlots) {
+//			std::cout << genotypeSlot << " ";
 
-			auto& genotype = m_genotypes[genotypeId];
+			auto& genotype = m_genotypes[genotypeSlot];
+			NumberGenerator::ScopedStream stream(m_generationId, genotypeSlot, NumberGenerator::Purpose::GrowSynapse);
 			genotype.addSynapseGene(m_innovationIndex, Genotype::getRandomWeight(), startId, endId);
 		}
 //		std::cout << std::endl;
 	}
 
 	// mutate weights and biases
-	for (auto& genotypeIt : m_genotypes) {
-		const id_t genotypeId = genotypeIt.first;
-		auto& genotype = genotypeIt.second;
+	for (slot_t genotypeSlot(0); genotypeSlot < m_genotypes.size(); ++genotypeSlot) {
+		auto& genotype = m_genotypes[genotypeSlot];
 
 		// champions should be unchanged
-		if (m_championIds.count(genotypeId)) {
-//			std::cout << "Champion " << genotypeId << " has its weights unchanged" << std::endl;
+		if (m_isChampion[genotypeSlot]) {
+//			std::cout << "Champion " << genotypeSlot << " has its weights unchanged" << std::endl;
 			continue;
 		}
 
-//		std::cout << "Weight mutation step for " << genotypeId << std::endl;
+//		std::cout << "Weight mutation step for " << genotypeSlot << std::endl;
+		NumberGenerator::ScopedStream stream(m_generationId, genotypeSlot, NumberGenerator::Purpose::WeightMutation);
 		double rollForMutation;
 
 //		std::cout << "	Mutating synapses: ";
-		for (const auto& synapseGeneIt : genotype.getSynapseGenes()) {
+		// by innovation and neuron id, so a genotype restored from a checkpoint mutates the same way
+		for (const innov_t synapseGeneId : genotype.getInnovations()) {
 			rollForMutation =  NumberGenerator::getASym(1.0);
 
 			if (rollForMutation <= mutateSynapseWeightProbability) {
-				const innov_t synapseGeneId = synapseGeneIt.first;
-				const auto& synapseGene = synapseGeneIt.second;
+				const auto& synapseGene = genotype.getSynapseGenes().find(synapseGeneId)->second;
 
 //				std::cout << synapseGeneId << " ";
 
@@ -749,15 +860,14 @@ void GenePool::mutateGenotypes() {
 		}
 //		std::cout << std::endl;
 
-//		std::cout << "Bias mutation step for " << genotypeId << std::endl;
+//		std::cout << "Bias mutation step for " << genotypeSlot << std::endl;
 
 //		std::cout << "	Mutating neurons: ";
-		for (const auto &neuronGeneIt : genotype.getNeuronGenes()) {
+		for (const id_t neuronGeneId : getNeuronIds(genotype)) {
 			rollForMutation = NumberGenerator::getASym(1.0);
 
 			if (rollForMutation <= mutateNeuronBiasProbability) {
-				const id_t neuronGeneId = neuronGeneIt.first;
-				const double oldBias = neuronGeneIt.second;
+				const double oldBias = genotype.getNeuronGenes().find(neuronGeneId)->second;
 
 //				std::cout << neuronGeneId << " ";
 
@@ -792,8 +902,7 @@ void GenePool::constructNextGeneration() {
 
 	mutateGenotypes();
 
-	for (auto& genotypeIt : m_genotypes) {
-		auto& genotype = genotypeIt.second;
+	for (auto& genotype : m_genotypes) {
 		genotype.orderNodes();
 	}
 
@@ -2,21 +2,31 @@
 #define NEAT_GENEPOOL_HPP_
 
 #include <unordered_map>
-#include <map>
+#include <vector>
 
 #include "util/types.hpp"
+#include "util/SlotPool.hpp"
+#include "util/History.hpp"
 #include "Genotype.hpp"
 
-#include <SFML/Graphics.hpp>
-
 class GenePool {
+	friend class Checkpoint;
+	friend class GenerationLog;
+
+public:
+	using GenotypeHandle = SlotPool<Genotype>::Handle;
+
+	static constexpr slot_t noParent = std::numeric_limits<slot_t>::max();
+
 private:
 	struct Species {
-		std::vector<id_t> genotypeIds;
+		id_t id;
+		std::vector<slot_t> genotypeSlots;
 		Genotype representativeGenotype;
 
-		id_t championId;
+		slot_t championSlot;
 		double adjustedFitness;
+		uint64_t numberOfNextGeneration = 0;
 
 		double speciesGenotypeFitnessRecord = 0;
 		uint64_t generationsWithoutImprovement = 0;
@@ -44,15 +54,15 @@ private:
 	innov_t m_neuronIndex;
 
 	id_t m_speciesIndex;
-	std::map<id_t, Species> m_species;
-	std::vector<id_t> m_speciesIds;
-	std::unordered_map<id_t, uint64_t> m_speciesNumberOfNextGeneration;
-	std::unordered_set<id_t> m_championIds;
-	std::vector<std::vector<double>> m_speciesRecord;
+	std::vector<Species> m_species; // in order of creation
+	History m_speciesRecord; // the share of the genotypes every species has, per generation
 
-	id_t m_genotypeIndex;
-	std::unordered_map<id_t, Genotype> m_genotypes;
-	std::unordered_map<id_t, double> m_genotypeScores;
+	SlotPool<Genotype> m_genotypes;
+	std::vector<double> m_genotypeScores;
+	size_t m_numSharedSeeds;
+	std::vector<double> m_sharedSeedScores;
+	std::vector<uint8_t> m_isChampion;
+	std::vector<slot_t> m_parentSlots;
 
 	uint64_t m_generationId;
 
@@ -62,9 +72,12 @@ public:
 	static double findGeneticDistance(const Genotype& genotype1, const Genotype& genotype2);
 
 private:
-	const id_t getRandomSpeciesId() const;
-	const std::vector<double> getCumulativeFitness(const std::vector<id_t>& genotypeIds) const;
-	const id_t getRandomGenotypeId(const std::vector<id_t>& genotypeIds, const std::vector<double> &cumulativeFitness) const;
+	size_t getRandomSpeciesIndex() const;
+	const std::vector<double> getCumulativeFitness(const std::vector<slot_t>& genotypeSlots) const;
+	slot_t getRandomGenotypeSlot(const std::vector<slot_t>& genotypeSlots, const std::vector<double> &cumulativeFitness) const;
+
+	std::vector<size_t> findSpeciesIndices(std::vector<slot_t>& newRepresentativeSlots) const;
+	std::vector<double> getPairedRanks(const std::vector<slot_t>& genotypeSlots) const;
 
 	void speciate();
 	void removeWeakerGenotypes();
@@ -78,24 +91,64 @@ public:
 
 	void constructNextGeneration();
 
-	const std::unordered_map<id_t, Genotype>& getGenotypes() const {
+	const SlotPool<Genotype>& getGenotypes() const {
 		return m_genotypes;
 	}
 
-	std::unordered_map<id_t, Genotype>& getGenotypes() {
+	SlotPool<Genotype>& getGenotypes() {
 		return m_genotypes;
 	}
 
-	void setGenotypeScores(const std::unordered_map<id_t, double> &genotypeScores) {
-		m_genotypeScores = genotypeScores;
+	/*
+	 * Scores are indexed by genotype slot and are written in place by the scoring.
+	 */
+	const std::vector<double>& getGenotypeScores() const {
+		return m_genotypeScores;
+	}
+
+	std::vector<double>& getGenotypeScores() {
+		return m_genotypeScores;
+	}
+
+	/*
+	 * With common random numbers, the score of every genotype on each of the shared
+	 * environment seeds, at slot * getNumSharedSeeds() + seed. Selection then ranks
+	 * the genotypes of a species seed by seed instead of by their mean score alone.
+	 */
+	void setNumSharedSeeds(const size_t numSharedSeeds);
+
+	size_t getNumSharedSeeds() const {
+		return m_numSharedSeeds;
 	}
 
+	std::vector<double>& getSharedSeedScores() {
+		return m_sharedSeedScores;
+	}
+
+	const std::vector<double>& getSharedSeedScores() const {
+		return m_sharedSeedScores;
+	}
+
+	/*
+	 * For every genotype, the slot its structure was inherited from (the fitter
+	 * parent) in the previous generation, or noParent in the first generation.
+	 */
+	const std::vector<slot_t>& getParentSlots() const {
+		return m_parentSlots;
+	}
+
+	/*
+	 * The id of the species every genotype will join when the generation is speciated
+	 * after scoring. Genotypes that start a new species get the id it will be given.
+	 */
+	std::vector<id_t> findSpeciesIds() const;
+
 	double getGenotypeFitnessRecord() const {
 		return m_genotypeFitnessRecord;
 	}
 
 public:
-	const std::vector<std::vector<double> >& getSpeciesRecord() const {
+	const History& getSpeciesRecord() const {
 		return m_speciesRecord;
 	}
 };
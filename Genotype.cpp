@@ -1,5 +1,9 @@
 #include "Genotype.hpp"
 
+#include <cstring>
+
+#include "util/Hash.hpp"
+
 #include <iostream>
 
 double Genotype::getRandomWeight() {
@@ -253,3 +257,59 @@ const std::pair<id_t, id_t> Genotype::findConnectableNeurons(const uint64_t numI
 
 	return std::make_pair(-numInputs-1, -numInputs-1);
 }
+
+uint64_t Genotype::getStructuralHash() const {
+	/*
+	 * The node order is hashed in sequence, since it decides the execution order. The
+	 * connections are added up instead, so the order the synapse genes happen to be
+	 * stored in does not matter. A node without outgoing connections is an output even
+	 * when all of them are disabled, so that is hashed with the node.
+	 */
+	const auto& nodes = getNodes();
+
+	uint64_t hash = 0;
+	for (const id_t nodeId : getNodeOrder()) {
+		const uint64_t isOutput = nodes.find(nodeId)->second.outputNodeIds.empty();
+		hash = hashCombine(hash, (static_cast<uint64_t>(static_cast<uint32_t>(nodeId)) << 1) | isOutput);
+	}
+
+	uint64_t connectionHash = 0;
+	for (const auto& synapseGeneIt : m_synapseGenes) {
+		const SynapseGene& synapseGene = synapseGeneIt.second;
+		if (synapseGene.isEnabled()) {
+			const auto& inputOutputIds = synapseGene.getInputOutputIds();
+			connectionHash += mix64((static_cast<uint64_t>(static_cast<uint32_t>(inputOutputIds.first)) << 32) | static_cast<uint32_t>(inputOutputIds.second));
+		}
+	}
+
+	return hashCombine(hash, connectionHash);
+}
+
+uint64_t Genotype::getContentHash() const {
+	// the values are hashed by their bits, so only exactly equal weights and biases match
+	uint64_t hash = getStructuralHash();
+
+	for (const id_t nodeId : getNodeOrder()) {
+		const auto& neuronGeneIt = m_neuronGenes.find(nodeId);
+		const double bias = neuronGeneIt != m_neuronGenes.end() ? neuronGeneIt->second : 0.0;
+
+		uint64_t biasBits;
+		std::memcpy(&biasBits, &bias, sizeof(biasBits));
+		hash = hashCombine(hash, biasBits);
+	}
+
+	uint64_t weightHash = 0;
+	for (const auto& synapseGeneIt : m_synapseGenes) {
+		const SynapseGene& synapseGene = synapseGeneIt.second;
+		if (synapseGene.isEnabled()) {
+			const auto& inputOutputIds = synapseGene.getInputOutputIds();
+			const double weight = synapseGene.getWeight();
+
+			uint64_t weightBits;
+			std::memcpy(&weightBits, &weight, sizeof(weightBits));
+			weightHash += hashCombine((static_cast<uint64_t>(static_cast<uint32_t>(inputOutputIds.first)) << 32) | static_cast<uint32_t>(inputOutputIds.second), weightBits);
+		}
+	}
+
+	return hashCombine(hash, weightHash);
+}
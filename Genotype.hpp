@@ -10,6 +10,8 @@
 #include "util/NumberGenerator.hpp"
 
 class Genotype : public DirectedAcyclicGraph {
+	friend class Checkpoint;
+
 private:
 	std::unordered_map<innov_t, SynapseGene> m_synapseGenes;
 	innov_t m_latestInnovation;
@@ -34,6 +36,19 @@ public:
 	innov_t findSplittableSynapse() const;
 	const std::pair<id_t, id_t> findConnectableNeurons(const uint64_t numInputs) const;
 
+	/*
+	 * Genotypes with the same structural hash compile to phenotypes with the same
+	 * layout, the same nodes in the same order and the same enabled connections,
+	 * so they only differ in weights and biases.
+	 */
+	uint64_t getStructuralHash() const;
+
+	/*
+	 * Genotypes with the same content hash compile to phenotypes that compute the same
+	 * function: the structure as well as the biases and enabled weights are the same.
+	 */
+	uint64_t getContentHash() const;
+
 public:
 	innov_t getLatestInnovation() const {
 		return m_latestInnovation;
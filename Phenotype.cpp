@@ -1,120 +1,202 @@
 #include "Phenotype.hpp"
 
 #include <cmath>
-#include <vector>
+#include <algorithm>
 
 #include "Genotype.hpp"
 
 #include <iostream>
 
-Phenotype::Phenotype(Genotype &genotype)
-	: m_executableNodes()
-	, m_nodeOrder(genotype.getNodeOrder()) {
+Phenotype::Phenotype(const Genotype &genotype)
+	: m_nodeIds(genotype.getNodeOrder())
+	, m_biases()
+	, m_isInput()
+	, m_isOutput()
+	, m_connectionOffsets()
+	, m_connectionTargets()
+	, m_weights()
+	, m_nodeIndices()
+	, m_inputIndices()
+	, m_outputIndices()
+	, m_nodeInputs()
+	, m_isLoaded() {
 
 	const auto& nodes = genotype.getNodes();
+	const auto& neuronGenes = genotype.getNeuronGenes();
+	const size_t numNodes = m_nodeIds.size();
 
-	// Create executable nodes
-	for (const auto& nodeIt : nodes) {
-		const id_t nodeId = nodeIt.first;
-		const auto& node = nodeIt.second;
+	m_biases.resize(numNodes, 0.0);
+	m_isInput.resize(numNodes, 0);
+	m_isOutput.resize(numNodes, 0);
+	m_nodeInputs.resize(numNodes, 0.0);
+	m_isLoaded.resize(numNodes, 0);
+	m_nodeIndices.reserve(numNodes);
 
-		m_executableNodes[nodeId] = std::make_unique<ExecutableNode>(node);
+	// store neuron data
+	std::vector<id_t> outputIds;
+	for (uint32_t nodeIndex(0); nodeIndex < numNodes; ++nodeIndex) {
+		const id_t nodeId = m_nodeIds[nodeIndex];
+		m_nodeIndices[nodeId] = nodeIndex;
+
+		const auto& neuronGeneIt = neuronGenes.find(nodeId);
+		if (neuronGeneIt != neuronGenes.end()) {
+			m_biases[nodeIndex] = neuronGeneIt->second;
+		}
+
+		// inputs have negative ids, outputs are the nodes that do not lead anywhere
+		if (nodeId < 0) {
+			m_isInput[nodeIndex] = 1;
+			const size_t inputPosition = -nodeId - 1;
+			if (inputPosition >= m_inputIndices.size()) {
+				m_inputIndices.resize(inputPosition + 1, 0);
+			}
+			m_inputIndices[inputPosition] = nodeIndex;
+		}
+
+		if (nodes.find(nodeId)->second.outputNodeIds.size() == 0) {
+			m_isOutput[nodeIndex] = 1;
+			outputIds.push_back(nodeId);
+		}
 	}
 
-	// store synapse data
-	for (const auto& synapseGeneIt : genotype.getSynapseGenes()) {
-		const auto& synapseGene = synapseGeneIt.second;
-		const id_t startNodeId = synapseGene.getInputOutputIds().first;
-		const id_t endNodeId = synapseGene.getInputOutputIds().second;
-		const double weight = synapseGene.getWeight();
-		const bool enabled = synapseGene.isEnabled();
+	std::sort(outputIds.begin(), outputIds.end());
+	for (const id_t outputId : outputIds) {
+		m_outputIndices.push_back(m_nodeIndices[outputId]);
+	}
 
-		auto& startExecutableNode = m_executableNodes[startNodeId];
-		startExecutableNode->weights[endNodeId] = weight;
+	/*
+	 * Store synapse data. The enabled synapses are counted per starting node first,
+	 * so that each node's connections can be laid out next to each other.
+	 */
+	const auto& synapseGenes = genotype.getSynapseGenes();
 
-		if (enabled) {
-			startExecutableNode->enabledConnections.insert(endNodeId);
+	m_connectionOffsets.assign(numNodes + 1, 0);
+	for (const auto& synapseGeneIt : synapseGenes) {
+		const auto& synapseGene = synapseGeneIt.second;
+		if (synapseGene.isEnabled()) {
+			const uint32_t startNodeIndex = m_nodeIndices[synapseGene.getInputOutputIds().first];
+			++m_connectionOffsets[startNodeIndex + 1];
 		}
 	}
 
-	// store neuron data
-	for (const auto& neuronGeneIt : genotype.getNeuronGenes()) {
-		const id_t neuronGeneId = neuronGeneIt.first;
-		const double bias = neuronGeneIt.second;
+	for (size_t i(0); i < numNodes; ++i) {
+		m_connectionOffsets[i + 1] += m_connectionOffsets[i];
+	}
+
+	m_connectionTargets.resize(m_connectionOffsets[numNodes]);
+	m_weights.resize(m_connectionOffsets[numNodes]);
 
-		m_executableNodes[neuronGeneId]->bias = bias;
+	std::vector<uint32_t> nextConnection(m_connectionOffsets.begin(), m_connectionOffsets.end() - 1);
+	for (const auto& synapseGeneIt : synapseGenes) {
+		const auto& synapseGene = synapseGeneIt.second;
+		if (!synapseGene.isEnabled()) {
+			continue;
+		}
+
+		const uint32_t startNodeIndex = m_nodeIndices[synapseGene.getInputOutputIds().first];
+		const uint32_t endNodeIndex = m_nodeIndices[synapseGene.getInputOutputIds().second];
+
+		const uint32_t connection = nextConnection[startNodeIndex]++;
+		m_connectionTargets[connection] = endNodeIndex;
+		m_weights[connection] = synapseGene.getWeight();
 	}
-}
 
-Phenotype::Phenotype(Phenotype&& other) noexcept
-    : m_executableNodes(std::move(other.m_executableNodes)),
-      m_nodeOrder(other.m_nodeOrder) {
+	/*
+	 * The synapse genes come out of a hash map, so sort every node's connections by
+	 * target. Phenotypes of the same structure then have the exact same layout. This
+	 * does not change the results, as every target still receives its inputs in node order.
+	 */
+	for (size_t nodeIndex(0); nodeIndex < numNodes; ++nodeIndex) {
+		const uint32_t begin = m_connectionOffsets[nodeIndex];
+		const uint32_t end = m_connectionOffsets[nodeIndex + 1];
+
+		for (uint32_t i(begin + 1); i < end; ++i) {
+			const uint32_t target = m_connectionTargets[i];
+			const double weight = m_weights[i];
+
+			uint32_t j = i;
+			for (; j > begin && m_connectionTargets[j - 1] > target; --j) {
+				m_connectionTargets[j] = m_connectionTargets[j - 1];
+				m_weights[j] = m_weights[j - 1];
+			}
+			m_connectionTargets[j] = target;
+			m_weights[j] = weight;
+		}
+	}
 }
 
-Phenotype& Phenotype::operator=(Phenotype&& other) noexcept {
-    if (this != &other) {
-        m_executableNodes = std::move(other.m_executableNodes);
-        m_nodeOrder = other.m_nodeOrder;
-    }
-    return *this;
+bool Phenotype::hasSameStructure(const Phenotype& other) const {
+	return m_nodeIds == other.m_nodeIds
+		&& m_isOutput == other.m_isOutput
+		&& m_connectionOffsets == other.m_connectionOffsets
+		&& m_connectionTargets == other.m_connectionTargets;
 }
 
 double Phenotype::activateSigmoid(const double input) {
 	return 1.0 / (1 + std::exp(-4.9 * input));
 }
 
+void Phenotype::run(const uint8_t* skipsActivation) {
+	const size_t numNodes = m_nodeIds.size();
+
+	for (size_t nodeIndex(0); nodeIndex < numNodes; ++nodeIndex) {
+		const double rawOutput = m_nodeInputs[nodeIndex] + m_biases[nodeIndex];
+
+		// outputs are read without activation, so they keep their raw value
+		if (m_isOutput[nodeIndex]) {
+			m_nodeInputs[nodeIndex] = rawOutput;
+			continue;
+		}
+
+		const double output = skipsActivation[nodeIndex] ? rawOutput : activateSigmoid(rawOutput);
+
+//		std::cout << "Activated output from node " << m_nodeIds[nodeIndex] << " is " << output << " using bias " << m_biases[nodeIndex] << std::endl;
+
+		const uint32_t end = m_connectionOffsets[nodeIndex + 1];
+		for (uint32_t connection(m_connectionOffsets[nodeIndex]); connection < end; ++connection) {
+			m_nodeInputs[m_connectionTargets[connection]] += m_weights[connection] * output;
+		}
+	}
+}
+
 const std::unordered_map<id_t, double> Phenotype::execute(const std::unordered_map<id_t, double> &inputs) {
 	//reset
-	for (const id_t nodeId : m_nodeOrder) {
-		const auto& executableNode = m_executableNodes[nodeId];
-		executableNode->input = 0;
-	}
+	std::fill(m_nodeInputs.begin(), m_nodeInputs.end(), 0.0);
+	std::fill(m_isLoaded.begin(), m_isLoaded.end(), 0);
 
 	// load inputs
 	for (const auto& inputIt : inputs) {
-		const id_t inputNodeId = inputIt.first;
-		const double inputValue = inputIt.second;
+		const auto& nodeIndexIt = m_nodeIndices.find(inputIt.first);
+		if (nodeIndexIt == m_nodeIndices.end()) {
+			continue;
+		}
 
-		m_executableNodes[inputNodeId]->input = inputValue;
-//		std::cout << "Loaded " << m_executableNodes[inputNodeId]->input << " into node " << inputNodeId << std::endl;
+		m_nodeInputs[nodeIndexIt->second] = inputIt.second;
+		m_isLoaded[nodeIndexIt->second] = 1;
+//		std::cout << "Loaded " << inputIt.second << " into node " << inputIt.first << std::endl;
 	}
 
 	//execute
-	std::unordered_map<id_t, double> outputs;
-	for (const id_t nodeId : m_nodeOrder) {
-		const auto& executableNode = m_executableNodes[nodeId];
+	run(m_isLoaded.data());
 
-		const auto& outputNodeIds = executableNode->outputNodeIds;
-		const auto& weights = executableNode->weights;
-		const double rawOutput = executableNode->input + executableNode->bias;
-		const auto& enabledConnections = executableNode->enabledConnections;
-
-		const double output = (inputs.count(nodeId)) ? rawOutput : activateSigmoid(rawOutput);
+	std::unordered_map<id_t, double> outputs;
+	for (const uint32_t outputIndex : m_outputIndices) {
+		outputs[m_nodeIds[outputIndex]] = m_nodeInputs[outputIndex];
+	}
 
-//		std::cout << "Activated output from node " << nodeId << " is " << output << " using bias " << executableNode->bias << std::endl;
+	return outputs;
+}
 
-		if (outputNodeIds.size() == 0) {
-//			std::cout << "Node " << nodeId << " is outputting " << rawOutput << std::endl;
-			outputs[nodeId] = rawOutput;
-			continue;
-		}
+void Phenotype::execute(const double* inputs, double* outputs) {
+	std::fill(m_nodeInputs.begin(), m_nodeInputs.end(), 0.0);
 
-		for (const id_t outputNodeId : outputNodeIds) {
-			const double weight = weights.find(outputNodeId)->second;
-			const bool enabled = enabledConnections.count(outputNodeId);
+	for (size_t i(0); i < m_inputIndices.size(); ++i) {
+		m_nodeInputs[m_inputIndices[i]] = inputs[i];
+	}
 
-			if (enabled) {
-				auto& outputExecutableNode = m_executableNodes[outputNodeId];
-				const double input = weight * output;
-				outputExecutableNode->input += input;
+	run(m_isInput.data());
 
-//				std::cout << "	Output node " << outputNodeId << " now has a total input of " << outputExecutableNode->input << " after an addition of " << input << " through connection weight " << weight << std::endl;
-			} else {
-//				std::cout << "	Connection to node " << outputNodeId << " was disabled!" << std::endl;
-			}
-		}
+	for (size_t i(0); i < m_outputIndices.size(); ++i) {
+		outputs[i] = m_nodeInputs[m_outputIndices[i]];
 	}
-//	std::cout << std::endl;
-
-	return outputs;
 }
@@ -1,37 +1,113 @@
 #ifndef NEAT_PHENOTYPE_HPP_
 #define NEAT_PHENOTYPE_HPP_
 
-#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
 
-#include "DirectedAcyclicGraph.hpp"
+#include "util/types.hpp"
 
 class Genotype;
 
-#include <iostream>
-
+/*
+ * The executable form of a genotype.
+ *
+ * A phenotype copies everything it needs out of the genotype when it is compiled,
+ * so it can be built and run on any thread and outlives changes to the genotype.
+ * Nodes are stored in execution order, and the enabled connections leaving node i
+ * are stored contiguously in [m_connectionOffsets[i], m_connectionOffsets[i+1]),
+ * pointing at the index of the node they feed into.
+ */
 class Phenotype {
 private:
-	struct ExecutableNode {
-		const std::unordered_set<id_t>& outputNodeIds;
-		double bias;
-		std::unordered_map<id_t, double> weights;
-		std::unordered_set<id_t> enabledConnections;
+	std::vector<id_t> m_nodeIds;
+	std::vector<double> m_biases;
+	std::vector<uint8_t> m_isInput;
+	std::vector<uint8_t> m_isOutput;
+
+	std::vector<uint32_t> m_connectionOffsets;
+	std::vector<uint32_t> m_connectionTargets;
+	std::vector<double> m_weights;
 
-		double input;
+	std::unordered_map<id_t, uint32_t> m_nodeIndices;
+	std::vector<uint32_t> m_inputIndices;  // node index of input -1, -2, ...
+	std::vector<uint32_t> m_outputIndices; // node index of the outputs in ascending id order
 
-		ExecutableNode(const DirectedAcyclicGraph::Node& node) : outputNodeIds(node.outputNodeIds), bias(0), weights(), enabledConnections(), input(0) {}
-	};
+	// scratch space for execution
+	std::vector<double> m_nodeInputs;
+	std::vector<uint8_t> m_isLoaded;
 
-	std::unordered_map<id_t, std::unique_ptr<ExecutableNode>> m_executableNodes;
-	std::vector<id_t>& m_nodeOrder;
+private:
+	void run(const uint8_t* skipsActivation);
 
 public:
-	Phenotype(Genotype& genotype);
-	Phenotype(Phenotype&& other) noexcept;
-	Phenotype& operator=(Phenotype&& other) noexcept;
+	Phenotype(const Genotype& genotype);
 
 	const std::unordered_map<id_t, double> execute(const std::unordered_map<id_t, double> &inputs);
 
+	/*
+	 * Executes the network with inputs[i] loaded into input node -(i+1), writing the
+	 * outputs in ascending id order. Performs no allocation.
+	 */
+	void execute(const double* inputs, double* outputs);
+
+	size_t getNumNodes() const {
+		return m_nodeIds.size();
+	}
+
+	// enabled connections only
+	size_t getNumConnections() const {
+		return m_connectionTargets.size();
+	}
+
+	size_t getNumInputs() const {
+		return m_inputIndices.size();
+	}
+
+	size_t getNumOutputs() const {
+		return m_outputIndices.size();
+	}
+
+	// same nodes in the same order with the same connections, only weights and biases may differ
+	bool hasSameStructure(const Phenotype& other) const;
+
+	const std::vector<id_t>& getNodeIds() const {
+		return m_nodeIds;
+	}
+
+	const std::vector<double>& getBiases() const {
+		return m_biases;
+	}
+
+	const std::vector<uint8_t>& getIsInput() const {
+		return m_isInput;
+	}
+
+	const std::vector<uint8_t>& getIsOutput() const {
+		return m_isOutput;
+	}
+
+	const std::vector<uint32_t>& getConnectionOffsets() const {
+		return m_connectionOffsets;
+	}
+
+	const std::vector<uint32_t>& getConnectionTargets() const {
+		return m_connectionTargets;
+	}
+
+	const std::vector<double>& getWeights() const {
+		return m_weights;
+	}
+
+	const std::vector<uint32_t>& getInputIndices() const {
+		return m_inputIndices;
+	}
+
+	const std::vector<uint32_t>& getOutputIndices() const {
+		return m_outputIndices;
+	}
+
 	static double activateSigmoid(const double input);
 };
 
@@ -1,355 +1,621 @@
 #include "Population.hpp"
 
+#include <chrono>
 #include <cmath>
-#include <thread>
+#include <numeric>
+#include <algorithm>
 
 #include "Phenotype.hpp"
 #include "util/NumberGenerator.hpp"
-
-
-#include "Interface.hpp"
-#include "mvc/Model.hpp"
+#include "evaluation/ModelEvaluator.hpp"
+#include "io/Checkpoint.hpp"
 
 #include <iostream>
 #include <iomanip>
-#include "rendering/DAGRenderer.hpp"
 
 Population::Population(const uint64_t numGenotypes, const uint16_t numInputs, const uint16_t numOutputs)
+	: Population(numGenotypes, numInputs, numOutputs, std::make_unique<ModelEvaluator>()) {
+}
+
+Population::Population(const uint64_t numGenotypes, const uint16_t numInputs, const uint16_t numOutputs, std::unique_ptr<Evaluator> evaluator)
 	: m_genePool(numGenotypes, numInputs, numOutputs)
-	, m_scoringVisualizer({0.4, 0.0, 0.6, 1.0})
-	, m_speciesRecordViewer(0.0, 0.5, 0.4, 0.5)
-	, m_fitnessRecordViewer(0.0, 0.0, 0.4, 0.5)
+	, m_evaluator(std::move(evaluator))
+	, m_threadPool()
+	, m_schedulingPolicy(SchedulingPolicy::LongestExpectedFirst)
+	, m_batchingPolicy(BatchingPolicy::InOrder)
+	, m_topologyBucketSizes()
+	, m_racingPolicy(RacingPolicy::Off)
+	, m_race()
+	, m_expectedEpisodeLengths()
+	, m_cachePolicy(CachePolicy::Off)
+	, m_fitnessCache()
+	, m_contentHashes()
+	, m_cacheSources()
+	, m_numEpisodes(1)
+	, m_numSharedSeeds(0)
+	, m_sharedSeedStreams()
+	, m_aggregation(Aggregation::Mean)
+	, m_aggregationQuantile(0.5)
+	, m_episodeResults()
+	, m_trajectoryRecorder()
+	, m_bestTrajectory()
+	, m_bestTrajectoryHash(0)
+	, m_hasBestTrajectory(false)
+	, m_episodeLengths()
+	, m_costRecord()
 	, m_generationId(0)
 	, m_topGenerationFitness(0)
+	, m_scoringSeconds(0)
 	, m_fitnessRecord()
-	, m_bestGenotypeIdInGeneration(-1) {
+	, m_bestGenotypeInGeneration()
+	, m_checkpointPath()
+	, m_checkpointInterval(0)
+	, m_saveCheckpointDeltas(false)
+	, m_checkpointBasePath()
+	, m_checkpointBaseGenerationId(0)
+	, m_checkpointWriter()
+	, m_generationLog()
+	, m_hallOfFame() {
 }
 
-//double Population::scorePhenotype(const std::unique_ptr<Phenotype>& phenotypePtr) {
-//	std::vector<std::pair<int, int>> inputVariants = {std::make_pair(0,0), std::make_pair(0,1), std::make_pair(1,0), std::make_pair(1,1)};
-//	std::vector<double> desiredOutputs = {0.0, 1.0, 1.0, 0.0};
-//
-//	double totalError = 0;
-////	std::cout << "Outputs: ";
-//	for (size_t i(0); i < inputVariants.size(); ++i) {
-//		const auto& inputVariant = inputVariants[i];
-//		const double desiredOutput = desiredOutputs[i];
-//
-//		std::unordered_map<id_t, double> inputs;
-//		inputs[-1] = inputVariant.first; inputs[-2] = inputVariant.second;// inputs[-3] = 1;
-//		const auto& outputs = phenotypePtr->execute(inputs);
-//
-//		const double output = Phenotype::activateSigmoid(outputs.find(0)->second);
-//		const double d = (desiredOutput - output);
-//		const double error = d*d;
-//		totalError += error;
-//
-////		std::cout << output << " -> " << error << " (" << inputVariant.first << ", " << inputVariant.second << ") ";
-//	}
-////	std::cout << std::endl;
-////	std::cout << "	Total error: " << totalError << std::endl;
-//
-//	const double score = std::max(4.0 - totalError, 0.0);
-//
-//	return score;
-//}
-
-//double Population::scorePhenotype(const std::unique_ptr<Phenotype>& phenotypePtr) {
-//    Model model(Interface::getRandomSnake());
-//    uint64_t steps = 0;
-//
-//    while (!model.gameIsOver() && steps < 1000) {
-//		const std::unordered_map<id_t, double> inputs = Interface::generateInputs(model);
-//		const auto& outputs = phenotypePtr->execute(inputs);
-//		Interface::interpretOutputs(model, outputs);
-//
-//		++steps;
-//    }
-//
-//    return model.getScore();
-//}
-
-//double Population::scorePhenotype(const std::unique_ptr<Phenotype>& phenotypePtr) {
-//    FBModel model;
-//
-//    while (!model.gameIsOver()) {
-//		const std::unordered_map<id_t, double> inputs = FBInterface::generateInputs(model);
-//		const auto& outputs = phenotypePtr->execute(inputs);
-//		FBInterface::interpretOutputs(model, outputs);
-//
-//		if (model.getScore() > 1000) {
-//			break;
-//		}
-//    }
-//
-//    return model.getScore();
-//}
-
-double Population::scorePhenotype(const std::unique_ptr<Phenotype>& phenotypePtr) {
-//	std::cout << "	Scoring Phenotype!!" << std::endl;
-    Model model;
-    uint64_t steps = 0;
-
-    while (!model.gameIsOver() && steps < 50000) {
-		const std::unordered_map<id_t, double> inputs = Interface::generateInputs(model);
-		const auto& outputs = phenotypePtr->execute(inputs);
-		Interface::interpretOutputs(model, outputs);
-
-		++steps;
-//		std::cout << model.getScore() << std::endl;
-    }
-
-    return model.getScore();
-}
-
-void Population::scorePhenotypeShell(std::unordered_map<id_t, std::unique_ptr<Phenotype>>::iterator phenotypeIt, const std::unordered_map<id_t, size_t>& vectorIndices, std::vector<double>& genotypeScoresVector, const uint32_t iterationsThisThread) {
-    for (uint32_t i(0); i < iterationsThisThread; ++i) {
-    	const id_t genotypeId = phenotypeIt->first;
-    	const std::unique_ptr<Phenotype>& phenotypePtr = phenotypeIt->second;
+namespace {
+	// number of nodes and enabled connections, which is what a phenotype of the genotype executes
+	double getNetworkSize(const Genotype& genotype) {
+		double networkSize = genotype.getNodeOrder().size();
+		for (const auto& synapseGeneIt : genotype.getSynapseGenes()) {
+			if (synapseGeneIt.second.isEnabled()) {
+				++networkSize;
+			}
+		}
 
-    	const size_t vectorIndex = vectorIndices.find(genotypeId)->second;
-    	double score = scorePhenotype(phenotypePtr);
-		genotypeScoresVector[vectorIndex] = score;
-		++phenotypeIt;
-    }
+		return networkSize;
+	}
 }
 
-void Population::scoreGenerationThreaded() {
-	// reset
-	m_topGenerationFitness = 0;
+double Population::CostRecord::getCorrelation() const {
+	const size_t n = std::min(predictedCosts.size(), actualCosts.size());
+	if (n < 2) {
+		return 0;
+	}
 
-	// find number of available threads
-    const uint32_t numThreads = std::thread::hardware_concurrency();
+	const double predictedMean = std::accumulate(predictedCosts.begin(), predictedCosts.begin() + n, 0.0) / n;
+	const double actualMean = std::accumulate(actualCosts.begin(), actualCosts.begin() + n, 0.0) / n;
 
-    // create phenotypes
-	auto& genotypes = m_genePool.getGenotypes();
-	std::unordered_map<id_t, std::unique_ptr<Phenotype>> phenotypes;
+	double covariance = 0, predictedVariance = 0, actualVariance = 0;
+	for (size_t i(0); i < n; ++i) {
+		const double dp = predictedCosts[i] - predictedMean;
+		const double da = actualCosts[i] - actualMean;
+		covariance += dp * da;
+		predictedVariance += dp * dp;
+		actualVariance += da * da;
+	}
+
+	if (predictedVariance <= 0 || actualVariance <= 0) {
+		return 0;
+	}
 
-	for (auto& genotypeIt : genotypes) {
-		const id_t genotypeId = genotypeIt.first;
-		auto& genotype = genotypeIt.second;
+	return covariance / std::sqrt(predictedVariance * actualVariance);
+}
 
-		std::unique_ptr<Phenotype> phenotypePtr = std::make_unique<Phenotype>(genotype);
-		phenotypes.emplace(genotypeId, std::move(phenotypePtr));
+std::vector<size_t> Population::predictCosts() {
+	/*
+	 * A genotype is expected to last about as long as the parent it inherited its
+	 * structure from did in the previous generation. Genotypes without a scored parent
+	 * are assumed to last the average episode length.
+	 */
+	const auto& genotypes = m_genePool.getGenotypes();
+	const std::vector<slot_t>& parentSlots = m_genePool.getParentSlots();
+
+	double averageEpisodeLength = 1.0;
+	if (!m_episodeLengths.empty()) {
+		averageEpisodeLength = std::accumulate(m_episodeLengths.begin(), m_episodeLengths.end(), 0.0) / m_episodeLengths.size();
 	}
 
-	// find number of phenotypes to be scored by each thread
-    const uint32_t numPhenotypes = phenotypes.size();
-    const uint32_t rawPhenotypesPerThread = numPhenotypes / numThreads;
-    const uint32_t rawSum = numThreads * rawPhenotypesPerThread;
-    uint32_t difference = numPhenotypes - rawSum;
+	m_expectedEpisodeLengths.resize(genotypes.size());
+	m_costRecord.predictedCosts.resize(genotypes.size());
+	for (slot_t slot(0); slot < genotypes.size(); ++slot) {
+		const slot_t parentSlot = parentSlots[slot];
 
-    // create a conversion from indices to genotypeIds
-	std::unordered_map<id_t, size_t> vectorIndices(numPhenotypes);
-	std::unordered_map<id_t, Genotype>::iterator genotypeIt = genotypes.begin();
-	for (size_t i(0); i < numPhenotypes; ++i) {
-		const id_t genotypeId = genotypeIt->first;
-		vectorIndices[genotypeId] = i;
+		double expectedEpisodeLength = averageEpisodeLength;
+		if (parentSlot != GenePool::noParent && parentSlot < m_episodeLengths.size()) {
+			expectedEpisodeLength = m_episodeLengths[parentSlot];
+		}
 
-		++genotypeIt;
+		m_expectedEpisodeLengths[slot] = expectedEpisodeLength;
+		m_costRecord.predictedCosts[slot] = expectedEpisodeLength * getNetworkSize(genotypes[slot]);
 	}
 
-//	for (const auto& it : vectorIndices) {
-//		std::cout << it.first << " -> " << it.second << std::endl;
-//	}
+	std::vector<size_t> order(genotypes.size());
+	std::iota(order.begin(), order.end(), 0);
 
-	// setup threads
-	std::unordered_map<id_t, std::unique_ptr<Phenotype>>::iterator phenotypeIt = phenotypes.begin();
-	std::vector<double> genotypeScoresVector(numPhenotypes);
-	std::vector<std::thread> threads;
+	if (m_schedulingPolicy == SchedulingPolicy::LongestExpectedFirst) {
+		const auto& predictedCosts = m_costRecord.predictedCosts;
+		std::stable_sort(order.begin(), order.end(), [&predictedCosts](const size_t i, const size_t j) {
+			return predictedCosts[i] > predictedCosts[j];
+		});
+	}
 
-	// start threads
-    for (uint32_t i = 0; i < numThreads; ++i) {
-    	uint32_t iterationsThisThread = rawPhenotypesPerThread;
-    	if (difference > 0) {
-    		++iterationsThisThread;
-    		--difference;
-    	}
+	return order;
+}
 
-        threads.emplace_back(Population::scorePhenotypeShell, phenotypeIt, std::cref(vectorIndices), std::ref(genotypeScoresVector), iterationsThisThread);
-        for (uint32_t i(0); i < iterationsThisThread; ++i) {
-        	++phenotypeIt;
-        }
-    }
+void Population::recordEpisodes(const std::vector<EpisodeResult>& results) {
+	const auto& genotypes = m_genePool.getGenotypes();
+	std::vector<double>& genotypeScores = m_genePool.getGenotypeScores();
 
-    // join threads
-    for (auto& thread : threads) {
-        thread.join();
-    }
+	m_episodeLengths.resize(results.size());
+	m_costRecord.actualCosts.resize(results.size());
+	for (slot_t slot(0); slot < results.size(); ++slot) {
+		genotypeScores[slot] = results[slot].score;
+		m_episodeLengths[slot] = results[slot].steps;
 
-    // extract scores from the vector and place them into an unordered_map
-//	for (size_t i(0); i < genotypeScoresVector.size(); ++i) {
-//		std::cout << i << " -> " << genotypeScoresVector[i] << std::endl;
-//	}
+		m_costRecord.actualCosts[slot] = results[slot].steps * getNetworkSize(genotypes[slot]);
+	}
 
-    std::unordered_map<id_t, double> genotypeScores;
-    for (const auto& it : vectorIndices) {
-    	const id_t genotypeId = it.first;
-    	const size_t vectorIndex = it.second;
+	if (m_numSharedSeeds > 0) {
+		std::vector<double>& sharedSeedScores = m_genePool.getSharedSeedScores();
+		for (size_t i(0); i < m_episodeResults.size(); ++i) {
+			sharedSeedScores[i] = m_episodeResults[i].score;
+		}
+	}
+}
 
-    	genotypeScores[genotypeId] = genotypeScoresVector[vectorIndex];
-    }
+void Population::findBestGenotype() {
+	const std::vector<double>& genotypeScores = m_genePool.getGenotypeScores();
 
-    // find best scores
-	id_t bestGenotypeIdInGeneration = -1;
-	for (const auto& scoreIt : genotypeScores) {
-		const id_t genotypeId =	scoreIt.first;
-		const double score = scoreIt.second;
+	m_bestGenotypeInGeneration = GenePool::GenotypeHandle();
+	for (slot_t slot(0); slot < genotypeScores.size(); ++slot) {
+		const double score = genotypeScores[slot];
 
 		if (score > m_topGenerationFitness) {
 			m_topGenerationFitness = score;
-			bestGenotypeIdInGeneration = genotypeId;
+			m_bestGenotypeInGeneration = m_genePool.getGenotypes().getHandle(slot);
 		}
 
-//		std::cout << "	Genotype " << genotypeId << " scored " << score << std::endl;
-
-		genotypeScores[genotypeId] = score;
+//		std::cout << "	Genotype " << slot << " scored " << score << std::endl;
 	}
 
-	m_genePool.setGenotypeScores(genotypeScores);
-	m_fitnessRecord.push_back(m_topGenerationFitness);
+	m_fitnessRecord.push(m_topGenerationFitness);
 
 	int precision = std::numeric_limits<double>::max_digits10;
-	std::cout << std::fixed << std::setprecision(precision) << "Top generation " << m_generationId << " fitness: " << m_topGenerationFitness << " / " << m_genePool.getGenotypeFitnessRecord() << " from genotype " << bestGenotypeIdInGeneration << std::endl;
+	std::cout << std::fixed << std::setprecision(precision) << "Top generation " << m_generationId << " fitness: " << m_topGenerationFitness << " / " << m_genePool.getGenotypeFitnessRecord() << " from genotype " << m_bestGenotypeInGeneration.slot << std::endl;
+}
+
+std::vector<std::vector<slot_t>> Population::makeBatches(const std::vector<size_t>& order) {
+	const size_t batchSize = std::max<size_t>(1, m_evaluator->getBatchSize());
+
+	/*
+	 * Slots are bucketed by the structure of their genotype, so the evaluator can run
+	 * the genotypes of a bucket together. Buckets come in the order their first slot
+	 * appears in the scheduled order, and keep that order inside, so the expensive
+	 * buckets still start first.
+	 */
+	std::vector<std::vector<slot_t>> buckets;
+	if (m_batchingPolicy == BatchingPolicy::ByTopology) {
+		const auto& genotypes = m_genePool.getGenotypes();
+
+		std::unordered_map<uint64_t, size_t> bucketIndices;
+		for (const size_t slot : order) {
+			const uint64_t structuralHash = genotypes[slot].getStructuralHash();
+
+			const auto& bucketIndexIt = bucketIndices.find(structuralHash);
+			if (bucketIndexIt == bucketIndices.end()) {
+				bucketIndices[structuralHash] = buckets.size();
+				buckets.push_back({static_cast<slot_t>(slot)});
+			} else {
+				buckets[bucketIndexIt->second].push_back(slot);
+			}
+		}
+	} else {
+		buckets.emplace_back(order.begin(), order.end());
+	}
+
+	m_topologyBucketSizes.clear();
+	if (m_batchingPolicy == BatchingPolicy::ByTopology) {
+		for (const auto& bucket : buckets) {
+			m_topologyBucketSizes.push_back(bucket.size());
+		}
+	}
 
-	m_bestGenotypeIdInGeneration = bestGenotypeIdInGeneration;
+	// consecutive runs of each bucket, so the batches keep the priority of the slots in them
+	std::vector<std::vector<slot_t>> batches;
+	for (const auto& bucket : buckets) {
+		for (size_t i(0); i < bucket.size(); i += batchSize) {
+			batches.emplace_back(bucket.begin() + i, bucket.begin() + std::min(bucket.size(), i + batchSize));
+		}
+	}
+
+	return batches;
 }
 
-void Population::scoreGeneration() {
-	m_topGenerationFitness = 0;
+void Population::printTopologyBuckets() const {
+	if (m_topologyBucketSizes.empty()) {
+		return;
+	}
+
+	const size_t numGenotypes = std::accumulate(m_topologyBucketSizes.begin(), m_topologyBucketSizes.end(), size_t(0));
+	const size_t largestBucket = *std::max_element(m_topologyBucketSizes.begin(), m_topologyBucketSizes.end());
+	const size_t numSingletons = std::count(m_topologyBucketSizes.begin(), m_topologyBucketSizes.end(), size_t(1));
 
-	auto& genotypes = m_genePool.getGenotypes();
+	std::cout << std::setprecision(2) << "	" << m_topologyBucketSizes.size() << " topology buckets, largest " << largestBucket << ", mean " << double(numGenotypes) / m_topologyBucketSizes.size() << ", " << numGenotypes - numSingletons << " of " << numGenotypes << " genotypes share their topology" << std::endl;
+}
 
-	std::unordered_map<id_t, std::unique_ptr<Phenotype>> phenotypes;
-	for (auto& genotypeIt : genotypes) {
-		const id_t genotypeId = genotypeIt.first;
-		Genotype& genotype = genotypeIt.second;
+void Population::evaluateBatch(const std::vector<slot_t>& slots, const unsigned episode, const unsigned workerIndex) {
+	const auto& genotypes = m_genePool.getGenotypes();
 
-		std::unique_ptr<Phenotype> phenotype = std::make_unique<Phenotype>(genotype);
-		phenotypes.emplace(genotypeId, std::move(phenotype));
+	std::vector<Phenotype> phenotypes;
+	phenotypes.reserve(slots.size());
+	for (const slot_t slot : slots) {
+		phenotypes.emplace_back(genotypes[slot]);
 	}
 
-	id_t bestGenotypeIdInGeneration = -1;
-	std::unordered_map<id_t, double> genotypeScores;
-	for (const auto& phenotypeIt : phenotypes) {
-		const id_t genotypeId =	phenotypeIt.first;
-		const std::unique_ptr<Phenotype>& phenotypePtr = phenotypeIt.second;
+	Evaluator::WorkerContext context;
+	context.generationId = m_generationId;
+	context.workerIndex = workerIndex;
+	context.race = getRacingPolicy() != RacingPolicy::Off ? &m_race : nullptr;
+	context.recorder = m_trajectoryRecorder.getCapacity() > 0 ? &m_trajectoryRecorder : nullptr;
+	context.episode = episode;
+	context.sharedStream = m_numSharedSeeds > 0 ? &m_sharedSeedStreams[episode] : nullptr;
 
-		const double score = scorePhenotype(phenotypePtr);
+	std::vector<EpisodeResult> batchResults(slots.size());
+	m_evaluator->evaluate(phenotypes, slots, context, batchResults);
 
-		if (score > m_topGenerationFitness) {
-			m_topGenerationFitness = score;
-			bestGenotypeIdInGeneration = genotypeId;
-		}
+	const unsigned numEpisodes = getNumEpisodes();
+	for (size_t i(0); i < slots.size(); ++i) {
+		m_episodeResults[slots[i] * numEpisodes + episode] = batchResults[i];
+	}
+}
 
-//		std::cout << "	Genotype " << genotypeId << " scored " << score << std::endl;
+void Population::aggregateEpisodes(const std::vector<std::vector<slot_t>>& batches, std::vector<EpisodeResult>& results) const {
+	/*
+	 * The score of a genotype is reduced from the scores of its episodes, the steps
+	 * are their total, as that is what scoring the genotype cost.
+	 */
+	const unsigned numEpisodes = getNumEpisodes();
+	std::vector<double> scores(numEpisodes);
+
+	for (const auto& batch : batches) {
+		for (const slot_t slot : batch) {
+			const EpisodeResult* episodeResults = &m_episodeResults[slot * numEpisodes];
+
+			EpisodeResult& result = results[slot];
+			result = EpisodeResult();
+			for (unsigned episode(0); episode < numEpisodes; ++episode) {
+				scores[episode] = episodeResults[episode].score;
+				result.steps += episodeResults[episode].steps;
+			}
 
-		genotypeScores[genotypeId] = score;
+			switch (m_aggregation) {
+			case Aggregation::Mean:
+				result.score = std::accumulate(scores.begin(), scores.end(), 0.0) / numEpisodes;
+				break;
+			case Aggregation::Min:
+				result.score = *std::min_element(scores.begin(), scores.end());
+				break;
+			case Aggregation::Quantile: {
+				std::sort(scores.begin(), scores.end());
+				const double position = m_aggregationQuantile * (numEpisodes - 1);
+				const size_t lower = std::floor(position);
+				const size_t upper = std::min<size_t>(lower + 1, numEpisodes - 1);
+				result.score = scores[lower] + (position - lower) * (scores[upper] - scores[lower]);
+				break;
+			}
+			}
+		}
 	}
+}
 
-	m_genePool.setGenotypeScores(genotypeScores);
-	m_fitnessRecord.push_back(m_topGenerationFitness);
+Population::RacingPolicy Population::getRacingPolicy() const {
+	return getNumEpisodes() == 1 && m_numSharedSeeds == 0 ? m_racingPolicy : RacingPolicy::Off;
+}
 
-	int precision = std::numeric_limits<double>::max_digits10;
-	std::cout << std::fixed << std::setprecision(precision) << "Top generation " << m_generationId << " fitness: " << m_topGenerationFitness << " / " << m_genePool.getGenotypeFitnessRecord() << " from genotype " << bestGenotypeIdInGeneration << std::endl;
+void Population::setNumEpisodes(const unsigned numEpisodes) {
+	m_numEpisodes = std::max(1u, numEpisodes);
+}
 
-	m_bestGenotypeIdInGeneration = bestGenotypeIdInGeneration;
+void Population::setNumSharedSeeds(const unsigned numSharedSeeds) {
+	m_numSharedSeeds = numSharedSeeds;
+	m_sharedSeedStreams.clear();
+	m_genePool.setNumSharedSeeds(numSharedSeeds);
 }
 
-void Population::selection() {
-	++m_generationId;
-	m_genePool.constructNextGeneration();
+void Population::prepareEpisodes() {
+	m_episodeResults.assign(m_genePool.getGenotypes().size() * getNumEpisodes(), EpisodeResult());
+	m_trajectoryRecorder.clear();
+
+	if (m_numSharedSeeds == 0) {
+		return;
+	}
+
+	/*
+	 * The seeds only depend on the generation, so a rerun with the same seed replays
+	 * them, and the episodes of one seed see the exact same random numbers whichever
+	 * genotype plays them.
+	 */
+	m_sharedSeedStreams.clear();
+	for (unsigned seed(0); seed < m_numSharedSeeds; ++seed) {
+		m_sharedSeedStreams.push_back(NumberGenerator::createStream(m_generationId, seed, NumberGenerator::Purpose::SharedSeed));
+	}
 }
 
-void Population::perform(sf::RenderWindow& window, bool& showFitnessRecord, bool& showSpeciesRecord, bool& showGenotype, bool& showPerformance, double& msPerFrame) {
-	if (m_genePool.getGenotypes().count(m_bestGenotypeIdInGeneration) == 0) {
-		std::cerr << "There was no best genotype in this generation to perform!" << std::endl;
+void Population::beginRace() {
+	if (getRacingPolicy() == RacingPolicy::Off) {
+		return;
 	}
 
-	Genotype& bestGenotypeInGeneration = m_genePool.getGenotypes().find(m_bestGenotypeIdInGeneration)->second;
-	m_scoringVisualizer.loadGenotype(window, bestGenotypeInGeneration);
+	// the species are only assigned after scoring, but which species a genotype will join is known already
+	m_race.beginGeneration(m_genePool.findSpeciesIds(), getRacingPolicy() == RacingPolicy::Shadow);
+}
 
-	Phenotype phenotype(bestGenotypeInGeneration);
+void Population::finishRace() {
+	if (getRacingPolicy() == RacingPolicy::Off) {
+		return;
+	}
 
-//	FBModel model;
-//	Model model(Interface::getRandomSnake());
-	Model model;
-	uint64_t steps = 0;
+	m_race.finishGeneration(m_genePool.getGenotypeScores(), m_episodeLengths, m_expectedEpisodeLengths);
 
-	sf::Clock clock;
+	// a stopped episode does not tell how long its genotype lasts, so it keeps the length it was expected to run for its children
+	for (slot_t slot(0); slot < m_episodeLengths.size() && slot < m_expectedEpisodeLengths.size(); ++slot) {
+		if (m_race.wasStopped(slot)) {
+			m_episodeLengths[slot] = std::max<uint64_t>(m_episodeLengths[slot], std::llround(m_expectedEpisodeLengths[slot]));
+		}
+	}
 
-	bool skip = false;
-	while (!model.gameIsOver() && window.isOpen()) {
-		sf::Time elapsed = clock.getElapsedTime();
-		if (elapsed.asMilliseconds() < msPerFrame) {
+	const Race::Report& report = m_race.getReport();
+	const double savedPercentage = 100.0 * report.stepsSaved / std::max<uint64_t>(1, report.stepsRun + (report.isShadow ? 0 : report.stepsSaved));
+	std::cout << std::setprecision(2) << "	Racing " << (report.isShadow ? "would have stopped " : "stopped ") << report.numStopped << " of " << report.numEpisodes << " episodes, saving " << report.stepsSaved << " steps (" << savedPercentage << "%)";
+	if (report.isShadow) {
+		std::cout << ", the kept half would have differed in " << report.numSpeciesChanged << " of " << report.numSpecies << " species";
+	}
+	std::cout << std::endl;
+}
+
+void Population::setCachePolicy(const CachePolicy cachePolicy) {
+	m_cachePolicy = cachePolicy;
+	m_fitnessCache.clear();
+	m_fitnessCache.setSamplesToSettle(cachePolicy == CachePolicy::Stochastic ? FitnessCache::defaultSamplesToSettle : 1);
+}
+
+namespace {
+	const slot_t fromCache = std::numeric_limits<slot_t>::max();
+}
+
+std::vector<size_t> Population::applyFitnessCache(const std::vector<size_t>& order, std::vector<EpisodeResult>& results) {
+	if (m_cachePolicy == CachePolicy::Off) {
+		return order;
+	}
+
+	/*
+	 * Genotypes with a settled cache entry take its score. With a deterministic task a
+	 * genotype that appears more than once in the generation (a champion and its
+	 * unmutated copy, say) is only scored the first time it comes up in the order,
+	 * the others copy that score. Everything else is scored.
+	 */
+	const auto& genotypes = m_genePool.getGenotypes();
+	m_contentHashes.resize(genotypes.size());
+	m_cacheSources.assign(genotypes.size(), fromCache);
+
+	std::unordered_map<uint64_t, slot_t> scoredSlots;
+	std::vector<size_t> remainingOrder;
+	for (const size_t slot : order) {
+		const uint64_t contentHash = genotypes[slot].getContentHash();
+		m_contentHashes[slot] = contentHash;
+
+		// a score from an earlier generation was not played on this generation's shared seeds
+		const FitnessCache::Entry* entry = m_numSharedSeeds == 0 ? m_fitnessCache.find(contentHash, m_generationId) : nullptr;
+		if (entry != nullptr && m_fitnessCache.isSettled(*entry)) {
+			results[slot].score = entry->getScore();
+			results[slot].steps = std::llround(entry->getSteps());
 			continue;
 		}
-		clock.restart();
 
-		sf::Event event;
-		while (window.pollEvent(event)) {
-			switch (event.type) {
-			case sf::Event::Closed:
-				window.close();
-				break;
-			case sf::Event::KeyPressed:
-				if (event.key.code == sf::Keyboard::F) {
-					showFitnessRecord = !showFitnessRecord;
-				} else if (event.key.code == sf::Keyboard::S) {
-					showSpeciesRecord = !showSpeciesRecord;
-				} else if (event.key.code == sf::Keyboard::G) {
-					showGenotype = !showGenotype;
-				} else if (event.key.code == sf::Keyboard::P) {
-					showPerformance = !showPerformance;
-					skip = true;
-				} else if (event.key.code == sf::Keyboard::Space) {
-					skip = true;
-				} else if (event.key.code == sf::Keyboard::A) {
-					msPerFrame = std::max(1.0, msPerFrame - 1);
-				} else if (event.key.code == sf::Keyboard::D) {
-					msPerFrame = std::min(100.0, msPerFrame + 1);
-				} else if (event.key.code == sf::Keyboard::Escape) {
-					window.close();
-				}
-				break;
-			default:
-				break;
+		if (m_cachePolicy == CachePolicy::Deterministic) {
+			const auto& scoredSlotIt = scoredSlots.find(contentHash);
+			if (scoredSlotIt != scoredSlots.end()) {
+				m_cacheSources[slot] = scoredSlotIt->second;
+				continue;
 			}
+			scoredSlots[contentHash] = slot;
+		}
+
+		m_cacheSources[slot] = slot;
+		remainingOrder.push_back(slot);
+	}
+
+	return remainingOrder;
+}
+
+void Population::updateFitnessCache(std::vector<EpisodeResult>& results) {
+	if (m_cachePolicy == CachePolicy::Off) {
+		return;
+	}
+
+	// episodes cut short by racing did not get their real score, so they are not cached
+	for (slot_t slot(0); slot < results.size(); ++slot) {
+		if (m_cacheSources[slot] == slot && !(getRacingPolicy() == RacingPolicy::On && m_race.wasStopped(slot))) {
+			m_fitnessCache.addSample(m_contentHashes[slot], results[slot].score, results[slot].steps, m_generationId);
 		}
+	}
 
-		if (skip) {
-			window.clear();
-			window.display();
-			break;
+	for (slot_t slot(0); slot < results.size(); ++slot) {
+		const slot_t source = m_cacheSources[slot];
+
+		if (source == fromCache) {
+			continue;
+		} else if (source != slot) {
+			results[slot] = results[source];
+
+			const unsigned numEpisodes = getNumEpisodes();
+			std::copy_n(m_episodeResults.begin() + source * numEpisodes, numEpisodes, m_episodeResults.begin() + slot * numEpisodes);
+		} else {
+			// a stochastic score is the mean of all samples so far
+			const FitnessCache::Entry* entry = m_fitnessCache.find(m_contentHashes[slot], m_generationId);
+			if (entry != nullptr && !(getRacingPolicy() == RacingPolicy::On && m_race.wasStopped(slot))) {
+				results[slot].score = entry->getScore();
+			}
 		}
+	}
 
-		const std::unordered_map<id_t, double> inputs = Interface::generateInputs(model);
-//		const std::unordered_map<id_t, double> inputs = FBInterface::generateInputs(model);
+	m_fitnessCache.evict(m_generationId);
+}
 
-		const auto& outputs = phenotype.execute(inputs);
+void Population::keepBestTrajectory() {
+	if (m_trajectoryRecorder.getCapacity() == 0 || getBestGenotypeInGeneration() == nullptr) {
+		m_hasBestTrajectory = false;
+		return;
+	}
 
-		Interface::interpretOutputs(model, outputs);
-//		FBInterface::interpretOutputs(model, outputs);
+	// a duplicate was not played itself, the genotype it copied the score from was
+	slot_t slot = m_bestGenotypeInGeneration.slot;
+	if (m_cachePolicy != CachePolicy::Off && slot < m_cacheSources.size() && m_cacheSources[slot] != fromCache) {
+		slot = m_cacheSources[slot];
+	}
 
-		++steps;
+	/*
+	 * A best genotype that took its score from the cache was not played in this
+	 * generation. It is usually the champion of the previous one, whose trajectory is
+	 * still kept, so that is replayed if the genotype is the same.
+	 */
+	const uint64_t contentHash = getBestGenotypeInGeneration()->getContentHash();
+
+	const Trajectory* trajectory = m_trajectoryRecorder.find(slot);
+	if (trajectory != nullptr) {
+		m_bestTrajectory = *trajectory;
+		m_bestTrajectoryHash = contentHash;
+		m_hasBestTrajectory = true;
+	} else {
+		m_hasBestTrajectory = m_hasBestTrajectory && m_bestTrajectoryHash == contentHash;
+	}
+}
 
-		window.clear();
+void Population::printFitnessCache() const {
+	if (m_cachePolicy == CachePolicy::Off) {
+		return;
+	}
 
-		if (showGenotype) {
-			m_scoringVisualizer.renderGenotype(window);
+	uint64_t numCached = 0, numDuplicates = 0;
+	for (slot_t slot(0); slot < m_cacheSources.size(); ++slot) {
+		if (m_cacheSources[slot] == fromCache) {
+			++numCached;
+		} else if (m_cacheSources[slot] != slot) {
+			++numDuplicates;
 		}
+	}
 
+	const double hitPercentage = 100.0 * (numCached + numDuplicates) / std::max<size_t>(1, m_cacheSources.size());
+	std::cout << std::setprecision(2) << "	Fitness cache hit " << numCached + numDuplicates << " of " << m_cacheSources.size() << " genotypes (" << hitPercentage << "%), " << numCached << " from earlier generations and " << numDuplicates << " duplicates, " << m_fitnessCache.size() << " entries" << std::endl;
+}
 
-		m_scoringVisualizer.renderScoreboard(window, model.getScore());
-		m_scoringVisualizer.renderSimulation(window, model);
+void Population::scoreGenerationThreaded() {
+	const auto scoringStart = std::chrono::steady_clock::now();
+
+	// reset
+	m_topGenerationFitness = 0;
+
+	/*
+	 * Every batch of genotypes is its own task, or one task per episode when the
+	 * genotypes play several episodes. The persistent pool balances the
+	 * tasks between its workers, so a few long episodes do not keep the other workers
+	 * waiting. The tasks are started in order of the scheduling policy, so with
+	 * longest expected first the expensive episodes start right away and the cheap
+	 * ones fill the gaps at the end.
+	 *
+	 * The phenotypes are compiled inside the task as well. They copy what they need
+	 * out of the genotypes, which are only read during scoring, so compiling does not
+	 * hold up the other workers and the phenotypes can be thrown away with the task.
+	 * Every episode task compiles its own, which is cheap next to playing the episode.
+	 */
+	std::vector<EpisodeResult> results(m_genePool.getGenotypes().size());
+
+	const std::vector<std::vector<slot_t>> batches = makeBatches(applyFitnessCache(predictCosts(), results));
+	m_evaluator->prepare(m_threadPool.getNumWorkers());
+	prepareEpisodes();
+	beginRace();
+
+	// the episodes of a batch are neighbouring tasks, so they keep the priority of the batch
+	const unsigned numEpisodes = getNumEpisodes();
+	m_threadPool.run(batches.size() * numEpisodes, [this, &batches, numEpisodes](const size_t taskIndex, const unsigned workerIndex) {
+		evaluateBatch(batches[taskIndex / numEpisodes], taskIndex % numEpisodes, workerIndex);
+	});
+
+	aggregateEpisodes(batches, results);
+	updateFitnessCache(results);
+	recordEpisodes(results);
+	finishRace();
+
+    // find best scores
+	findBestGenotype();
+	keepBestTrajectory();
+
+	m_scoringSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - scoringStart).count();
+
+	printTopologyBuckets();
+	printFitnessCache();
+
+	const ThreadPool::Stats& scoringStats = m_threadPool.getStats();
+	std::cout << std::setprecision(2) << "	Scoring took " << scoringStats.wallSeconds * 1000.0 << " ms with " << scoringStats.getUtilisation() * 100.0 << "% utilisation of " << scoringStats.workers.size() << " workers, cost prediction correlation " << m_costRecord.getCorrelation() << std::endl;
+}
+
+void Population::scoreGeneration() {
+	const auto scoringStart = std::chrono::steady_clock::now();
+
+	m_topGenerationFitness = 0;
+
+	std::vector<EpisodeResult> results(m_genePool.getGenotypes().size());
+
+	const std::vector<std::vector<slot_t>> batches = makeBatches(applyFitnessCache(predictCosts(), results));
+	m_evaluator->prepare(1);
+	prepareEpisodes();
+	beginRace();
 
-		if (showSpeciesRecord) {
-			m_speciesRecordViewer.renderSpeciesRecord(window, m_genePool.getSpeciesRecord());
+	for (const auto& batch : batches) {
+		for (unsigned episode(0); episode < getNumEpisodes(); ++episode) {
+			evaluateBatch(batch, episode, 0);
 		}
-		if (showFitnessRecord) {
-			m_fitnessRecordViewer.renderFitnessRecord(window, m_fitnessRecord);
+	}
+
+	aggregateEpisodes(batches, results);
+	updateFitnessCache(results);
+	recordEpisodes(results);
+	finishRace();
+
+	findBestGenotype();
+	keepBestTrajectory();
+	m_scoringSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - scoringStart).count();
+	printTopologyBuckets();
+	printFitnessCache();
+}
+
+void Population::setCheckpointing(const std::string& path, const uint64_t interval, const bool saveDeltas) {
+	m_checkpointPath = path;
+	m_checkpointInterval = interval;
+	m_saveCheckpointDeltas = saveDeltas;
+}
+
+void Population::selection() {
+	const bool isFullCheckpointDue = m_checkpointInterval > 0 && (m_generationId + 1) % m_checkpointInterval == 0;
+
+	// the delta is taken before the selection it records
+	if (m_saveCheckpointDeltas && m_checkpointInterval > 0 && !m_checkpointBasePath.empty() && m_checkpointBasePath == m_checkpointPath && !isFullCheckpointDue) {
+		m_checkpointWriter.append(Checkpoint::writeDelta(*this, m_checkpointBaseGenerationId), Checkpoint::getDeltaPath(m_checkpointPath));
+	}
+
+	// the generation is logged with its scores, and its species as the selection left them
+	m_generationLog.recordScoring(*this, m_scoringSeconds);
+	m_hallOfFame.record(*this);
+	const auto selectionStart = std::chrono::steady_clock::now();
+
+	++m_generationId;
+	m_genePool.constructNextGeneration();
+
+	m_generationLog.recordSelection(*this, std::chrono::duration<double>(std::chrono::steady_clock::now() - selectionStart).count());
+
+	if (isFullCheckpointDue) {
+		m_checkpointWriter.submit(Checkpoint::write(*this), m_checkpointPath);
+		if (m_saveCheckpointDeltas) {
+			m_checkpointWriter.submit(std::vector<char>(), Checkpoint::getDeltaPath(m_checkpointPath));
 		}
 
-		window.display();
+		m_checkpointBasePath = m_checkpointPath;
+		m_checkpointBaseGenerationId = m_generationId;
 	}
 }
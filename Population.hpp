@@ -1,42 +1,296 @@
 #ifndef NEAT_POPULATION_HPP_
 #define NEAT_POPULATION_HPP_
 
-#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <memory>
+#include <string>
 
 #include "GenePool.hpp"
-#include "rendering/ScoringVisualizer.hpp"
-#include "rendering/RecordViewer.hpp"
+#include "evaluation/Evaluator.hpp"
+#include "evaluation/Race.hpp"
+#include "evaluation/FitnessCache.hpp"
+#include "evaluation/Trajectory.hpp"
+#include "util/ThreadPool.hpp"
+#include "util/History.hpp"
+#include "io/CheckpointWriter.hpp"
+#include "io/GenerationLog.hpp"
+#include "io/HallOfFame.hpp"
 
 class Phenotype;
 
 class Population {
-private:
-	GenePool m_genePool;
+	friend class Checkpoint;
+	friend class GenerationLog;
+
+public:
+	using EpisodeResult = Evaluator::EpisodeResult;
+
+	enum class SchedulingPolicy {
+		InOrder,
+		LongestExpectedFirst // start the genotypes with the most expensive predicted episodes first
+	};
+
+	enum class BatchingPolicy {
+		InOrder,   // batches are consecutive runs of the scheduled order
+		ByTopology // genotypes of the same structure are batched together, so they can be executed as one
+	};
 
-	ScoringVisualizer m_scoringVisualizer;
+	enum class RacingPolicy {
+		Off,
+		Shadow, // episodes run to the end, but the steps racing would have saved are reported
+		On      // episodes that provably can not make the kept half of their species are stopped early
+	};
 
-	RecordViewer m_speciesRecordViewer;
-	RecordViewer m_fitnessRecordViewer;
+	// how the episodes of a genotype are reduced to its score
+	enum class Aggregation {
+		Mean,
+		Min,     // the worst episode, for robust behaviour
+		Quantile // the given quantile of the episode scores, interpolated between episodes
+	};
+
+	enum class CachePolicy {
+		Off,
+		Deterministic, // a genotype that was scored before is not scored again
+		Stochastic     // scores of the same genotype are averaged until the cache entry settles
+	};
+
+	/*
+	 * Predicted and measured cost of scoring every genotype of the latest scored
+	 * generation, indexed by slot. Cost is counted as episode steps times the number
+	 * of nodes and enabled connections in the network. The prediction uses the
+	 * episode length of the parent the structure was inherited from.
+	 */
+	struct CostRecord {
+		std::vector<double> predictedCosts;
+		std::vector<double> actualCosts;
+
+		// Pearson correlation between predicted and actual cost
+		double getCorrelation() const;
+	};
+
+private:
+	GenePool m_genePool;
+	std::unique_ptr<Evaluator> m_evaluator;
+	ThreadPool m_threadPool;
+	SchedulingPolicy m_schedulingPolicy;
+	BatchingPolicy m_batchingPolicy;
+	std::vector<size_t> m_topologyBucketSizes;
+	RacingPolicy m_racingPolicy;
+	Race m_race;
+	std::vector<double> m_expectedEpisodeLengths;
+	CachePolicy m_cachePolicy;
+	FitnessCache m_fitnessCache;
+	std::vector<uint64_t> m_contentHashes;
+	std::vector<slot_t> m_cacheSources; // the slot whose score is used, or fromCache
+	unsigned m_numEpisodes;
+	unsigned m_numSharedSeeds;
+	std::vector<RandomStream> m_sharedSeedStreams;
+	Aggregation m_aggregation;
+	double m_aggregationQuantile;
+	std::vector<EpisodeResult> m_episodeResults; // at slot * getNumEpisodes() + episode
+	TrajectoryRecorder m_trajectoryRecorder;
+	Trajectory m_bestTrajectory;
+	uint64_t m_bestTrajectoryHash; // content hash of the genotype that played it
+	bool m_hasBestTrajectory;
+	std::vector<uint64_t> m_episodeLengths; // by slot, episodes stopped by the race keep the length they were expected to run
+	CostRecord m_costRecord;
 
     uint64_t m_generationId;
 
     double m_topGenerationFitness;
-    std::vector<double> m_fitnessRecord;
-    id_t m_bestGenotypeIdInGeneration;
+    double m_scoringSeconds; // of the latest scored generation
+    History m_fitnessRecord;
+    GenePool::GenotypeHandle m_bestGenotypeInGeneration;
 
-public:
-    static void scorePhenotypeShell(std::unordered_map<id_t, std::unique_ptr<Phenotype>>::iterator phenotypeIt, const std::unordered_map<id_t, size_t>& vectorIndices, std::vector<double>& genotypeScoresVector, const uint32_t iterationsThisThread);
+	std::string m_checkpointPath;
+	uint64_t m_checkpointInterval;
+	bool m_saveCheckpointDeltas;
+	std::string m_checkpointBasePath; // where the latest full checkpoint was saved or loaded, deltas only follow it there
+	uint64_t m_checkpointBaseGenerationId;
+	CheckpointWriter m_checkpointWriter;
+
+	GenerationLog m_generationLog;
+	HallOfFame m_hallOfFame;
 
 public:
+	// scores on the game of the surrounding project
 	Population(const uint64_t numGenotypes, const uint16_t numInputs, const uint16_t numOutputs);
+	Population(const uint64_t numGenotypes, const uint16_t numInputs, const uint16_t numOutputs, std::unique_ptr<Evaluator> evaluator);
 
-	static double scorePhenotype(const std::unique_ptr<Phenotype>& phenotypePtr);
 	void scoreGenerationThreaded();
 	void scoreGeneration();
 	void selection();
 
-	void perform(sf::RenderWindow& window, bool& showFitnessRecord, bool& showSpeciesRecord, bool& showGenotype, bool& showPerformance, double& time_step);
+	const ThreadPool::Stats& getScoringStats() const {
+		return m_threadPool.getStats();
+	}
+
+	void setSchedulingPolicy(const SchedulingPolicy schedulingPolicy) {
+		m_schedulingPolicy = schedulingPolicy;
+	}
+
+	void setBatchingPolicy(const BatchingPolicy batchingPolicy) {
+		m_batchingPolicy = batchingPolicy;
+	}
+
+	void setRacingPolicy(const RacingPolicy racingPolicy) {
+		m_racingPolicy = racingPolicy;
+	}
+
+	void setCachePolicy(const CachePolicy cachePolicy);
+
+	/*
+	 * Saves a checkpoint to the path after the selection of every interval-th generation,
+	 * or never with an interval of 0. The checkpoint is taken during selection and
+	 * written to disk in the background, while the next generation is scored.
+	 *
+	 * With deltas, every generation in between appends a delta to the file at
+	 * Checkpoint::getDeltaPath(path), once there is a full checkpoint to follow.
+	 */
+	void setCheckpointing(const std::string& path, const uint64_t interval, const bool saveDeltas = false);
+
+	// waits until the checkpoints taken so far are written
+	void flushCheckpoints() {
+		m_checkpointWriter.flush();
+	}
+
+	/*
+	 * Logs every generation from the next selection on to the file at the path, see
+	 * GenerationLog. An existing log is appended to. The log is completed when it is
+	 * closed or the population is destroyed.
+	 */
+	bool openGenerationLog(const std::string& path) {
+		return m_generationLog.open(path);
+	}
+
+	void closeGenerationLog() {
+		m_generationLog.close();
+	}
+
+	/*
+	 * Archives the best recordsPerGeneration genotypes of every generation from the
+	 * next selection on to the file at the path, see HallOfFame. An existing archive
+	 * is continued.
+	 */
+	bool openHallOfFame(const std::string& path, const uint32_t recordsPerGeneration = HallOfFame::defaultRecordsPerGeneration) {
+		return m_hallOfFame.open(path, recordsPerGeneration);
+	}
+
+	// writes the lookup tables of the archive and waits until it is written
+	void closeHallOfFame() {
+		m_hallOfFame.close();
+	}
+
+	/*
+	 * Every genotype plays the number of episodes, each on a stream of its own. The
+	 * episodes are scored as separate tasks, so the workers stay busy even when there
+	 * are few genotypes per worker, and are reduced by the aggregation afterwards.
+	 * Racing is not used with more than one episode, as the episodes of a genotype
+	 * are only complete together.
+	 */
+	void setNumEpisodes(const unsigned numEpisodes);
+
+	// quantile is only used with Aggregation::Quantile, 0 is the worst episode and 1 the best
+	void setAggregation(const Aggregation aggregation, const double quantile = 0.5) {
+		m_aggregation = aggregation;
+		m_aggregationQuantile = std::min(1.0, std::max(0.0, quantile));
+	}
+
+	/*
+	 * With a number of shared seeds, every genotype of a generation plays one episode
+	 * on each of the same environment seeds (common random numbers), which are drawn
+	 * anew every generation. The seeds take the place of the episodes above, the
+	 * score is aggregated over them and selection compares the genotypes seed by seed.
+	 * 0 gives every episode a stream of its own again.
+	 */
+	void setNumSharedSeeds(const unsigned numSharedSeeds);
+
+	unsigned getNumSharedSeeds() const {
+		return m_numSharedSeeds;
+	}
+
+	/*
+	 * Records the trajectories of the given number of best scored episodes of every
+	 * generation, so the champion can be replayed without playing it again. Only
+	 * evaluators that support replays record anything. 0 records nothing.
+	 */
+	void setNumRecordedTrajectories(const size_t numRecordedTrajectories) {
+		m_trajectoryRecorder.setCapacity(numRecordedTrajectories);
+	}
+
+	const TrajectoryRecorder& getTrajectoryRecorder() const {
+		return m_trajectoryRecorder;
+	}
+
+	unsigned getNumEpisodes() const {
+		return m_numSharedSeeds > 0 ? m_numSharedSeeds : m_numEpisodes;
+	}
+
+	FitnessCache& getFitnessCache() {
+		return m_fitnessCache;
+	}
+
+	const Race::Report& getRaceReport() const {
+		return m_race.getReport();
+	}
+
+	// number of genotypes of every structure in the latest scored generation, empty unless batching by topology
+	const std::vector<size_t>& getTopologyBucketSizes() const {
+		return m_topologyBucketSizes;
+	}
+
+	const CostRecord& getCostRecord() const {
+		return m_costRecord;
+	}
+
+	Evaluator& getEvaluator() {
+		return *m_evaluator;
+	}
+
+	void setEvaluator(std::unique_ptr<Evaluator> evaluator) {
+		m_evaluator = std::move(evaluator);
+	}
+
+private:
+	RacingPolicy getRacingPolicy() const;
+	std::vector<size_t> predictCosts();
+	void prepareEpisodes();
+	void aggregateEpisodes(const std::vector<std::vector<slot_t>>& batches, std::vector<EpisodeResult>& results) const;
+	std::vector<std::vector<slot_t>> makeBatches(const std::vector<size_t>& order);
+	void printTopologyBuckets() const;
+	void beginRace();
+	void finishRace();
+	std::vector<size_t> applyFitnessCache(const std::vector<size_t>& order, std::vector<EpisodeResult>& results);
+	void updateFitnessCache(std::vector<EpisodeResult>& results);
+	void printFitnessCache() const;
+	void evaluateBatch(const std::vector<slot_t>& slots, const unsigned episode, const unsigned workerIndex);
+	void recordEpisodes(const std::vector<EpisodeResult>& results);
+	void findBestGenotype();
+	void keepBestTrajectory();
+
+public:
+	const GenePool& getGenePool() const {
+		return m_genePool;
+	}
+
+	const History& getFitnessRecord() const {
+		return m_fitnessRecord;
+	}
+
+	uint64_t getGenerationId() const {
+		return m_generationId;
+	}
+
+	// the best genotype of the latest scored generation, or nullptr when none scored above 0
+	const Genotype* getBestGenotypeInGeneration() const {
+		const auto& genotypes = m_genePool.getGenotypes();
+		return genotypes.isValid(m_bestGenotypeInGeneration) ? &genotypes.get(m_bestGenotypeInGeneration) : nullptr;
+	}
 
+	// the best recorded episode of the best genotype, or nullptr when none of its episodes were recorded
+	const Trajectory* getBestTrajectory() const {
+		return m_hasBestTrajectory ? &m_bestTrajectory : nullptr;
+	}
 };
 
 #endif /* NEAT_POPULATION_HPP_ */
@@ -0,0 +1,109 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "util/NumberGenerator.hpp"
+#include "Population.hpp"
+#include "Phenotype.hpp"
+#include "io/NetworkExport.hpp"
+#include "runtime/Network.hpp"
+
+/*
+ * Measures how long one inference of an exported network takes with
+ * runtime/Network.hpp, in nanoseconds.
+ *
+ * Without a network file, trains the drone model (7 inputs, 4 outputs) for a few
+ * generations, exports its champion to drone.network and measures that. Then
+ * Phenotype::execute is measured on the same inputs as well, and the outputs of
+ * both are compared.
+ *
+ * usage: benchmark [network] [iterations]
+ */
+static constexpr uint64_t numTrainingGenerations = 30;
+static constexpr size_t numInputSets = 1024;
+
+int main(int argc, char** argv) {
+	std::string networkPath = argc > 1 ? argv[1] : "";
+	const uint64_t numIterations = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000000;
+
+	std::unique_ptr<Phenotype> phenotype;
+	if (networkPath.empty()) {
+		NumberGenerator::initialize(1);
+		Population population(200, 7, 4);
+		for (uint64_t generation(0); generation < numTrainingGenerations; ++generation) {
+			population.scoreGenerationThreaded();
+			population.selection();
+		}
+		population.scoreGenerationThreaded();
+
+		const Genotype* champion = population.getBestGenotypeInGeneration();
+		if (champion == nullptr) {
+			std::cerr << "No genotype scored above 0" << std::endl;
+			return 1;
+		}
+
+		networkPath = "drone.network";
+		if (!NetworkExport::save(*champion, networkPath)) {
+			return 1;
+		}
+		phenotype = std::make_unique<Phenotype>(*champion);
+	}
+
+	MappedNetwork mappedNetwork;
+	if (!mappedNetwork.open(networkPath)) {
+		std::cerr << "Could not load network " << networkPath << std::endl;
+		return 1;
+	}
+	const Network& network = mappedNetwork.getNetwork();
+
+	std::mt19937_64 random(1);
+	std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+	std::vector<double> inputs(numInputSets * network.getNumInputs());
+	for (double& input : inputs) {
+		input = distribution(random);
+	}
+
+	std::vector<double> outputs(network.getNumOutputs());
+	std::vector<double> nodeInputs(network.getScratchSize());
+
+	// the sum of the outputs is printed, so the inferences can not be left out
+	double outputSum = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (uint64_t iteration(0); iteration < numIterations; ++iteration) {
+		network.execute(&inputs[(iteration % numInputSets) * network.getNumInputs()], outputs.data(), nodeInputs.data());
+		outputSum += outputs[0];
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << std::setprecision(4) << "Network of " << network.getNumInputs() << " inputs, " << network.getNumOutputs() << " outputs, " << network.getNumNodes() << " nodes and " << network.getNumConnections() << " connections: " << seconds * 1e9 / numIterations << " ns per inference (output sum " << outputSum << ")" << std::endl;
+
+	if (phenotype == nullptr) {
+		return 0;
+	}
+
+	std::vector<double> phenotypeOutputs(phenotype->getNumOutputs());
+	size_t numMismatches = 0;
+	for (size_t inputSet(0); inputSet < numInputSets; ++inputSet) {
+		network.execute(&inputs[inputSet * network.getNumInputs()], outputs.data(), nodeInputs.data());
+		phenotype->execute(&inputs[inputSet * network.getNumInputs()], phenotypeOutputs.data());
+		numMismatches += std::memcmp(outputs.data(), phenotypeOutputs.data(), outputs.size() * sizeof(double)) != 0;
+	}
+
+	outputSum = 0;
+	const auto phenotypeStart = std::chrono::steady_clock::now();
+	for (uint64_t iteration(0); iteration < numIterations; ++iteration) {
+		phenotype->execute(&inputs[(iteration % numInputSets) * network.getNumInputs()], phenotypeOutputs.data());
+		outputSum += phenotypeOutputs[0];
+	}
+	const double phenotypeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - phenotypeStart).count();
+
+	std::cout << "Phenotype of " << phenotype->getNumNodes() << " nodes and " << phenotype->getNumConnections() << " connections: " << phenotypeSeconds * 1e9 / numIterations << " ns per inference (output sum " << outputSum << "), " << numMismatches << " of " << numInputSets << " outputs differ" << std::endl;
+
+	return numMismatches == 0 ? 0 : 1;
+}
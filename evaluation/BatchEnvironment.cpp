@@ -0,0 +1,23 @@
+#include "BatchEnvironment.hpp"
+
+#include <numeric>
+
+BatchEnvironment::BatchEnvironment()
+	: m_numLanes(0)
+	, m_isActive()
+	, m_scores()
+	, m_steps() {
+}
+
+void BatchEnvironment::resize(const size_t numLanes) {
+	m_numLanes = numLanes;
+	m_isActive.assign(numLanes, 0);
+	m_scores.assign(numLanes, 0.0);
+	m_steps.assign(numLanes, 0);
+
+	resizeLanes(numLanes);
+}
+
+size_t BatchEnvironment::countActive() const {
+	return std::accumulate(m_isActive.begin(), m_isActive.end(), size_t(0));
+}
@@ -0,0 +1,78 @@
+#ifndef NEAT_EVALUATION_BATCHENVIRONMENT_HPP_
+#define NEAT_EVALUATION_BATCHENVIRONMENT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/*
+ * A number of instances of one environment that are stepped together.
+ *
+ * Every instance is a lane, and the state of all lanes is stored as one array per
+ * state variable, so that generating inputs and stepping are plain loops over the
+ * lanes. Inputs and outputs are exchanged input-major: value i of lane l is at
+ * [i * numLanes + l]. A lane whose episode is over is masked off: it keeps its state,
+ * score and step count while the other lanes carry on.
+ */
+class BatchEnvironment {
+protected:
+	size_t m_numLanes;
+	std::vector<uint8_t> m_isActive;
+	std::vector<double> m_scores;
+	std::vector<uint64_t> m_steps;
+
+protected:
+	virtual void resizeLanes(const size_t numLanes) = 0;
+
+public:
+	BatchEnvironment();
+	virtual ~BatchEnvironment() {}
+
+	virtual uint16_t getNumInputs() const = 0;
+	virtual uint16_t getNumOutputs() const = 0;
+
+	// the most a lane can score in one step, used to tell when an episode can no longer catch up
+	virtual double getMaxScorePerStep() const {
+		return std::numeric_limits<double>::infinity();
+	}
+
+	// makes room for numLanes lanes, which all need a resetLane() before stepping
+	void resize(const size_t numLanes);
+
+	/*
+	 * Starts a new episode in the lane and activates it. Random starting states are
+	 * drawn from the current thread stream, so the caller decides which stream that is.
+	 */
+	virtual void resetLane(const size_t lane) = 0;
+
+	virtual void generateInputs(double* inputs) const = 0;
+
+	// advances every active lane by one step, counting steps and score and masking off lanes that are done
+	virtual void step(const double* outputs) = 0;
+
+	// masks the lane off, ending its episode with the score it has
+	void stopLane(const size_t lane) {
+		m_isActive[lane] = 0;
+	}
+
+	size_t countActive() const;
+
+	size_t getNumLanes() const {
+		return m_numLanes;
+	}
+
+	bool isActive(const size_t lane) const {
+		return m_isActive[lane];
+	}
+
+	double getScore(const size_t lane) const {
+		return m_scores[lane];
+	}
+
+	uint64_t getSteps(const size_t lane) const {
+		return m_steps[lane];
+	}
+};
+
+#endif /* NEAT_EVALUATION_BATCHENVIRONMENT_HPP_ */
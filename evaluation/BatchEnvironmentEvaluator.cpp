@@ -0,0 +1,120 @@
+#include "BatchEnvironmentEvaluator.hpp"
+
+#include <algorithm>
+
+#include "../Phenotype.hpp"
+#include "../util/NumberGenerator.hpp"
+#include "Race.hpp"
+
+BatchEnvironmentEvaluator::BatchEnvironmentEvaluator(const EnvironmentFactory& environmentFactory, const size_t batchSize, const uint64_t maxSteps)
+	: m_environmentFactory(environmentFactory)
+	, m_batchSize(batchSize)
+	, m_maxSteps(maxSteps)
+	, m_workerStates() {
+}
+
+void BatchEnvironmentEvaluator::prepare(const unsigned numWorkers) {
+	while (m_workerStates.size() < numWorkers) {
+		WorkerState workerState;
+		workerState.environment = m_environmentFactory();
+		m_workerStates.push_back(std::move(workerState));
+	}
+}
+
+void BatchEnvironmentEvaluator::groupLanes(std::vector<Phenotype>& phenotypes, WorkerState& workerState) const {
+	// only groups whose inputs and outputs line up with those of the environment can be read and written in place
+	const BatchEnvironment& environment = *workerState.environment;
+
+	BatchedPhenotype::findGroups(phenotypes, workerState.laneGroups);
+	workerState.laneGroups.erase(std::remove_if(workerState.laneGroups.begin(), workerState.laneGroups.end(), [&phenotypes, &environment](const BatchedPhenotype::Group& group) {
+		const Phenotype& representative = phenotypes[group.begin];
+		return representative.getNumInputs() != environment.getNumInputs() || representative.getNumOutputs() != environment.getNumOutputs();
+	}), workerState.laneGroups.end());
+
+	if (workerState.batchedPhenotypes.size() < workerState.laneGroups.size()) {
+		workerState.batchedPhenotypes.resize(workerState.laneGroups.size());
+	}
+	for (size_t i(0); i < workerState.laneGroups.size(); ++i) {
+		workerState.batchedPhenotypes[i].load(phenotypes, workerState.laneGroups[i].begin, workerState.laneGroups[i].end);
+	}
+}
+
+void BatchEnvironmentEvaluator::evaluate(std::vector<Phenotype>& phenotypes, const std::vector<slot_t>& slots, const WorkerContext& context, std::vector<EpisodeResult>& results) {
+	WorkerState& workerState = m_workerStates[context.workerIndex];
+	BatchEnvironment& environment = *workerState.environment;
+
+	const size_t numLanes = phenotypes.size();
+	const size_t numInputs = environment.getNumInputs();
+	const size_t numOutputs = environment.getNumOutputs();
+
+	environment.resize(numLanes);
+	for (size_t lane(0); lane < numLanes; ++lane) {
+		NumberGenerator::ScopedStream stream(context.createEpisodeStream(slots[lane]));
+		environment.resetLane(lane);
+	}
+
+	workerState.inputs.resize(numInputs * numLanes);
+	workerState.outputs.assign(numOutputs * numLanes, 0.0);
+
+	groupLanes(phenotypes, workerState);
+
+	for (uint64_t step(0); step < m_maxSteps && environment.countActive() > 0; ++step) {
+		environment.generateInputs(workerState.inputs.data());
+
+		// grouped lanes run all at once, lanes that are done included, as the environment ignores them
+		for (size_t i(0); i < workerState.laneGroups.size(); ++i) {
+			const size_t begin = workerState.laneGroups[i].begin;
+			workerState.batchedPhenotypes[i].execute(workerState.inputs.data() + begin, numLanes, workerState.outputs.data() + begin, numLanes);
+		}
+
+		// the other lanes each gather their column, run and scatter it back
+		size_t nextGroup = 0;
+		for (size_t lane(0); lane < numLanes; ++lane) {
+			if (nextGroup < workerState.laneGroups.size() && lane >= workerState.laneGroups[nextGroup].begin) {
+				lane = workerState.laneGroups[nextGroup].end - 1;
+				++nextGroup;
+				continue;
+			}
+
+			if (!environment.isActive(lane)) {
+				continue;
+			}
+
+			Phenotype& phenotype = phenotypes[lane];
+			workerState.laneInputs.assign(phenotype.getNumInputs(), 0.0);
+			workerState.laneOutputs.assign(std::max<size_t>(phenotype.getNumOutputs(), numOutputs), 0.0);
+
+			const size_t numLaneInputs = std::min(numInputs, phenotype.getNumInputs());
+			for (size_t i(0); i < numLaneInputs; ++i) {
+				workerState.laneInputs[i] = workerState.inputs[i * numLanes + lane];
+			}
+
+			phenotype.execute(workerState.laneInputs.data(), workerState.laneOutputs.data());
+
+			for (size_t i(0); i < numOutputs; ++i) {
+				workerState.outputs[i * numLanes + lane] = workerState.laneOutputs[i];
+			}
+		}
+
+		environment.step(workerState.outputs.data());
+
+		if (context.race != nullptr) {
+			for (size_t lane(0); lane < numLanes; ++lane) {
+				if (!environment.isActive(lane)) {
+					continue;
+				}
+
+				const uint64_t laneSteps = environment.getSteps(lane);
+				const double maxRemainingGain = environment.getMaxScorePerStep() * (m_maxSteps - laneSteps);
+				if (context.race->checkpoint(slots[lane], laneSteps, environment.getScore(lane), maxRemainingGain)) {
+					environment.stopLane(lane);
+				}
+			}
+		}
+	}
+
+	for (size_t lane(0); lane < numLanes; ++lane) {
+		results[lane].score = environment.getScore(lane);
+		results[lane].steps = environment.getSteps(lane);
+	}
+}
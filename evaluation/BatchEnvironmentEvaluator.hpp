@@ -0,0 +1,60 @@
+#ifndef NEAT_EVALUATION_BATCHENVIRONMENTEVALUATOR_HPP_
+#define NEAT_EVALUATION_BATCHENVIRONMENTEVALUATOR_HPP_
+
+#include <functional>
+#include <memory>
+
+#include "Evaluator.hpp"
+#include "BatchEnvironment.hpp"
+#include "BatchedPhenotype.hpp"
+
+/*
+ * Scores a batch of phenotypes by playing one episode each in a lane of a batch
+ * environment, with all lanes stepping together until every lane is done or
+ * maxSteps steps have passed.
+ *
+ * Every worker has its own environment and buffers, so nothing is allocated per step.
+ * Lanes are reset inside the evaluation stream of their genotype, so a genotype starts
+ * from the same state whichever batch and worker it ends up in.
+ *
+ * Neighbouring lanes whose phenotypes have the same structure are executed together as
+ * one BatchedPhenotype. The population puts genotypes of the same topology next to each
+ * other when it batches by topology, other lanes are executed one by one.
+ */
+class BatchEnvironmentEvaluator : public Evaluator {
+public:
+	using EnvironmentFactory = std::function<std::unique_ptr<BatchEnvironment>()>;
+
+private:
+	struct WorkerState {
+		std::unique_ptr<BatchEnvironment> environment;
+		std::vector<BatchedPhenotype::Group> laneGroups;
+		std::vector<BatchedPhenotype> batchedPhenotypes;
+		std::vector<double> inputs;
+		std::vector<double> outputs;
+		std::vector<double> laneInputs;
+		std::vector<double> laneOutputs;
+	};
+
+	EnvironmentFactory m_environmentFactory;
+	size_t m_batchSize;
+	uint64_t m_maxSteps;
+
+	std::vector<WorkerState> m_workerStates;
+
+private:
+	void groupLanes(std::vector<Phenotype>& phenotypes, WorkerState& workerState) const;
+
+public:
+	BatchEnvironmentEvaluator(const EnvironmentFactory& environmentFactory, const size_t batchSize = 32, const uint64_t maxSteps = 10000);
+
+	void prepare(const unsigned numWorkers) override;
+
+	size_t getBatchSize() const override {
+		return m_batchSize;
+	}
+
+	void evaluate(std::vector<Phenotype>& phenotypes, const std::vector<slot_t>& slots, const WorkerContext& context, std::vector<EpisodeResult>& results) override;
+};
+
+#endif /* NEAT_EVALUATION_BATCHENVIRONMENTEVALUATOR_HPP_ */
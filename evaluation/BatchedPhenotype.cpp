@@ -0,0 +1,119 @@
+#include "BatchedPhenotype.hpp"
+
+#include <algorithm>
+
+#include "../Phenotype.hpp"
+
+BatchedPhenotype::BatchedPhenotype()
+	: m_batchSize(0)
+	, m_isInput()
+	, m_isOutput()
+	, m_connectionOffsets()
+	, m_connectionTargets()
+	, m_inputIndices()
+	, m_outputIndices()
+	, m_biases()
+	, m_weights()
+	, m_nodeInputs()
+	, m_activations() {
+}
+
+void BatchedPhenotype::findGroups(const std::vector<Phenotype>& phenotypes, std::vector<Group>& groups) {
+	groups.clear();
+
+	size_t begin = 0;
+	while (begin < phenotypes.size()) {
+		size_t end = begin + 1;
+		while (end < phenotypes.size() && phenotypes[end].hasSameStructure(phenotypes[begin])) {
+			++end;
+		}
+
+		if (end - begin > 1) {
+			groups.push_back({begin, end});
+		}
+		begin = end;
+	}
+}
+
+void BatchedPhenotype::load(const std::vector<Phenotype>& phenotypes, const size_t begin, const size_t end) {
+	const Phenotype& representative = phenotypes[begin];
+	const size_t batchSize = end - begin;
+	const size_t numNodes = representative.getNumNodes();
+	const size_t numConnections = representative.getNumConnections();
+
+	m_batchSize = batchSize;
+	m_isInput = representative.getIsInput();
+	m_isOutput = representative.getIsOutput();
+	m_connectionOffsets = representative.getConnectionOffsets();
+	m_connectionTargets = representative.getConnectionTargets();
+	m_inputIndices = representative.getInputIndices();
+	m_outputIndices = representative.getOutputIndices();
+
+	m_biases.resize(numNodes * batchSize);
+	m_weights.resize(numConnections * batchSize);
+	m_nodeInputs.resize(numNodes * batchSize);
+	m_activations.resize(batchSize);
+
+	for (size_t member(0); member < batchSize; ++member) {
+		const Phenotype& phenotype = phenotypes[begin + member];
+		const std::vector<double>& biases = phenotype.getBiases();
+		const std::vector<double>& weights = phenotype.getWeights();
+
+		for (size_t node(0); node < numNodes; ++node) {
+			m_biases[node * batchSize + member] = biases[node];
+		}
+		for (size_t connection(0); connection < numConnections; ++connection) {
+			m_weights[connection * batchSize + member] = weights[connection];
+		}
+	}
+}
+
+void BatchedPhenotype::execute(const double* inputs, const size_t inputStride, double* outputs, const size_t outputStride) {
+	const size_t batchSize = m_batchSize;
+	const size_t numNodes = m_isInput.size();
+
+	std::fill(m_nodeInputs.begin(), m_nodeInputs.end(), 0.0);
+
+	for (size_t i(0); i < m_inputIndices.size(); ++i) {
+		std::copy(inputs + i * inputStride, inputs + i * inputStride + batchSize, m_nodeInputs.begin() + m_inputIndices[i] * batchSize);
+	}
+
+	double* activations = m_activations.data();
+	for (size_t node(0); node < numNodes; ++node) {
+		double* nodeInputs = m_nodeInputs.data() + node * batchSize;
+		const double* biases = m_biases.data() + node * batchSize;
+
+		// outputs are read without activation, so they keep their raw value
+		if (m_isOutput[node]) {
+			for (size_t member(0); member < batchSize; ++member) {
+				nodeInputs[member] += biases[member];
+			}
+			continue;
+		}
+
+		if (m_isInput[node]) {
+			for (size_t member(0); member < batchSize; ++member) {
+				activations[member] = nodeInputs[member] + biases[member];
+			}
+		} else {
+			for (size_t member(0); member < batchSize; ++member) {
+				activations[member] = Phenotype::activateSigmoid(nodeInputs[member] + biases[member]);
+			}
+		}
+
+		const uint32_t end = m_connectionOffsets[node + 1];
+		for (uint32_t connection(m_connectionOffsets[node]); connection < end; ++connection) {
+			double* targetInputs = m_nodeInputs.data() + m_connectionTargets[connection] * batchSize;
+			const double* weights = m_weights.data() + connection * batchSize;
+
+			for (size_t member(0); member < batchSize; ++member) {
+				targetInputs[member] += weights[member] * activations[member];
+			}
+		}
+	}
+
+	for (size_t i(0); i < m_outputIndices.size(); ++i) {
+		const double* nodeInputs = m_nodeInputs.data() + m_outputIndices[i] * batchSize;
+		std::copy(nodeInputs, nodeInputs + batchSize, outputs + i * outputStride);
+	}
+}
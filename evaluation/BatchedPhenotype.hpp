@@ -0,0 +1,75 @@
+#ifndef NEAT_EVALUATION_BATCHEDPHENOTYPE_HPP_
+#define NEAT_EVALUATION_BATCHEDPHENOTYPE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Phenotype;
+
+/*
+ * A group of phenotypes with the same structure, executed together.
+ *
+ * The structure is stored once, and the biases and weights of the members are
+ * stacked along a batch axis: value m of node or connection i is at [i * batchSize + m].
+ * Every node then turns into one batched row operation, so the whole network is a
+ * batched matrix-vector product over its sparse (skip connected) weight matrix, with
+ * the inner loops running across the members. Each member gets exactly the result its
+ * own phenotype would compute.
+ */
+class BatchedPhenotype {
+public:
+	struct Group {
+		size_t begin;
+		size_t end;
+	};
+
+private:
+	size_t m_batchSize;
+
+	std::vector<uint8_t> m_isInput;
+	std::vector<uint8_t> m_isOutput;
+	std::vector<uint32_t> m_connectionOffsets;
+	std::vector<uint32_t> m_connectionTargets;
+	std::vector<uint32_t> m_inputIndices;
+	std::vector<uint32_t> m_outputIndices;
+
+	std::vector<double> m_biases;
+	std::vector<double> m_weights;
+
+	// scratch space for execution
+	std::vector<double> m_nodeInputs;
+	std::vector<double> m_activations;
+
+public:
+	BatchedPhenotype();
+
+	/*
+	 * Finds the runs of at least two neighbouring phenotypes with the same structure.
+	 * Single phenotypes are not worth the copying and are left out.
+	 */
+	static void findGroups(const std::vector<Phenotype>& phenotypes, std::vector<Group>& groups);
+
+	// phenotypes[begin, end) become the members, they must all have the same structure
+	void load(const std::vector<Phenotype>& phenotypes, const size_t begin, const size_t end);
+
+	/*
+	 * Input i of member m is read from inputs[i * inputStride + m], output i of member m
+	 * is written to outputs[i * outputStride + m]. Performs no allocation.
+	 */
+	void execute(const double* inputs, const size_t inputStride, double* outputs, const size_t outputStride);
+
+	size_t getBatchSize() const {
+		return m_batchSize;
+	}
+
+	size_t getNumInputs() const {
+		return m_inputIndices.size();
+	}
+
+	size_t getNumOutputs() const {
+		return m_outputIndices.size();
+	}
+};
+
+#endif /* NEAT_EVALUATION_BATCHEDPHENOTYPE_HPP_ */
@@ -0,0 +1,89 @@
+#include "CartPoleBatch.hpp"
+
+#include <cmath>
+
+#include "../util/NumberGenerator.hpp"
+
+namespace {
+	const double gravity = 9.8;
+	const double cartMass = 1.0;
+	const double poleMass = 0.1;
+	const double totalMass = cartMass + poleMass;
+	const double poleHalfLength = 0.5;
+	const double poleMassLength = poleMass * poleHalfLength;
+	const double forceMagnitude = 10.0;
+	const double timeStep = 0.02;
+
+	const double xLimit = 2.4;
+	const double thetaLimit = 12.0 * 2.0 * M_PI / 360.0;
+	const double startRange = 0.05;
+}
+
+CartPoleBatch::CartPoleBatch()
+	: BatchEnvironment()
+	, m_x()
+	, m_xDot()
+	, m_theta()
+	, m_thetaDot() {
+}
+
+void CartPoleBatch::resizeLanes(const size_t numLanes) {
+	m_x.assign(numLanes, 0.0);
+	m_xDot.assign(numLanes, 0.0);
+	m_theta.assign(numLanes, 0.0);
+	m_thetaDot.assign(numLanes, 0.0);
+}
+
+void CartPoleBatch::resetLane(const size_t lane) {
+	m_x[lane] = NumberGenerator::getSym(startRange);
+	m_xDot[lane] = NumberGenerator::getSym(startRange);
+	m_theta[lane] = NumberGenerator::getSym(startRange);
+	m_thetaDot[lane] = NumberGenerator::getSym(startRange);
+
+	m_isActive[lane] = 1;
+	m_scores[lane] = 0;
+	m_steps[lane] = 0;
+}
+
+void CartPoleBatch::generateInputs(double* inputs) const {
+	const size_t n = m_numLanes;
+
+	for (size_t lane(0); lane < n; ++lane) {
+		inputs[0 * n + lane] = m_x[lane] / xLimit;
+		inputs[1 * n + lane] = m_xDot[lane] / 2.0;
+		inputs[2 * n + lane] = m_theta[lane] / thetaLimit;
+		inputs[3 * n + lane] = m_thetaDot[lane] / 2.0;
+		inputs[4 * n + lane] = 1.0;
+	}
+}
+
+void CartPoleBatch::step(const double* outputs) {
+	/*
+	 * All lanes are integrated, and lanes that are masked off simply keep their old
+	 * state, so the loop has no branches that depend on the lane.
+	 */
+	for (size_t lane(0); lane < m_numLanes; ++lane) {
+		const double force = outputs[lane] > 0 ? forceMagnitude : -forceMagnitude;
+		const double cosTheta = std::cos(m_theta[lane]);
+		const double sinTheta = std::sin(m_theta[lane]);
+
+		const double temp = (force + poleMassLength * m_thetaDot[lane] * m_thetaDot[lane] * sinTheta) / totalMass;
+		const double thetaAcc = (gravity * sinTheta - cosTheta * temp) / (poleHalfLength * (4.0 / 3.0 - poleMass * cosTheta * cosTheta / totalMass));
+		const double xAcc = temp - poleMassLength * thetaAcc * cosTheta / totalMass;
+
+		const bool isActive = m_isActive[lane];
+		m_x[lane] = isActive ? m_x[lane] + timeStep * m_xDot[lane] : m_x[lane];
+		m_xDot[lane] = isActive ? m_xDot[lane] + timeStep * xAcc : m_xDot[lane];
+		m_theta[lane] = isActive ? m_theta[lane] + timeStep * m_thetaDot[lane] : m_theta[lane];
+		m_thetaDot[lane] = isActive ? m_thetaDot[lane] + timeStep * thetaAcc : m_thetaDot[lane];
+	}
+
+	for (size_t lane(0); lane < m_numLanes; ++lane) {
+		const uint8_t isActive = m_isActive[lane];
+		const bool failed = std::abs(m_x[lane]) > xLimit || std::abs(m_theta[lane]) > thetaLimit;
+
+		m_steps[lane] += isActive;
+		m_scores[lane] += isActive;
+		m_isActive[lane] = isActive & !failed;
+	}
+}
@@ -0,0 +1,49 @@
+#ifndef NEAT_EVALUATION_CARTPOLEBATCH_HPP_
+#define NEAT_EVALUATION_CARTPOLEBATCH_HPP_
+
+#include "BatchEnvironment.hpp"
+
+/*
+ * The classic pole balancing task: a pole is hinged on a cart that is pushed left or
+ * right with a fixed force every step, and the episode ends once the pole tilts more
+ * than 12 degrees or the cart leaves the track. Every step the pole stays up scores 1.
+ *
+ * Inputs are the cart position, cart velocity, pole angle and pole angular velocity,
+ * each scaled to roughly [-1, 1], followed by a constant bias of 1. The cart is pushed
+ * right when output 0 is positive and left otherwise.
+ */
+class CartPoleBatch : public BatchEnvironment {
+public:
+	static constexpr uint16_t numInputs = 5;
+	static constexpr uint16_t numOutputs = 1;
+
+private:
+	std::vector<double> m_x;
+	std::vector<double> m_xDot;
+	std::vector<double> m_theta;
+	std::vector<double> m_thetaDot;
+
+protected:
+	void resizeLanes(const size_t numLanes) override;
+
+public:
+	CartPoleBatch();
+
+	uint16_t getNumInputs() const override {
+		return numInputs;
+	}
+
+	uint16_t getNumOutputs() const override {
+		return numOutputs;
+	}
+
+	double getMaxScorePerStep() const override {
+		return 1.0;
+	}
+
+	void resetLane(const size_t lane) override;
+	void generateInputs(double* inputs) const override;
+	void step(const double* outputs) override;
+};
+
+#endif /* NEAT_EVALUATION_CARTPOLEBATCH_HPP_ */
@@ -0,0 +1,144 @@
+#ifndef NEAT_EVALUATION_EPISODE_HPP_
+#define NEAT_EVALUATION_EPISODE_HPP_
+
+#ifdef __cpp_impl_coroutine
+
+#include <coroutine>
+#include <exception>
+#include <unordered_map>
+#include <utility>
+
+#include "Evaluator.hpp"
+
+/*
+ * The connection between a suspended episode and the network playing it.
+ *
+ * An episode co_awaits execute(inputs) where it would otherwise call
+ * Phenotype::execute. It is suspended until the scheduler has run the network,
+ * which lets the scheduler collect the calls of many episodes and run them together.
+ * The inputs have to stay alive across the co_await, which a local variable or a
+ * temporary in the same expression does.
+ */
+class NetworkPort {
+public:
+	class Awaiter {
+	private:
+		NetworkPort& m_port;
+
+	public:
+		explicit Awaiter(NetworkPort& port) : m_port(port) {}
+
+		bool await_ready() const noexcept {
+			return false;
+		}
+
+		void await_suspend(std::coroutine_handle<>) const noexcept {}
+
+		const std::unordered_map<id_t, double>& await_resume() const noexcept {
+			return m_port.m_outputs;
+		}
+	};
+
+private:
+	const std::unordered_map<id_t, double>* m_inputs;
+	std::unordered_map<id_t, double> m_outputs;
+
+public:
+	NetworkPort() : m_inputs(nullptr), m_outputs() {}
+
+	Awaiter execute(const std::unordered_map<id_t, double>& inputs) {
+		m_inputs = &inputs;
+		return Awaiter(*this);
+	}
+
+	bool isPending() const {
+		return m_inputs != nullptr;
+	}
+
+	const std::unordered_map<id_t, double>& getInputs() const {
+		return *m_inputs;
+	}
+
+	// answers the pending call, the outputs are handed to the episode when it resumes
+	std::unordered_map<id_t, double>& answer() {
+		m_inputs = nullptr;
+		return m_outputs;
+	}
+};
+
+/*
+ * A coroutine playing one episode, returning its result with co_return.
+ *
+ * It starts suspended and only runs while resume() is called, up to its next
+ * co_await or its end.
+ */
+class Episode {
+public:
+	struct promise_type {
+		Evaluator::EpisodeResult result;
+
+		Episode get_return_object() {
+			return Episode(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend() noexcept {
+			return {};
+		}
+
+		std::suspend_always final_suspend() noexcept {
+			return {};
+		}
+
+		void return_value(const Evaluator::EpisodeResult& episodeResult) {
+			result = episodeResult;
+		}
+
+		void unhandled_exception() {
+			std::terminate();
+		}
+	};
+
+private:
+	std::coroutine_handle<promise_type> m_handle;
+
+public:
+	Episode() : m_handle() {}
+	explicit Episode(const std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+	Episode(Episode&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+
+	Episode& operator=(Episode&& other) noexcept {
+		if (this != &other) {
+			if (m_handle) {
+				m_handle.destroy();
+			}
+			m_handle = std::exchange(other.m_handle, {});
+		}
+		return *this;
+	}
+
+	Episode(const Episode&) = delete;
+	Episode& operator=(const Episode&) = delete;
+
+	~Episode() {
+		if (m_handle) {
+			m_handle.destroy();
+		}
+	}
+
+	bool isDone() const {
+		return !m_handle || m_handle.done();
+	}
+
+	void resume() {
+		m_handle.resume();
+	}
+
+	const Evaluator::EpisodeResult& getResult() const {
+		return m_handle.promise().result;
+	}
+};
+
+#endif /* __cpp_impl_coroutine */
+
+#endif /* NEAT_EVALUATION_EPISODE_HPP_ */
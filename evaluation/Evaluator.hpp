@@ -0,0 +1,79 @@
+#ifndef NEAT_EVALUATION_EVALUATOR_HPP_
+#define NEAT_EVALUATION_EVALUATOR_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../util/types.hpp"
+#include "../util/NumberGenerator.hpp"
+
+class Phenotype;
+class Race;
+class TrajectoryRecorder;
+
+/*
+ * A task the population is trained on.
+ *
+ * The population compiles the genotypes into phenotypes and hands them to the
+ * evaluator in batches of up to getBatchSize(), one batch per scoring task. An
+ * evaluator that gains from seeing several networks at once (stepping many
+ * environments in lockstep, evaluating equal topologies together, ...) asks for
+ * bigger batches; everything else just scores the batch one phenotype at a time.
+ *
+ * evaluate() is called concurrently from different workers. The worker index in
+ * the context is unique among the calls running at the same time, so per-worker
+ * scratch space set up in prepare() can be used without locking. Evaluators that
+ * draw random numbers should open a NumberGenerator::ScopedStream for each episode
+ * from createEpisodeStream(), so that the scores do not depend on which worker
+ * happens to run which batch. When every genotype plays several episodes, the
+ * same batch is evaluated once per episode, possibly by different workers at the
+ * same time, and the context tells which episode it is. With common random numbers
+ * every episode of a pass gets the same stream.
+ *
+ * When the context carries a race, episodes report their progress to it after every
+ * step and stop early when it says so. When it carries a recorder, evaluators that
+ * can be replayed record the trajectory of every episode and offer it when the
+ * episode ends.
+ */
+class Evaluator {
+public:
+	struct EpisodeResult {
+		double score = 0;
+		uint64_t steps = 0;
+	};
+
+	struct WorkerContext {
+		uint64_t generationId = 0;
+		unsigned workerIndex = 0;
+		Race* race = nullptr;
+		TrajectoryRecorder* recorder = nullptr;
+		unsigned episode = 0;
+		const RandomStream* sharedStream = nullptr; // set when all genotypes play on the same environment seed
+
+		RandomStream createEpisodeStream(const slot_t slot) const {
+			if (sharedStream != nullptr) {
+				return *sharedStream;
+			}
+			return NumberGenerator::createStream(generationId, slot, NumberGenerator::Purpose::Evaluation, episode);
+		}
+	};
+
+public:
+	virtual ~Evaluator() {}
+
+	// called from the scoring thread before the batches of a generation are handed out
+	virtual void prepare(const unsigned /*numWorkers*/) {}
+
+	virtual size_t getBatchSize() const {
+		return 1;
+	}
+
+	/*
+	 * Scores phenotypes[i], compiled from the genotype in slots[i], into results[i].
+	 * results has the same size as phenotypes.
+	 */
+	virtual void evaluate(std::vector<Phenotype>& phenotypes, const std::vector<slot_t>& slots, const WorkerContext& context, std::vector<EpisodeResult>& results) = 0;
+};
+
+#endif /* NEAT_EVALUATION_EVALUATOR_HPP_ */
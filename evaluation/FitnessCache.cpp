@@ -0,0 +1,37 @@
+#include "FitnessCache.hpp"
+
+FitnessCache::FitnessCache(const uint64_t samplesToSettle, const uint64_t maxAge)
+	: m_entries()
+	, m_samplesToSettle(samplesToSettle)
+	, m_maxAge(maxAge) {
+}
+
+const FitnessCache::Entry* FitnessCache::find(const uint64_t contentHash, const uint64_t generation) {
+	const auto& entryIt = m_entries.find(contentHash);
+	if (entryIt == m_entries.end()) {
+		return nullptr;
+	}
+
+	entryIt->second.lastUsedGeneration = generation;
+	return &entryIt->second;
+}
+
+const FitnessCache::Entry& FitnessCache::addSample(const uint64_t contentHash, const double score, const uint64_t steps, const uint64_t generation) {
+	Entry& entry = m_entries[contentHash];
+	entry.scoreSum += score;
+	entry.stepsSum += steps;
+	++entry.numSamples;
+	entry.lastUsedGeneration = generation;
+
+	return entry;
+}
+
+void FitnessCache::evict(const uint64_t generation) {
+	for (auto entryIt = m_entries.begin(); entryIt != m_entries.end();) {
+		if (generation - entryIt->second.lastUsedGeneration > m_maxAge) {
+			entryIt = m_entries.erase(entryIt);
+		} else {
+			++entryIt;
+		}
+	}
+}
@@ -0,0 +1,73 @@
+#ifndef NEAT_EVALUATION_FITNESSCACHE_HPP_
+#define NEAT_EVALUATION_FITNESSCACHE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+/*
+ * Scores of earlier evaluations, addressed by the content hash of the genotype.
+ *
+ * An entry collects samples until it has samplesToSettle of them and is then settled:
+ * its mean is used instead of scoring the genotype again. With a deterministic task
+ * one sample settles an entry. With a stochastic one every new evaluation of the same
+ * genotype adds a sample until the mean is trusted. Entries that have not been used
+ * for maxAge generations are dropped, which bounds the size of the cache.
+ */
+class FitnessCache {
+public:
+	static constexpr uint64_t defaultSamplesToSettle = 8;
+
+	struct Entry {
+		double scoreSum = 0;
+		double stepsSum = 0;
+		uint64_t numSamples = 0;
+		uint64_t lastUsedGeneration = 0;
+
+		double getScore() const {
+			return scoreSum / numSamples;
+		}
+
+		double getSteps() const {
+			return stepsSum / numSamples;
+		}
+	};
+
+private:
+	std::unordered_map<uint64_t, Entry> m_entries;
+	uint64_t m_samplesToSettle;
+	uint64_t m_maxAge;
+
+public:
+	FitnessCache(const uint64_t samplesToSettle = 1, const uint64_t maxAge = 10);
+
+	// nullptr when the genotype has not been seen, marks the entry as used otherwise
+	const Entry* find(const uint64_t contentHash, const uint64_t generation);
+
+	bool isSettled(const Entry& entry) const {
+		return entry.numSamples >= m_samplesToSettle;
+	}
+
+	// returns the entry with the sample merged in
+	const Entry& addSample(const uint64_t contentHash, const double score, const uint64_t steps, const uint64_t generation);
+
+	void evict(const uint64_t generation);
+
+	void clear() {
+		m_entries.clear();
+	}
+
+	size_t size() const {
+		return m_entries.size();
+	}
+
+	void setSamplesToSettle(const uint64_t samplesToSettle) {
+		m_samplesToSettle = samplesToSettle;
+	}
+
+	void setMaxAge(const uint64_t maxAge) {
+		m_maxAge = maxAge;
+	}
+};
+
+#endif /* NEAT_EVALUATION_FITNESSCACHE_HPP_ */
@@ -0,0 +1,210 @@
+#include "InterleavedEvaluator.hpp"
+
+#ifdef __cpp_impl_coroutine
+
+#include <algorithm>
+#include <utility>
+
+#include "../Phenotype.hpp"
+
+namespace {
+	// whether the call sends exactly the inputs -1 to -numInputs, the ones the input arrays hold
+	bool sendsAllInputs(const Phenotype& phenotype, const std::unordered_map<id_t, double>& inputs) {
+		if (inputs.size() != phenotype.getNumInputs()) {
+			return false;
+		}
+
+		for (size_t i(0); i < phenotype.getNumInputs(); ++i) {
+			if (inputs.find(-static_cast<id_t>(i + 1)) == inputs.end()) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+InterleavedEvaluator::InterleavedEvaluator(const EpisodeFunction& playEpisode, const size_t batchSize)
+	: m_playEpisode(playEpisode)
+	, m_batchSize(batchSize)
+	, m_workerStates() {
+}
+
+void InterleavedEvaluator::prepare(const unsigned numWorkers) {
+	if (m_workerStates.size() < numWorkers) {
+		m_workerStates.resize(numWorkers);
+	}
+}
+
+void InterleavedEvaluator::groupLanes(std::vector<Phenotype>& phenotypes, WorkerState& workerState) const {
+	BatchedPhenotype::findGroups(phenotypes, workerState.groups);
+
+	workerState.laneGroups.assign(phenotypes.size(), noGroup);
+	workerState.isGroupPending.assign(workerState.groups.size(), 0);
+	if (workerState.batchedPhenotypes.size() < workerState.groups.size()) {
+		workerState.batchedPhenotypes.resize(workerState.groups.size());
+	}
+
+	for (size_t i(0); i < workerState.groups.size(); ++i) {
+		const BatchedPhenotype::Group& group = workerState.groups[i];
+		workerState.batchedPhenotypes[i].load(phenotypes, group.begin, group.end);
+		std::fill(workerState.laneGroups.begin() + group.begin, workerState.laneGroups.begin() + group.end, i);
+	}
+}
+
+void InterleavedEvaluator::executePending(std::vector<Phenotype>& phenotypes, WorkerState& workerState) const {
+	const size_t numLanes = phenotypes.size();
+
+	/*
+	 * Lanes that run on their own are answered right away. Grouped lanes write their
+	 * inputs into their column of the input matrix first, input i of lane l going to
+	 * [i * numLanes + l], and are answered once their group has run.
+	 */
+	std::fill(workerState.isGroupPending.begin(), workerState.isGroupPending.end(), 0);
+	for (size_t lane(0); lane < numLanes; ++lane) {
+		NetworkPort& port = workerState.ports[lane];
+		if (!port.isPending()) {
+			continue;
+		}
+
+		Phenotype& phenotype = phenotypes[lane];
+		const std::unordered_map<id_t, double>& inputs = port.getInputs();
+		const size_t group = workerState.laneGroups[lane];
+
+		/*
+		 * The input arrays load and skip the activation of every input node, while the
+		 * map based execute does so only for the inputs that were sent. Any other call
+		 * is answered by the map based execute, so the outputs stay those of the
+		 * episode played on its own.
+		 */
+		if (!sendsAllInputs(phenotype, inputs)) {
+			std::unordered_map<id_t, double> outputs = phenotype.execute(inputs);
+			port.answer() = std::move(outputs);
+			continue;
+		}
+
+		double* laneInputs = workerState.laneInputs.data();
+		size_t inputStride = 1;
+		if (group != noGroup) {
+			laneInputs = workerState.inputs.data() + lane;
+			inputStride = numLanes;
+			workerState.isGroupPending[group] = 1;
+		}
+
+		for (size_t i(0); i < phenotype.getNumInputs(); ++i) {
+			laneInputs[i * inputStride] = inputs.find(-static_cast<id_t>(i + 1))->second;
+		}
+
+		if (group == noGroup) {
+			phenotype.execute(workerState.laneInputs.data(), workerState.laneOutputs.data());
+
+			std::unordered_map<id_t, double>& outputs = port.answer();
+			outputs.clear();
+			for (size_t i(0); i < phenotype.getNumOutputs(); ++i) {
+				outputs[phenotype.getNodeIds()[phenotype.getOutputIndices()[i]]] = workerState.laneOutputs[i];
+			}
+		}
+	}
+
+	for (size_t i(0); i < workerState.groups.size(); ++i) {
+		if (workerState.isGroupPending[i]) {
+			const size_t begin = workerState.groups[i].begin;
+			workerState.batchedPhenotypes[i].execute(workerState.inputs.data() + begin, numLanes, workerState.outputs.data() + begin, numLanes);
+		}
+	}
+
+	for (size_t lane(0); lane < numLanes; ++lane) {
+		NetworkPort& port = workerState.ports[lane];
+		if (!port.isPending()) {
+			continue;
+		}
+
+		const Phenotype& phenotype = phenotypes[lane];
+		std::unordered_map<id_t, double>& outputs = port.answer();
+		outputs.clear();
+		for (size_t i(0); i < phenotype.getNumOutputs(); ++i) {
+			outputs[phenotype.getNodeIds()[phenotype.getOutputIndices()[i]]] = workerState.outputs[i * numLanes + lane];
+		}
+	}
+}
+
+void InterleavedEvaluator::evaluate(std::vector<Phenotype>& phenotypes, const std::vector<slot_t>& slots, const WorkerContext& context, std::vector<EpisodeResult>& results) {
+	WorkerState& workerState = m_workerStates[context.workerIndex];
+	const size_t numLanes = phenotypes.size();
+
+	size_t numInputs = 0, numOutputs = 0;
+	for (const Phenotype& phenotype : phenotypes) {
+		numInputs = std::max(numInputs, phenotype.getNumInputs());
+		numOutputs = std::max(numOutputs, phenotype.getNumOutputs());
+	}
+	workerState.inputs.assign(numInputs * numLanes, 0.0);
+	workerState.outputs.assign(numOutputs * numLanes, 0.0);
+	workerState.laneInputs.resize(numInputs);
+	workerState.laneOutputs.resize(numOutputs);
+
+	groupLanes(phenotypes, workerState);
+
+	// the episodes hold on to their ports, so the ports are in place before any episode is created
+	workerState.ports.assign(numLanes, NetworkPort());
+	workerState.streams.clear();
+	workerState.episodes.clear();
+	if (context.recorder != nullptr && workerState.trajectories.size() < numLanes) {
+		// the buffers are kept between batches, so recording does not allocate once they have grown
+		workerState.trajectories.resize(numLanes);
+	}
+	for (size_t lane(0); lane < numLanes; ++lane) {
+		workerState.streams.push_back(context.createEpisodeStream(slots[lane]));
+
+		Trajectory* trajectory = nullptr;
+		if (context.recorder != nullptr) {
+			trajectory = &workerState.trajectories[lane];
+			trajectory->slot = slots[lane];
+			trajectory->episode = context.episode;
+			trajectory->stream = workerState.streams[lane];
+			trajectory->outputs.clear();
+
+			trajectory->outputIds.clear();
+			for (const uint32_t outputIndex : phenotypes[lane].getOutputIndices()) {
+				trajectory->outputIds.push_back(phenotypes[lane].getNodeIds()[outputIndex]);
+			}
+		}
+
+		workerState.episodes.push_back(m_playEpisode(workerState.ports[lane], slots[lane], context.race, trajectory));
+	}
+
+	while (true) {
+		// let every episode play up to its next network call
+		bool isAnyPending = false;
+		for (size_t lane(0); lane < numLanes; ++lane) {
+			Episode& episode = workerState.episodes[lane];
+			if (episode.isDone()) {
+				continue;
+			}
+
+			NumberGenerator::StreamBinding binding(workerState.streams[lane]);
+			episode.resume();
+			isAnyPending |= workerState.ports[lane].isPending();
+		}
+
+		if (!isAnyPending) {
+			break;
+		}
+
+		executePending(phenotypes, workerState);
+	}
+
+	for (size_t lane(0); lane < numLanes; ++lane) {
+		results[lane] = workerState.episodes[lane].getResult();
+
+		if (context.recorder != nullptr) {
+			Trajectory& trajectory = workerState.trajectories[lane];
+			trajectory.score = results[lane].score;
+			trajectory.steps = results[lane].steps;
+			context.recorder->offer(trajectory);
+		}
+	}
+
+	workerState.episodes.clear();
+}
+
+#endif /* __cpp_impl_coroutine */
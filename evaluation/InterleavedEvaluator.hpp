@@ -0,0 +1,83 @@
+#ifndef NEAT_EVALUATION_INTERLEAVEDEVALUATOR_HPP_
+#define NEAT_EVALUATION_INTERLEAVEDEVALUATOR_HPP_
+
+#ifdef __cpp_impl_coroutine
+
+#include <functional>
+
+#include "Evaluator.hpp"
+#include "Episode.hpp"
+#include "BatchedPhenotype.hpp"
+#include "Trajectory.hpp"
+#include "../util/NumberGenerator.hpp"
+
+/*
+ * Plays the episodes of a batch as coroutines on one worker, for environments that
+ * can not be written as a BatchEnvironment.
+ *
+ * Every round each unfinished episode is resumed until it awaits its next network
+ * call. The pending calls are then executed together, neighbouring phenotypes of the
+ * same structure as one BatchedPhenotype, and every episode gets its outputs before
+ * the next round. The environment code stays a plain step loop, the branchy parts of
+ * many episodes run back to back and the network work is done in bulk. Only calls
+ * that send exactly the inputs -1 to -numInputs are batched; any other call is run
+ * through the map based Phenotype::execute on its own, which gives the same outputs.
+ *
+ * Each episode draws random numbers from its own evaluation stream, which is bound
+ * whenever it runs, so it sees the same numbers as when it is played on its own.
+ * The episode function gets the slot, the race and, when the context carries a
+ * recorder, a trajectory of the lane, and reports to them as playEpisode would; the
+ * trajectories are offered once all episodes of the batch are done.
+ *
+ * Coroutines need C++20. With an older standard, this header and Episode.hpp declare
+ * nothing and the rest of the tree builds without them; build with -std=c++20 to
+ * use it, as the interleaved task of headless does.
+ */
+class InterleavedEvaluator : public Evaluator {
+public:
+	using EpisodeFunction = std::function<Episode(NetworkPort& network, const slot_t slot, Race* race, Trajectory* trajectory)>;
+
+private:
+	struct WorkerState {
+		std::vector<NetworkPort> ports;
+		std::vector<Episode> episodes;
+		std::vector<RandomStream> streams;
+		std::vector<Trajectory> trajectories;
+
+		std::vector<BatchedPhenotype::Group> groups;
+		std::vector<BatchedPhenotype> batchedPhenotypes;
+		std::vector<size_t> laneGroups; // group of every lane, noGroup when it runs on its own
+		std::vector<uint8_t> isGroupPending;
+
+		std::vector<double> inputs;
+		std::vector<double> outputs;
+		std::vector<double> laneInputs;
+		std::vector<double> laneOutputs;
+	};
+
+	static constexpr size_t noGroup = static_cast<size_t>(-1);
+
+	EpisodeFunction m_playEpisode;
+	size_t m_batchSize;
+
+	std::vector<WorkerState> m_workerStates;
+
+private:
+	void groupLanes(std::vector<Phenotype>& phenotypes, WorkerState& workerState) const;
+	void executePending(std::vector<Phenotype>& phenotypes, WorkerState& workerState) const;
+
+public:
+	InterleavedEvaluator(const EpisodeFunction& playEpisode, const size_t batchSize = 64);
+
+	void prepare(const unsigned numWorkers) override;
+
+	size_t getBatchSize() const override {
+		return m_batchSize;
+	}
+
+	void evaluate(std::vector<Phenotype>& phenotypes, const std::vector<slot_t>& slots, const WorkerContext& context, std::vector<EpisodeResult>& results) override;
+};
+
+#endif /* __cpp_impl_coroutine */
+
+#endif /* NEAT_EVALUATION_INTERLEAVEDEVALUATOR_HPP_ */
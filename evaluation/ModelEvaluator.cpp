@@ -0,0 +1,144 @@
+#include "ModelEvaluator.hpp"
+
+#include "../Phenotype.hpp"
+#include "Race.hpp"
+#include "Trajectory.hpp"
+#include "../util/NumberGenerator.hpp"
+
+#include "Interface.hpp"
+#include "mvc/Model.hpp"
+
+#include <iostream>
+
+ModelEvaluator::ModelEvaluator(const uint64_t maxSteps)
+	: m_maxSteps(maxSteps) {
+}
+
+//Evaluator::EpisodeResult ModelEvaluator::playEpisode(Phenotype& phenotype) const {
+//    Model model(Interface::getRandomSnake());
+//    uint64_t steps = 0;
+//
+//    while (!model.gameIsOver() && steps < 1000) {
+//		const std::unordered_map<id_t, double> inputs = Interface::generateInputs(model);
+//		const auto& outputs = phenotype.execute(inputs);
+//		Interface::interpretOutputs(model, outputs);
+//
+//		++steps;
+//    }
+//
+//    return {model.getScore(), steps};
+//}
+
+//Evaluator::EpisodeResult ModelEvaluator::playEpisode(Phenotype& phenotype) const {
+//    FBModel model;
+//    uint64_t steps = 0;
+//
+//    while (!model.gameIsOver()) {
+//		const std::unordered_map<id_t, double> inputs = FBInterface::generateInputs(model);
+//		const auto& outputs = phenotype.execute(inputs);
+//		FBInterface::interpretOutputs(model, outputs);
+//
+//		++steps;
+//		if (model.getScore() > 1000) {
+//			break;
+//		}
+//    }
+//
+//    return {model.getScore(), steps};
+//}
+
+bool ModelEvaluator::playStep(Model& model, const std::unordered_map<id_t, double>& outputs, uint64_t& steps, const slot_t slot, Race* race, Trajectory* trajectory) {
+	Interface::interpretOutputs(model, outputs);
+
+	if (trajectory != nullptr) {
+		for (const id_t outputId : trajectory->outputIds) {
+			trajectory->outputs.push_back(outputs.find(outputId)->second);
+		}
+	}
+
+	++steps;
+//	std::cout << model.getScore() << std::endl;
+
+	// nothing is known about how the game scores, so the race can not prove an episode hopeless and lets it run
+	return race == nullptr || !race->checkpoint(slot, steps, model.getScore(), Race::unbounded);
+}
+
+Evaluator::EpisodeResult ModelEvaluator::playEpisode(Phenotype& phenotype, const slot_t slot, Race* race, Trajectory* trajectory) const {
+//	std::cout << "	Scoring Phenotype!!" << std::endl;
+    Model model;
+    uint64_t steps = 0;
+
+    while (!model.gameIsOver() && steps < m_maxSteps) {
+		const std::unordered_map<id_t, double> inputs = Interface::generateInputs(model);
+		if (!playStep(model, phenotype.execute(inputs), steps, slot, race, trajectory)) {
+			break;
+		}
+    }
+
+    return {model.getScore(), steps};
+}
+
+#ifdef __cpp_impl_coroutine
+Episode ModelEvaluator::playEpisodeInterleaved(NetworkPort& network, const slot_t slot, Race* race, Trajectory* trajectory, const uint64_t maxSteps) {
+    Model model;
+    uint64_t steps = 0;
+
+    while (!model.gameIsOver() && steps < maxSteps) {
+		const std::unordered_map<id_t, double> inputs = Interface::generateInputs(model);
+		if (!playStep(model, co_await network.execute(inputs), steps, slot, race, trajectory)) {
+			break;
+		}
+    }
+
+    co_return EpisodeResult{model.getScore(), steps};
+}
+#endif
+
+void ModelEvaluator::evaluate(std::vector<Phenotype>& phenotypes, const std::vector<slot_t>& slots, const WorkerContext& context, std::vector<EpisodeResult>& results) {
+	if (context.recorder != nullptr) {
+		evaluateRecorded(phenotypes, slots, context, results);
+		return;
+	}
+
+	for (size_t i(0); i < phenotypes.size(); ++i) {
+		// the episode sees the same random numbers whichever worker runs it
+		NumberGenerator::ScopedStream stream(context.createEpisodeStream(slots[i]));
+		results[i] = playEpisode(phenotypes[i], slots[i], context.race);
+	}
+}
+
+void ModelEvaluator::evaluateRecorded(std::vector<Phenotype>& phenotypes, const std::vector<slot_t>& slots, const WorkerContext& context, std::vector<EpisodeResult>& results) const {
+	// the buffer is kept between episodes, so recording does not allocate once it has grown
+	static thread_local Trajectory trajectory;
+
+	for (size_t i(0); i < phenotypes.size(); ++i) {
+		trajectory.slot = slots[i];
+		trajectory.episode = context.episode;
+		trajectory.stream = context.createEpisodeStream(slots[i]);
+		trajectory.outputs.clear();
+
+		trajectory.outputIds.clear();
+		for (const uint32_t outputIndex : phenotypes[i].getOutputIndices()) {
+			trajectory.outputIds.push_back(phenotypes[i].getNodeIds()[outputIndex]);
+		}
+
+		NumberGenerator::ScopedStream stream(trajectory.stream);
+		results[i] = playEpisode(phenotypes[i], slots[i], context.race, &trajectory);
+
+		trajectory.score = results[i].score;
+		trajectory.steps = results[i].steps;
+		context.recorder->offer(trajectory);
+	}
+}
+
+void ModelEvaluator::replay(const Trajectory& trajectory, Model& model, const uint64_t step) {
+	std::unordered_map<id_t, double> outputs;
+	const double* values = trajectory.getOutputs(step);
+	for (size_t i(0); i < trajectory.outputIds.size(); ++i) {
+		outputs[trajectory.outputIds[i]] = values[i];
+	}
+
+	// the inputs are not needed, but generating them keeps the random numbers in step with the scored episode
+	Interface::generateInputs(model);
+	Interface::interpretOutputs(model, outputs);
+}
@@ -0,0 +1,50 @@
+#ifndef NEAT_EVALUATION_MODELEVALUATOR_HPP_
+#define NEAT_EVALUATION_MODELEVALUATOR_HPP_
+
+#include <unordered_map>
+
+#include "Evaluator.hpp"
+#include "Episode.hpp"
+
+struct Trajectory;
+class Model;
+
+/*
+ * Plays the game of the surrounding project, through Model and Interface, until
+ * the game is over or maxSteps steps have passed, and scores the network with
+ * the game score. Episodes can be recorded into a trajectory and replayed from it.
+ */
+class ModelEvaluator : public Evaluator {
+public:
+	static constexpr uint64_t defaultMaxSteps = 50000;
+
+private:
+	uint64_t m_maxSteps;
+
+	// plays the network's outputs of one step on the model, false once the race stops the episode
+	static bool playStep(Model& model, const std::unordered_map<id_t, double>& outputs, uint64_t& steps, const slot_t slot, Race* race, Trajectory* trajectory);
+
+public:
+	explicit ModelEvaluator(const uint64_t maxSteps = defaultMaxSteps);
+
+	// outputs of the network are appended to the trajectory at every step, if there is one
+	EpisodeResult playEpisode(Phenotype& phenotype, const slot_t slot = 0, Race* race = nullptr, Trajectory* trajectory = nullptr) const;
+
+#ifdef __cpp_impl_coroutine
+	// playEpisode with the network call awaited, to be played by an InterleavedEvaluator
+	static Episode playEpisodeInterleaved(NetworkPort& network, const slot_t slot = 0, Race* race = nullptr, Trajectory* trajectory = nullptr, const uint64_t maxSteps = defaultMaxSteps);
+#endif
+
+	void evaluate(std::vector<Phenotype>& phenotypes, const std::vector<slot_t>& slots, const WorkerContext& context, std::vector<EpisodeResult>& results) override;
+
+	/*
+	 * Plays the given step of a recorded episode on the model. Has to run under a ScopedStream of
+	 * the trajectory's stream, on a model that has played the steps before.
+	 */
+	static void replay(const Trajectory& trajectory, Model& model, const uint64_t step);
+
+private:
+	void evaluateRecorded(std::vector<Phenotype>& phenotypes, const std::vector<slot_t>& slots, const WorkerContext& context, std::vector<EpisodeResult>& results) const;
+};
+
+#endif /* NEAT_EVALUATION_MODELEVALUATOR_HPP_ */
@@ -0,0 +1,115 @@
+#include "Race.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+Race::Race()
+	: m_speciesBounds()
+	, m_isShadow(false)
+	, m_speciesIds()
+	, m_slotBounds()
+	, m_stopSteps()
+	, m_stopScores()
+	, m_report() {
+}
+
+void Race::beginGeneration(const std::vector<id_t>& speciesIds, const bool isShadow) {
+	const size_t numSlots = speciesIds.size();
+
+	m_isShadow = isShadow;
+	m_speciesIds = speciesIds;
+	m_stopSteps.assign(numSlots, noStop);
+	m_stopScores.assign(numSlots, 0.0);
+
+	m_slotBounds.assign(numSlots, nullptr);
+	for (slot_t slot(0); slot < numSlots; ++slot) {
+		const auto& speciesBoundsIt = m_speciesBounds.find(speciesIds[slot]);
+		if (speciesBoundsIt != m_speciesBounds.end()) {
+			m_slotBounds[slot] = &speciesBoundsIt->second;
+		}
+	}
+}
+
+bool Race::checkpoint(const slot_t slot, const uint64_t steps, const double partialScore, const double maxRemainingGain) {
+	if (steps == 0 || steps % checkpointInterval != 0) {
+		return false;
+	}
+
+	const SpeciesBounds* bounds = m_slotBounds[slot];
+	if (bounds == nullptr || m_stopSteps[slot] != noStop) {
+		return false;
+	}
+
+	if (partialScore + maxRemainingGain >= bounds->cutoff) {
+		return false;
+	}
+
+	m_stopSteps[slot] = steps;
+	m_stopScores[slot] = partialScore;
+	return !m_isShadow;
+}
+
+void Race::finishGeneration(const std::vector<double>& scores, const std::vector<uint64_t>& steps, const std::vector<double>& expectedEpisodeLengths) {
+	m_report = Report();
+	m_report.isShadow = m_isShadow;
+	m_report.numEpisodes = scores.size();
+
+	for (slot_t slot(0); slot < scores.size(); ++slot) {
+		m_report.stepsRun += steps[slot];
+
+		if (m_stopSteps[slot] == noStop) {
+			continue;
+		}
+
+		++m_report.numStopped;
+		if (m_isShadow) {
+			m_report.stepsSaved += steps[slot] - m_stopSteps[slot];
+		} else if (slot < expectedEpisodeLengths.size() && expectedEpisodeLengths[slot] > m_stopSteps[slot]) {
+			m_report.stepsSaved += expectedEpisodeLengths[slot] - m_stopSteps[slot];
+		}
+	}
+
+	/*
+	 * The kept half of every species is found the same way the gene pool finds it, from
+	 * the final scores. In shadow mode it is found a second time with the scores the
+	 * stopped episodes had when they would have been stopped. The lowest kept score sets
+	 * the bound for the next generation.
+	 */
+	std::unordered_map<id_t, std::vector<slot_t>> speciesSlots;
+	for (slot_t slot(0); slot < scores.size(); ++slot) {
+		speciesSlots[m_speciesIds[slot]].push_back(slot);
+	}
+
+	std::unordered_map<id_t, SpeciesBounds> speciesBounds;
+	for (auto& speciesSlotsIt : speciesSlots) {
+		std::vector<slot_t>& slots = speciesSlotsIt.second;
+		const size_t keepingIndex = std::ceil(slots.size() / 2.0);
+
+		std::sort(slots.begin(), slots.end(), [&scores](const slot_t i, const slot_t j) {
+			return scores[i] > scores[j];
+		});
+
+		if (m_isShadow) {
+			// stable, so genotypes that tie keep the order of the final scores and only a stop can change the kept half
+			std::vector<slot_t> racedSlots = slots;
+			std::stable_sort(racedSlots.begin(), racedSlots.end(), [this, &scores](const slot_t i, const slot_t j) {
+				const double scoreI = m_stopSteps[i] == noStop ? scores[i] : m_stopScores[i];
+				const double scoreJ = m_stopSteps[j] == noStop ? scores[j] : m_stopScores[j];
+				return scoreI > scoreJ;
+			});
+
+			std::vector<slot_t> kept(slots.begin(), slots.begin() + keepingIndex);
+			std::vector<slot_t> racedKept(racedSlots.begin(), racedSlots.begin() + keepingIndex);
+			std::sort(kept.begin(), kept.end());
+			std::sort(racedKept.begin(), racedKept.end());
+			if (kept != racedKept) {
+				++m_report.numSpeciesChanged;
+			}
+		}
+
+		speciesBounds[speciesSlotsIt.first].cutoff = scores[slots[keepingIndex - 1]];
+	}
+
+	m_report.numSpecies = speciesSlots.size();
+	m_speciesBounds = std::move(speciesBounds);
+}
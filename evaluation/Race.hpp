@@ -0,0 +1,82 @@
+#ifndef NEAT_EVALUATION_RACE_HPP_
+#define NEAT_EVALUATION_RACE_HPP_
+
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "../util/types.hpp"
+
+/*
+ * Stops episodes of genotypes that will not make the kept half of their species.
+ *
+ * Episodes report their partial score every checkpointInterval steps. An episode is
+ * stopped only when it provably can not reach the lowest final score that was kept in
+ * its species last generation, even gaining the most the evaluator says is possible in
+ * the steps it has left. An evaluator that can not bound the remaining gain passes
+ * unbounded, and its episodes are never stopped. Species without a previous
+ * generation are never raced.
+ *
+ * In shadow mode every episode still runs to the end, and the report tells how many
+ * steps would have been saved and in how many species the kept half would have been
+ * different had the hopeless episodes been stopped.
+ *
+ * Every slot is only touched by the worker scoring it, so checkpoint() needs no locking.
+ */
+class Race {
+public:
+	static constexpr uint64_t checkpointInterval = 100;
+	static constexpr uint64_t noStop = std::numeric_limits<uint64_t>::max();
+	static constexpr double unbounded = std::numeric_limits<double>::infinity();
+
+	struct Report {
+		bool isShadow = false;
+		uint64_t numEpisodes = 0;
+		uint64_t numStopped = 0;
+		uint64_t stepsRun = 0;
+		uint64_t stepsSaved = 0; // estimated from the expected episode lengths unless in shadow mode
+		uint64_t numSpecies = 0;
+		uint64_t numSpeciesChanged = 0; // only known in shadow mode
+	};
+
+private:
+	struct SpeciesBounds {
+		double cutoff = 0; // lowest final score kept
+	};
+
+	std::unordered_map<id_t, SpeciesBounds> m_speciesBounds;
+
+	bool m_isShadow;
+	std::vector<id_t> m_speciesIds;
+	std::vector<const SpeciesBounds*> m_slotBounds;
+	std::vector<uint64_t> m_stopSteps;
+	std::vector<double> m_stopScores;
+
+	Report m_report;
+
+public:
+	Race();
+
+	void beginGeneration(const std::vector<id_t>& speciesIds, const bool isShadow);
+
+	/*
+	 * Called by the episode of the slot after every step. Returns true when the episode
+	 * should stop now. maxRemainingGain is the most the episode can still score.
+	 */
+	bool checkpoint(const slot_t slot, const uint64_t steps, const double partialScore, const double maxRemainingGain);
+
+	// final scores and steps by slot, and the number of steps every episode was expected to take
+	void finishGeneration(const std::vector<double>& scores, const std::vector<uint64_t>& steps, const std::vector<double>& expectedEpisodeLengths);
+
+	// whether the episode of the slot was cut short, so its score is not its real score
+	bool wasStopped(const slot_t slot) const {
+		return !m_isShadow && m_stopSteps[slot] != noStop;
+	}
+
+	const Report& getReport() const {
+		return m_report;
+	}
+};
+
+#endif /* NEAT_EVALUATION_RACE_HPP_ */
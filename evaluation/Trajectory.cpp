@@ -0,0 +1,56 @@
+#include "Trajectory.hpp"
+
+#include <algorithm>
+
+namespace {
+	bool isBetter(const Trajectory& trajectory, const Trajectory& other) {
+		if (trajectory.score != other.score) {
+			return trajectory.score > other.score;
+		}
+		if (trajectory.slot != other.slot) {
+			return trajectory.slot < other.slot;
+		}
+		return trajectory.episode < other.episode;
+	}
+}
+
+TrajectoryRecorder::TrajectoryRecorder(const size_t capacity)
+	: m_capacity(capacity)
+	, m_mutex()
+	, m_trajectories() {
+}
+
+void TrajectoryRecorder::offer(Trajectory& trajectory) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_capacity == 0) {
+		return;
+	}
+
+	if (m_trajectories.size() == m_capacity) {
+		if (!isBetter(trajectory, m_trajectories.back())) {
+			return;
+		}
+		std::swap(trajectory, m_trajectories.back());
+	} else {
+		m_trajectories.emplace_back();
+		std::swap(trajectory, m_trajectories.back());
+	}
+
+	// move the new trajectory up to its place
+	for (size_t i(m_trajectories.size() - 1); i > 0 && isBetter(m_trajectories[i], m_trajectories[i - 1]); --i) {
+		std::swap(m_trajectories[i], m_trajectories[i - 1]);
+	}
+}
+
+const Trajectory* TrajectoryRecorder::find(const slot_t slot) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (const Trajectory& trajectory : m_trajectories) {
+		if (trajectory.slot == slot) {
+			return &trajectory;
+		}
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,82 @@
+#ifndef NEAT_EVALUATION_TRAJECTORY_HPP_
+#define NEAT_EVALUATION_TRAJECTORY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "../util/types.hpp"
+#include "../util/NumberGenerator.hpp"
+
+/*
+ * What the network decided at every step of one scored episode, along with the
+ * random stream the episode was played with.
+ *
+ * Everything else about the episode follows from these two: a game started under
+ * the same stream and fed the same outputs goes through the exact same states, even
+ * when it is stochastic. So a replay only has to drive the game with the recorded
+ * outputs, without the network, and shows the very episode that was scored.
+ */
+struct Trajectory {
+	slot_t slot = 0;
+	unsigned episode = 0;
+	double score = 0;
+	uint64_t steps = 0;
+
+	RandomStream stream;
+	std::vector<id_t> outputIds;
+	std::vector<double> outputs; // outputIds.size() per step
+
+	const double* getOutputs(const uint64_t step) const {
+		return outputs.data() + step * outputIds.size();
+	}
+};
+
+/*
+ * Keeps the trajectories of the best scored episodes of a generation.
+ *
+ * Every episode is recorded into a buffer of the worker that plays it and offered
+ * when it ends. Only the capacity best are kept, so which genotype turns out best
+ * does not have to be known up front, and the memory stays bounded by the capacity
+ * plus one buffer per worker. Equal scores are decided by slot and episode, so the
+ * kept trajectories do not depend on the order the episodes finish in.
+ */
+class TrajectoryRecorder {
+private:
+	size_t m_capacity;
+
+	mutable std::mutex m_mutex;
+	std::vector<Trajectory> m_trajectories; // best first
+
+public:
+	explicit TrajectoryRecorder(const size_t capacity = 0);
+
+	/*
+	 * Keeps the trajectory if it is among the best so far. The trajectory is swapped
+	 * with the one it displaces, so the caller can record into the old buffer next.
+	 */
+	void offer(Trajectory& trajectory);
+
+	// the best recorded episode of the slot, or nullptr
+	const Trajectory* find(const slot_t slot) const;
+
+	void clear() {
+		m_trajectories.clear();
+	}
+
+	const std::vector<Trajectory>& getTrajectories() const {
+		return m_trajectories;
+	}
+
+	size_t getCapacity() const {
+		return m_capacity;
+	}
+
+	void setCapacity(const size_t capacity) {
+		m_capacity = capacity;
+		m_trajectories.clear();
+	}
+};
+
+#endif /* NEAT_EVALUATION_TRAJECTORY_HPP_ */
@@ -0,0 +1,48 @@
+#include "XorEvaluator.hpp"
+
+#include <algorithm>
+
+#include "../Phenotype.hpp"
+
+#include <iostream>
+
+XorEvaluator::XorEvaluator(const double bias)
+	: m_bias(bias) {
+}
+
+void XorEvaluator::evaluate(std::vector<Phenotype>& phenotypes, const std::vector<slot_t>& slots, const WorkerContext& /*context*/, std::vector<EpisodeResult>& results) {
+	static const double inputVariants[4][2] = {{0, 0}, {0, 1}, {1, 0}, {1, 1}};
+	static const double desiredOutputs[4] = {0.0, 1.0, 1.0, 0.0};
+
+	std::vector<double> inputs;
+	std::vector<double> outputs;
+
+	for (size_t i(0); i < phenotypes.size(); ++i) {
+		Phenotype& phenotype = phenotypes[i];
+
+		if (phenotype.getNumInputs() < 2 || phenotype.getNumOutputs() < 1) {
+			std::cerr << "XOR needs at least 2 inputs and 1 output, genotype " << slots[i] << " has " << phenotype.getNumInputs() << " and " << phenotype.getNumOutputs() << std::endl;
+			results[i] = EpisodeResult();
+			continue;
+		}
+
+		inputs.assign(phenotype.getNumInputs(), m_bias);
+		outputs.resize(phenotype.getNumOutputs());
+
+		double totalError = 0;
+		for (size_t variant(0); variant < 4; ++variant) {
+			inputs[0] = inputVariants[variant][0];
+			inputs[1] = inputVariants[variant][1];
+			phenotype.execute(inputs.data(), outputs.data());
+
+			const double output = Phenotype::activateSigmoid(outputs[0]);
+			const double d = desiredOutputs[variant] - output;
+			totalError += d*d;
+
+//			std::cout << output << " -> " << d*d << " (" << inputs[0] << ", " << inputs[1] << ") ";
+		}
+
+		results[i].score = std::max(maxScore - totalError, 0.0);
+		results[i].steps = 4;
+	}
+}
@@ -0,0 +1,28 @@
+#ifndef NEAT_EVALUATION_XOREVALUATOR_HPP_
+#define NEAT_EVALUATION_XOREVALUATOR_HPP_
+
+#include "Evaluator.hpp"
+
+/*
+ * Scores how well a network computes the exclusive or of inputs -1 and -2.
+ *
+ * Every input combination is one step. Output 0 is squashed by the sigmoid and
+ * compared with the expected value, and the score is 4 minus the summed squared
+ * error, so a perfect network scores 4. Any further inputs are held at bias, which
+ * lets a population created with 3 inputs use -3 as a bias node.
+ * Needs no environment and no random numbers, which makes it the reference task.
+ */
+class XorEvaluator : public Evaluator {
+public:
+	static constexpr double maxScore = 4.0;
+
+private:
+	double m_bias;
+
+public:
+	explicit XorEvaluator(const double bias = 1.0);
+
+	void evaluate(std::vector<Phenotype>& phenotypes, const std::vector<slot_t>& slots, const WorkerContext& context, std::vector<EpisodeResult>& results) override;
+};
+
+#endif /* NEAT_EVALUATION_XOREVALUATOR_HPP_ */
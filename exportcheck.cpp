@@ -0,0 +1,135 @@
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "util/NumberGenerator.hpp"
+#include "Population.hpp"
+#include "Phenotype.hpp"
+#include "io/NetworkExport.hpp"
+
+/*
+ * Checks that a network exported as a C++ header computes the same outputs as
+ * Phenotype::execute, bit for bit.
+ *
+ * Trains the drone model (7 inputs, 4 outputs) for a few generations and exports
+ * its champion to drone_network.hpp in the temporary directory, next to a small
+ * program that runs it on inputs read from a file. That program is compiled with
+ * the given compiler and flags, always with -ffp-contract=off, as the header
+ * requires, and the outputs it writes are compared with those of the phenotype.
+ * Returns 1 if any of them differ or the program could not be built.
+ *
+ * usage: exportcheck [compiler] [flags]
+ */
+static constexpr uint64_t numTrainingGenerations = 30;
+static constexpr size_t numInputSets = 2000;
+
+static const char* const driverSource =
+	"#include <cstdio>\n"
+	"#include <vector>\n"
+	"\n"
+	"#include \"drone_network.hpp\"\n"
+	"\n"
+	"int main(int argc, char** argv) {\n"
+	"\tstd::FILE* inputFile = argc > 2 ? std::fopen(argv[1], \"rb\") : nullptr;\n"
+	"\tstd::FILE* outputFile = argc > 2 ? std::fopen(argv[2], \"wb\") : nullptr;\n"
+	"\tif (inputFile == nullptr || outputFile == nullptr) {\n"
+	"\t\treturn 1;\n"
+	"\t}\n"
+	"\n"
+	"\tstd::vector<double> inputs(drone_network::numInputs);\n"
+	"\tstd::vector<double> outputs(drone_network::numOutputs);\n"
+	"\twhile (std::fread(inputs.data(), sizeof(double), inputs.size(), inputFile) == inputs.size()) {\n"
+	"\t\tdrone_network::execute(inputs.data(), outputs.data());\n"
+	"\t\tstd::fwrite(outputs.data(), sizeof(double), outputs.size(), outputFile);\n"
+	"\t}\n"
+	"\n"
+	"\tstd::fclose(inputFile);\n"
+	"\treturn std::fclose(outputFile) == 0 ? 0 : 1;\n"
+	"}\n";
+
+static std::string quote(const std::filesystem::path& path) {
+	return "\"" + path.string() + "\"";
+}
+
+int main(int argc, char** argv) {
+	const std::string compiler = argc > 1 ? argv[1] : "c++";
+	const std::string flags = argc > 2 ? argv[2] : "-O3 -march=native";
+
+	NumberGenerator::initialize(1);
+	Population population(200, 7, 4);
+	for (uint64_t generation(0); generation < numTrainingGenerations; ++generation) {
+		population.scoreGenerationThreaded();
+		population.selection();
+	}
+	population.scoreGenerationThreaded();
+
+	const Genotype* champion = population.getBestGenotypeInGeneration();
+	if (champion == nullptr) {
+		std::cerr << "No genotype scored above 0" << std::endl;
+		return 1;
+	}
+	Phenotype phenotype(*champion);
+
+	std::error_code error;
+	const std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "neat_exportcheck";
+	std::filesystem::create_directories(directory, error);
+	if (error) {
+		std::cerr << "Could not create " << directory.string() << ": " << error.message() << std::endl;
+		return 1;
+	}
+
+	const std::filesystem::path driverPath = directory / "driver.cpp";
+	const std::filesystem::path programPath = directory / "driver";
+	const std::filesystem::path inputPath = directory / "inputs";
+	const std::filesystem::path outputPath = directory / "outputs";
+
+	if (!NetworkExport::saveHeader(*champion, (directory / "drone_network.hpp").string(), "drone_network")) {
+		return 1;
+	}
+	std::ofstream(driverPath) << driverSource;
+
+	std::mt19937_64 random(1);
+	std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+	std::vector<double> inputs(numInputSets * phenotype.getNumInputs());
+	for (double& input : inputs) {
+		input = distribution(random);
+	}
+	std::ofstream(inputPath, std::ios::binary).write(reinterpret_cast<const char*>(inputs.data()), inputs.size() * sizeof(double));
+
+	const std::string compileCommand = compiler + " -std=c++17 " + flags + " -ffp-contract=off " + quote(driverPath) + " -o " + quote(programPath);
+	std::cout << compileCommand << std::endl;
+	if (std::system(compileCommand.c_str()) != 0) {
+		std::cerr << "Could not compile the exported network" << std::endl;
+		return 1;
+	}
+
+	if (std::system((quote(programPath) + " " + quote(inputPath) + " " + quote(outputPath)).c_str()) != 0) {
+		std::cerr << "Could not run the exported network" << std::endl;
+		return 1;
+	}
+
+	std::ifstream outputFile(outputPath, std::ios::binary);
+	const std::vector<char> headerOutputs((std::istreambuf_iterator<char>(outputFile)), std::istreambuf_iterator<char>());
+	const size_t outputSize = phenotype.getNumOutputs() * sizeof(double);
+	if (headerOutputs.size() != numInputSets * outputSize) {
+		std::cerr << "The exported network wrote " << headerOutputs.size() << " bytes of outputs, expected " << numInputSets * outputSize << std::endl;
+		return 1;
+	}
+
+	std::vector<double> outputs(phenotype.getNumOutputs());
+	size_t numMismatches = 0;
+	for (size_t inputSet(0); inputSet < numInputSets; ++inputSet) {
+		phenotype.execute(&inputs[inputSet * phenotype.getNumInputs()], outputs.data());
+		numMismatches += std::memcmp(outputs.data(), &headerOutputs[inputSet * outputSize], outputSize) != 0;
+	}
+
+	std::cout << "Network of " << phenotype.getNumNodes() << " nodes and " << phenotype.getNumConnections() << " connections exported as a header: " << numMismatches << " of " << numInputSets << " outputs differ" << std::endl;
+
+	return numMismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+#include <chrono>
+#include <filesystem>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "util/NumberGenerator.hpp"
+#include "Population.hpp"
+#include "evaluation/ModelEvaluator.hpp"
+#include "evaluation/XorEvaluator.hpp"
+#include "evaluation/BatchEnvironmentEvaluator.hpp"
+#include "evaluation/CartPoleBatch.hpp"
+#include "evaluation/InterleavedEvaluator.hpp"
+#include "io/Checkpoint.hpp"
+
+/*
+ * Trains without a window, as fast as the scoring allows, for machines without a
+ * display. Needs none of the rendering sources nor SFML.
+ *
+ * With a checkpoint path, the run resumes from the checkpoint if there is one, and
+ * saves a checkpoint there every checkpointInterval generations, with a delta for
+ * every generation in between. With a log path, every generation is appended to a
+ * GenerationLog there. With a hall of fame path, the best genotypes of every
+ * generation are archived there. An empty path leaves its file out, so a log or
+ * hall of fame can be kept without checkpoints.
+ *
+ * The interleaved task plays the model as coroutines through an InterleavedEvaluator,
+ * which needs a build with C++20 coroutines (-std=c++20).
+ *
+ * usage: headless [generations] [model | xor | cartpole | interleaved] [seed] [checkpoint] [log] [hall of fame]
+ */
+static constexpr uint64_t checkpointInterval = 10;
+
+int main(int argc, char** argv) {
+	const uint64_t numGenerations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100;
+	const std::string task = argc > 2 ? argv[2] : "model";
+
+	if (argc > 3) {
+		NumberGenerator::initialize(std::strtoull(argv[3], nullptr, 10));
+	} else {
+		NumberGenerator::initialize();
+	}
+
+	std::unique_ptr<Population> population;
+	if (task == "model") {
+		population = std::make_unique<Population>(200, 7, 4); // Snake : (8, 3), Flappy bird : (3, 1) // Drone : (7, 4)
+	} else if (task == "xor") {
+		population = std::make_unique<Population>(200, 3, 1, std::make_unique<XorEvaluator>());
+	} else if (task == "cartpole") {
+		population = std::make_unique<Population>(200, CartPoleBatch::numInputs, CartPoleBatch::numOutputs, std::make_unique<BatchEnvironmentEvaluator>([]() {
+			return std::unique_ptr<BatchEnvironment>(new CartPoleBatch());
+		}));
+	} else if (task == "interleaved") {
+#ifdef __cpp_impl_coroutine
+		population = std::make_unique<Population>(200, 7, 4, std::make_unique<InterleavedEvaluator>([](NetworkPort& network, const slot_t slot, Race* race, Trajectory* trajectory) {
+			return ModelEvaluator::playEpisodeInterleaved(network, slot, race, trajectory);
+		}));
+#else
+		std::cerr << "The interleaved task needs a build with C++20 coroutines, -std=c++20" << std::endl;
+		return 1;
+#endif
+	} else {
+		std::cerr << "Unknown task " << task << ", expected model, xor, cartpole or interleaved" << std::endl;
+		return 1;
+	}
+
+	const std::string checkpointPath = argc > 4 ? argv[4] : "";
+	const std::string logPath = argc > 5 ? argv[5] : "";
+	const std::string hallOfFamePath = argc > 6 ? argv[6] : "";
+
+	if (!checkpointPath.empty()) {
+		if (std::filesystem::exists(checkpointPath)) {
+			const auto loadStart = std::chrono::steady_clock::now();
+			if (!Checkpoint::load(checkpointPath, *population)) {
+				return 1;
+			}
+			const double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+			std::cout << "Resumed generation " << population->getGenerationId() << " from " << checkpointPath << " in " << loadSeconds * 1000.0 << " ms" << std::endl;
+		}
+
+		population->setCheckpointing(checkpointPath, checkpointInterval, true);
+	}
+
+	if (!logPath.empty() && !population->openGenerationLog(logPath)) {
+		return 1;
+	}
+
+	if (!hallOfFamePath.empty() && !population->openHallOfFame(hallOfFamePath)) {
+		return 1;
+	}
+
+	std::cout << "Training " << task << " for " << numGenerations << " generations with seed " << NumberGenerator::getSeed() << std::endl;
+
+	const auto start = std::chrono::steady_clock::now();
+	for (uint64_t generation(0); generation < numGenerations; ++generation) {
+		population->scoreGenerationThreaded();
+		population->selection();
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	population->closeGenerationLog();
+	population->closeHallOfFame();
+
+	std::cout << std::setprecision(3) << "Trained " << numGenerations << " generations in " << seconds << " s (" << numGenerations / seconds << " generations per second), best fitness " << population->getGenePool().getGenotypeFitnessRecord() << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,683 @@
+#include "Checkpoint.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+#include "MappedFile.hpp"
+#include "../Population.hpp"
+#include "../util/NumberGenerator.hpp"
+
+#include <iostream>
+
+namespace {
+	const char magic[8] = {'N', 'E', 'A', 'T', 'C', 'K', 'P', 'T'};
+
+	enum Section : uint32_t {
+		Genotypes,
+		Synapses,
+		Neurons,
+		Nodes,
+		Outputs,
+		Innovations,
+		NodeOrder,
+		Species,
+		SpeciesSlots,
+		GenotypeScores,
+		ParentSlots,
+		IsChampion,
+		SpeciesRecordBuckets,
+		SpeciesRecordValues,
+		FitnessRecordBuckets,
+		FitnessRecordValues,
+		EpisodeLengths,
+		numSections
+	};
+
+	struct SectionEntry {
+		uint64_t offset;
+		uint64_t count;
+	};
+
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t numSectionEntries;
+		uint64_t fileSize;
+
+		uint64_t seed;
+		RandomStream threadStream;
+
+		uint64_t numGenotypes;
+		uint32_t numInputs;
+		uint32_t numOutputs;
+		uint32_t innovationIndex;
+		uint32_t neuronIndex;
+		id_t speciesIndex;
+		uint32_t padding;
+		uint64_t genePoolGenerationId;
+		double genotypeFitnessRecord;
+		uint64_t generationId;
+
+		SectionEntry sections[numSections];
+	};
+
+	// the genotypes of the pool, followed by the representatives of the species
+	struct GenotypeRecord {
+		uint64_t firstSynapse;
+		uint64_t firstNeuron;
+		uint64_t firstNode;
+		uint64_t firstInnovation;
+		uint64_t firstOrderedNode;
+		uint32_t numSynapses;
+		uint32_t numNeurons;
+		uint32_t numNodes;
+		uint32_t numInnovations;
+		uint32_t numOrderedNodes;
+		innov_t latestInnovation;
+	};
+
+	struct SynapseRecord {
+		double weight;
+		innov_t innovation;
+		id_t inputId;
+		id_t outputId;
+		uint32_t enabled;
+	};
+
+	struct NeuronRecord {
+		double bias;
+		id_t id;
+		uint32_t padding;
+	};
+
+	struct NodeRecord {
+		uint64_t firstOutput;
+		id_t id;
+		uint32_t numInputs;
+		uint32_t depth;
+		uint32_t numOutputs;
+	};
+
+	struct SpeciesRecord {
+		uint64_t firstGenotypeSlot;
+		uint64_t numGenotypeSlots;
+		double adjustedFitness;
+		uint64_t numberOfNextGeneration;
+		double speciesGenotypeFitnessRecord;
+		uint64_t generationsWithoutImprovement;
+		id_t id;
+		slot_t championSlot;
+	};
+
+	// the minimum, maximum and mean of every value, numValues each, from firstValue on
+	struct HistoryBucketRecord {
+		uint64_t firstGeneration;
+		uint64_t numGenerations;
+		uint64_t firstValue;
+		uint32_t level;
+		uint32_t numValues;
+	};
+
+	const size_t recordSizes[numSections] = {
+		sizeof(GenotypeRecord),
+		sizeof(SynapseRecord),
+		sizeof(NeuronRecord),
+		sizeof(NodeRecord),
+		sizeof(id_t),
+		sizeof(innov_t),
+		sizeof(id_t),
+		sizeof(SpeciesRecord),
+		sizeof(slot_t),
+		sizeof(double),
+		sizeof(slot_t),
+		sizeof(uint8_t),
+		sizeof(HistoryBucketRecord),
+		sizeof(double),
+		sizeof(HistoryBucketRecord),
+		sizeof(double),
+		sizeof(uint64_t)
+	};
+
+	const char deltaMagic[8] = {'N', 'E', 'A', 'T', 'D', 'L', 'T', 'A'};
+
+	// followed by the genotype scores, the shared seed scores and the episode lengths
+	struct DeltaHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t padding;
+		uint64_t size; // of the whole delta
+		uint64_t baseGenerationId;
+		uint64_t generationId;
+		RandomStream threadStream;
+		double topGenerationFitness;
+		uint64_t numGenotypeScores;
+		uint64_t numSharedSeedScores;
+		uint64_t numEpisodeLengths;
+	};
+
+	const size_t deltaHeaderSize = (sizeof(DeltaHeader) + 7) & ~size_t(7);
+
+	static_assert(std::is_trivially_copyable<RandomStream>::value, "the random stream is saved as it lies in memory");
+}
+
+struct Checkpoint::Writer {
+	std::vector<char> sections[numSections];
+	uint64_t counts[numSections] = {};
+
+	// returns the index of the first record
+	template <typename T>
+	uint64_t append(const uint32_t section, const T* records, const size_t count) {
+		std::vector<char>& bytes = sections[section];
+		const size_t size = bytes.size();
+		bytes.resize(size + count * sizeof(T));
+		if (count > 0) {
+			std::memcpy(bytes.data() + size, records, count * sizeof(T));
+		}
+
+		const uint64_t first = counts[section];
+		counts[section] += count;
+		return first;
+	}
+
+	template <typename T>
+	uint64_t append(const uint32_t section, const T& record) {
+		return append(section, &record, 1);
+	}
+};
+
+struct Checkpoint::Reader {
+	const char* data;
+	Header header;
+
+	template <typename T>
+	const T* get(const uint32_t section) const {
+		return reinterpret_cast<const T*>(data + header.sections[section].offset);
+	}
+
+	uint64_t count(const uint32_t section) const {
+		return header.sections[section].count;
+	}
+
+	// whether the records first to first + num lie within the section
+	bool contains(const uint32_t section, const uint64_t first, const uint64_t num) const {
+		return first <= count(section) && num <= count(section) - first;
+	}
+};
+
+void Checkpoint::writeGenotype(Writer& writer, const Genotype& genotype) {
+	GenotypeRecord record = {};
+	record.latestInnovation = genotype.m_latestInnovation;
+
+	record.firstSynapse = writer.counts[Synapses];
+	record.numSynapses = genotype.m_synapseGenes.size();
+	for (const auto& synapseGeneIt : genotype.m_synapseGenes) {
+		const SynapseGene& synapseGene = synapseGeneIt.second;
+
+		SynapseRecord synapse = {};
+		synapse.weight = synapseGene.getWeight();
+		synapse.innovation = synapseGeneIt.first;
+		synapse.inputId = synapseGene.getInputOutputIds().first;
+		synapse.outputId = synapseGene.getInputOutputIds().second;
+		synapse.enabled = synapseGene.isEnabled();
+		writer.append(Synapses, synapse);
+	}
+
+	record.firstNeuron = writer.counts[Neurons];
+	record.numNeurons = genotype.m_neuronGenes.size();
+	for (const auto& neuronGeneIt : genotype.m_neuronGenes) {
+		NeuronRecord neuron = {};
+		neuron.bias = neuronGeneIt.second;
+		neuron.id = neuronGeneIt.first;
+		writer.append(Neurons, neuron);
+	}
+
+	record.firstNode = writer.counts[Nodes];
+	record.numNodes = genotype.m_nodes.size();
+	for (const auto& nodeIt : genotype.m_nodes) {
+		const DirectedAcyclicGraph::Node& node = nodeIt.second;
+
+		NodeRecord nodeRecord = {};
+		nodeRecord.id = nodeIt.first;
+		nodeRecord.numInputs = node.numInputs;
+		nodeRecord.depth = node.depth;
+		nodeRecord.numOutputs = node.outputNodeIds.size();
+		nodeRecord.firstOutput = writer.counts[Outputs];
+		for (const id_t outputNodeId : node.outputNodeIds) {
+			writer.append(Outputs, outputNodeId);
+		}
+		writer.append(Nodes, nodeRecord);
+	}
+
+	record.numInnovations = genotype.m_innovations.size();
+	record.firstInnovation = writer.append(Innovations, genotype.m_innovations.data(), genotype.m_innovations.size());
+
+	record.numOrderedNodes = genotype.m_nodeOrder.size();
+	record.firstOrderedNode = writer.append(NodeOrder, genotype.m_nodeOrder.data(), genotype.m_nodeOrder.size());
+
+	writer.append(Genotypes, record);
+}
+
+bool Checkpoint::readGenotype(const Reader& reader, const uint64_t index, Genotype& genotype) {
+	const GenotypeRecord& record = reader.get<GenotypeRecord>(Genotypes)[index];
+	if (!reader.contains(Synapses, record.firstSynapse, record.numSynapses)
+		|| !reader.contains(Neurons, record.firstNeuron, record.numNeurons)
+		|| !reader.contains(Nodes, record.firstNode, record.numNodes)
+		|| !reader.contains(Innovations, record.firstInnovation, record.numInnovations)
+		|| !reader.contains(NodeOrder, record.firstOrderedNode, record.numOrderedNodes)) {
+		return false;
+	}
+
+	genotype.m_latestInnovation = record.latestInnovation;
+
+	const SynapseRecord* synapses = reader.get<SynapseRecord>(Synapses) + record.firstSynapse;
+	genotype.m_synapseGenes.reserve(record.numSynapses);
+	for (uint32_t i(0); i < record.numSynapses; ++i) {
+		const SynapseRecord& synapse = synapses[i];
+
+		SynapseGene synapseGene(synapse.weight, synapse.inputId, synapse.outputId);
+		if (!synapse.enabled) {
+			synapseGene.disable();
+		}
+		genotype.m_synapseGenes.emplace(synapse.innovation, synapseGene);
+	}
+
+	const NeuronRecord* neurons = reader.get<NeuronRecord>(Neurons) + record.firstNeuron;
+	genotype.m_neuronGenes.reserve(record.numNeurons);
+	for (uint32_t i(0); i < record.numNeurons; ++i) {
+		genotype.m_neuronGenes.emplace(neurons[i].id, neurons[i].bias);
+	}
+
+	const NodeRecord* nodes = reader.get<NodeRecord>(Nodes) + record.firstNode;
+	const id_t* outputs = reader.get<id_t>(Outputs);
+	genotype.m_nodes.reserve(record.numNodes);
+	for (uint32_t i(0); i < record.numNodes; ++i) {
+		const NodeRecord& nodeRecord = nodes[i];
+		if (!reader.contains(Outputs, nodeRecord.firstOutput, nodeRecord.numOutputs)) {
+			return false;
+		}
+
+		DirectedAcyclicGraph::Node& node = genotype.m_nodes[nodeRecord.id];
+		node.numInputs = nodeRecord.numInputs;
+		node.depth = nodeRecord.depth;
+		node.outputNodeIds.reserve(nodeRecord.numOutputs);
+		for (uint32_t j(0); j < nodeRecord.numOutputs; ++j) {
+			node.outputNodeIds.insert(outputs[nodeRecord.firstOutput + j]);
+		}
+	}
+
+	const innov_t* innovations = reader.get<innov_t>(Innovations) + record.firstInnovation;
+	genotype.m_innovations.assign(innovations, innovations + record.numInnovations);
+
+	const id_t* nodeOrder = reader.get<id_t>(NodeOrder) + record.firstOrderedNode;
+	genotype.m_nodeOrder.assign(nodeOrder, nodeOrder + record.numOrderedNodes);
+
+	return true;
+}
+
+void Checkpoint::writeHistory(Writer& writer, const History& history, const uint32_t bucketSection, const uint32_t valueSection) {
+	for (size_t level(0); level < history.m_levels.size(); ++level) {
+		for (const History::Bucket& bucket : history.m_levels[level]) {
+			HistoryBucketRecord record = {};
+			record.firstGeneration = bucket.firstGeneration;
+			record.numGenerations = bucket.numGenerations;
+			record.level = level;
+			record.numValues = bucket.mean.size();
+			record.firstValue = writer.append(valueSection, bucket.min.data(), bucket.min.size());
+			writer.append(valueSection, bucket.max.data(), bucket.max.size());
+			writer.append(valueSection, bucket.mean.data(), bucket.mean.size());
+			writer.append(bucketSection, record);
+		}
+	}
+}
+
+bool Checkpoint::readHistory(const Reader& reader, const uint32_t bucketSection, const uint32_t valueSection, History& history) {
+	history.clear();
+
+	const HistoryBucketRecord* buckets = reader.get<HistoryBucketRecord>(bucketSection);
+	const double* values = reader.get<double>(valueSection);
+	for (uint64_t i(0); i < reader.count(bucketSection); ++i) {
+		const HistoryBucketRecord& record = buckets[i];
+		if (!reader.contains(valueSection, record.firstValue, 3 * static_cast<uint64_t>(record.numValues))) {
+			return false;
+		}
+
+		if (record.level >= history.m_levels.size()) {
+			history.m_levels.resize(record.level + 1);
+		}
+
+		History::Bucket bucket;
+		bucket.firstGeneration = record.firstGeneration;
+		bucket.numGenerations = record.numGenerations;
+		bucket.min.assign(values + record.firstValue, values + record.firstValue + record.numValues);
+		bucket.max.assign(values + record.firstValue + record.numValues, values + record.firstValue + 2 * record.numValues);
+		bucket.mean.assign(values + record.firstValue + 2 * record.numValues, values + record.firstValue + 3 * record.numValues);
+		history.m_levels[record.level].push_back(std::move(bucket));
+
+		history.m_numGenerations += record.numGenerations;
+	}
+
+	return true;
+}
+
+std::vector<char> Checkpoint::write(const Population& population) {
+	const GenePool& genePool = population.m_genePool;
+
+	Writer writer;
+
+	for (const Genotype& genotype : genePool.m_genotypes) {
+		writeGenotype(writer, genotype);
+	}
+	for (const GenePool::Species& species : genePool.m_species) {
+		writeGenotype(writer, species.representativeGenotype);
+	}
+
+	for (const GenePool::Species& species : genePool.m_species) {
+		SpeciesRecord record = {};
+		record.id = species.id;
+		record.championSlot = species.championSlot;
+		record.numGenotypeSlots = species.genotypeSlots.size();
+		record.firstGenotypeSlot = writer.append(SpeciesSlots, species.genotypeSlots.data(), species.genotypeSlots.size());
+		record.adjustedFitness = species.adjustedFitness;
+		record.numberOfNextGeneration = species.numberOfNextGeneration;
+		record.speciesGenotypeFitnessRecord = species.speciesGenotypeFitnessRecord;
+		record.generationsWithoutImprovement = species.generationsWithoutImprovement;
+		writer.append(Species, record);
+	}
+
+	writer.append(GenotypeScores, genePool.m_genotypeScores.data(), genePool.m_genotypeScores.size());
+	writer.append(ParentSlots, genePool.m_parentSlots.data(), genePool.m_parentSlots.size());
+	writer.append(IsChampion, genePool.m_isChampion.data(), genePool.m_isChampion.size());
+
+	writeHistory(writer, genePool.m_speciesRecord, SpeciesRecordBuckets, SpeciesRecordValues);
+	writeHistory(writer, population.m_fitnessRecord, FitnessRecordBuckets, FitnessRecordValues);
+
+	writer.append(EpisodeLengths, population.m_episodeLengths.data(), population.m_episodeLengths.size());
+
+	Header header = {};
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.version = version;
+	header.numSectionEntries = numSections;
+	header.seed = NumberGenerator::getSeed();
+	header.threadStream = NumberGenerator::getThreadStream();
+	header.numGenotypes = genePool.m_numGenotypes;
+	header.numInputs = genePool.m_numInputs;
+	header.numOutputs = genePool.m_numOutputs;
+	header.innovationIndex = genePool.m_innovationIndex;
+	header.neuronIndex = genePool.m_neuronIndex;
+	header.speciesIndex = genePool.m_speciesIndex;
+	header.genePoolGenerationId = genePool.m_generationId;
+	header.genotypeFitnessRecord = genePool.m_genotypeFitnessRecord;
+	header.generationId = population.m_generationId;
+
+	// every section starts on 8 bytes, so its records can be read where they lie
+	uint64_t offset = (sizeof(Header) + 7) & ~uint64_t(7);
+	for (uint32_t section(0); section < numSections; ++section) {
+		header.sections[section].offset = offset;
+		header.sections[section].count = writer.counts[section];
+		offset += (writer.sections[section].size() + 7) & ~uint64_t(7);
+	}
+	header.fileSize = offset;
+
+	std::vector<char> data(offset, 0);
+	std::memcpy(data.data(), &header, sizeof(Header));
+	for (uint32_t section(0); section < numSections; ++section) {
+		if (!writer.sections[section].empty()) {
+			std::memcpy(data.data() + header.sections[section].offset, writer.sections[section].data(), writer.sections[section].size());
+		}
+	}
+
+	return data;
+}
+
+std::vector<char> Checkpoint::writeDelta(const Population& population, const uint64_t baseGenerationId) {
+	const GenePool& genePool = population.m_genePool;
+
+	DeltaHeader header = {};
+	std::memcpy(header.magic, deltaMagic, sizeof(deltaMagic));
+	header.version = version;
+	header.baseGenerationId = baseGenerationId;
+	header.generationId = population.m_generationId;
+	header.threadStream = NumberGenerator::getThreadStream();
+	header.topGenerationFitness = population.m_topGenerationFitness;
+	header.numGenotypeScores = genePool.m_genotypeScores.size();
+	header.numSharedSeedScores = genePool.m_sharedSeedScores.size();
+	header.numEpisodeLengths = population.m_episodeLengths.size();
+	header.size = deltaHeaderSize + (header.numGenotypeScores + header.numSharedSeedScores) * sizeof(double) + header.numEpisodeLengths * sizeof(uint64_t);
+
+	std::vector<char> data(header.size, 0);
+	char* position = data.data();
+	std::memcpy(position, &header, sizeof(DeltaHeader));
+	position += deltaHeaderSize;
+	std::memcpy(position, genePool.m_genotypeScores.data(), header.numGenotypeScores * sizeof(double));
+	position += header.numGenotypeScores * sizeof(double);
+	std::memcpy(position, genePool.m_sharedSeedScores.data(), header.numSharedSeedScores * sizeof(double));
+	position += header.numSharedSeedScores * sizeof(double);
+	std::memcpy(position, population.m_episodeLengths.data(), header.numEpisodeLengths * sizeof(uint64_t));
+
+	return data;
+}
+
+uint64_t Checkpoint::replayDeltas(const std::string& path, Population& population) {
+	MappedFile file;
+	if (!file.open(path)) {
+		return 0;
+	}
+
+	GenePool& genePool = population.m_genePool;
+	const uint64_t baseGenerationId = population.m_generationId;
+
+	uint64_t numReplayed = 0;
+	size_t offset = 0;
+	size_t intactSize = 0;
+	while (file.getSize() - offset >= sizeof(DeltaHeader)) {
+		const char* position = file.getData() + offset;
+
+		DeltaHeader header;
+		std::memcpy(&header, position, sizeof(DeltaHeader));
+		if (std::memcmp(header.magic, deltaMagic, sizeof(deltaMagic)) != 0 || header.version != version || header.size > file.getSize() - offset) {
+			break;
+		}
+		offset += header.size;
+
+		// deltas of an older checkpoint, left over when a crash came between the checkpoint and the new delta file
+		if (header.baseGenerationId != baseGenerationId) {
+			intactSize = offset;
+			continue;
+		}
+
+		if (header.generationId != population.m_generationId
+			|| header.numGenotypeScores != genePool.m_genotypeScores.size()
+			|| header.numSharedSeedScores != genePool.m_sharedSeedScores.size()
+			|| header.size != deltaHeaderSize + (header.numGenotypeScores + header.numSharedSeedScores) * sizeof(double) + header.numEpisodeLengths * sizeof(uint64_t)) {
+			std::cerr << "Delta of generation " << header.generationId << " in " << path << " does not follow generation " << population.m_generationId << ", stopped replaying" << std::endl;
+			break;
+		}
+
+		const double* genotypeScores = reinterpret_cast<const double*>(position + deltaHeaderSize);
+		const double* sharedSeedScores = genotypeScores + header.numGenotypeScores;
+		const uint64_t* episodeLengths = reinterpret_cast<const uint64_t*>(sharedSeedScores + header.numSharedSeedScores);
+
+		genePool.m_genotypeScores.assign(genotypeScores, genotypeScores + header.numGenotypeScores);
+		genePool.m_sharedSeedScores.assign(sharedSeedScores, sharedSeedScores + header.numSharedSeedScores);
+		population.m_episodeLengths.assign(episodeLengths, episodeLengths + header.numEpisodeLengths);
+		population.m_topGenerationFitness = header.topGenerationFitness;
+		population.m_fitnessRecord.push(header.topGenerationFitness);
+
+		// the selection as Population::selection makes it, from where the stream was then
+		NumberGenerator::setThreadStream(header.threadStream);
+		++population.m_generationId;
+		genePool.constructNextGeneration();
+
+		intactSize = offset;
+		++numReplayed;
+	}
+
+	// what could not be replayed is cut off, so the deltas of the resumed run follow the last good one
+	const size_t fileSize = file.getSize();
+	file.close();
+	if (intactSize < fileSize) {
+		std::error_code error;
+		std::filesystem::resize_file(path, intactSize, error);
+	}
+
+	return numReplayed;
+}
+
+bool Checkpoint::appendFile(const std::vector<char>& data, const std::string& path) {
+	std::ofstream file(path, std::ios::binary | std::ios::app);
+	file.write(data.data(), data.size());
+	if (!file) {
+		std::cerr << "Could not append to " << path << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool Checkpoint::writeFile(const std::vector<char>& data, const std::string& path) {
+	const std::string temporaryPath = path + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		file.write(data.data(), data.size());
+		if (!file) {
+			std::cerr << "Could not write checkpoint " << temporaryPath << std::endl;
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, path, error);
+	if (error) {
+		std::cerr << "Could not move checkpoint to " << path << ": " << error.message() << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool Checkpoint::save(const Population& population, const std::string& path) {
+	return writeFile(write(population), path);
+}
+
+bool Checkpoint::load(const std::string& path, Population& population) {
+	MappedFile file;
+	if (!file.open(path)) {
+		std::cerr << "Could not open checkpoint " << path << std::endl;
+		return false;
+	}
+
+	Reader reader;
+	reader.data = file.getData();
+	if (file.getSize() < sizeof(Header)) {
+		std::cerr << "Checkpoint " << path << " is too short" << std::endl;
+		return false;
+	}
+	std::memcpy(&reader.header, reader.data, sizeof(Header));
+
+	const Header& header = reader.header;
+	if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version || header.numSectionEntries != numSections) {
+		std::cerr << "Checkpoint " << path << " is not a checkpoint of version " << version << std::endl;
+		return false;
+	}
+	if (header.fileSize != file.getSize()) {
+		std::cerr << "Checkpoint " << path << " is " << file.getSize() << " bytes instead of " << header.fileSize << std::endl;
+		return false;
+	}
+	for (uint32_t section(0); section < numSections; ++section) {
+		const SectionEntry& entry = header.sections[section];
+		if (entry.offset % 8 != 0 || entry.offset > header.fileSize || entry.count > (header.fileSize - entry.offset) / recordSizes[section]) {
+			std::cerr << "Checkpoint " << path << " has a broken section " << section << std::endl;
+			return false;
+		}
+	}
+
+	GenePool& genePool = population.m_genePool;
+	if (header.numGenotypes != genePool.m_numGenotypes || header.numInputs != genePool.m_numInputs || header.numOutputs != genePool.m_numOutputs) {
+		std::cerr << "Checkpoint " << path << " is of a population of " << header.numGenotypes << " genotypes with " << header.numInputs << " inputs and " << header.numOutputs << " outputs" << std::endl;
+		return false;
+	}
+
+	const uint64_t numSpecies = reader.count(Species);
+	const uint64_t numGenotypes = reader.count(Genotypes) - std::min(reader.count(Genotypes), numSpecies);
+	if (reader.count(Genotypes) < numSpecies || reader.count(GenotypeScores) != numGenotypes || reader.count(ParentSlots) != numGenotypes || reader.count(IsChampion) != numGenotypes) {
+		std::cerr << "Checkpoint " << path << " has a broken genotype count" << std::endl;
+		return false;
+	}
+
+	/*
+	 * Everything is read into new containers first, so a broken file leaves the
+	 * population untouched.
+	 */
+	bool isIntact = true;
+
+	std::vector<Genotype> genotypes(numGenotypes);
+	for (uint64_t i(0); i < numGenotypes && isIntact; ++i) {
+		isIntact = readGenotype(reader, i, genotypes[i]);
+	}
+
+	std::vector<GenePool::Species> species(numSpecies);
+	const SpeciesRecord* speciesRecords = reader.get<SpeciesRecord>(Species);
+	const slot_t* speciesSlots = reader.get<slot_t>(SpeciesSlots);
+	for (uint64_t i(0); i < numSpecies && isIntact; ++i) {
+		const SpeciesRecord& record = speciesRecords[i];
+		isIntact = reader.contains(SpeciesSlots, record.firstGenotypeSlot, record.numGenotypeSlots) && readGenotype(reader, numGenotypes + i, species[i].representativeGenotype);
+		if (!isIntact) {
+			break;
+		}
+
+		species[i].id = record.id;
+		species[i].genotypeSlots.assign(speciesSlots + record.firstGenotypeSlot, speciesSlots + record.firstGenotypeSlot + record.numGenotypeSlots);
+		species[i].championSlot = record.championSlot;
+		species[i].adjustedFitness = record.adjustedFitness;
+		species[i].numberOfNextGeneration = record.numberOfNextGeneration;
+		species[i].speciesGenotypeFitnessRecord = record.speciesGenotypeFitnessRecord;
+		species[i].generationsWithoutImprovement = record.generationsWithoutImprovement;
+	}
+
+	History speciesRecord = genePool.m_speciesRecord;
+	History fitnessRecord = population.m_fitnessRecord;
+	isIntact = isIntact
+		&& readHistory(reader, SpeciesRecordBuckets, SpeciesRecordValues, speciesRecord)
+		&& readHistory(reader, FitnessRecordBuckets, FitnessRecordValues, fitnessRecord);
+
+	if (!isIntact) {
+		std::cerr << "Checkpoint " << path << " has records that point outside of their sections" << std::endl;
+		return false;
+	}
+
+	genePool.m_innovationIndex = header.innovationIndex;
+	genePool.m_neuronIndex = header.neuronIndex;
+	genePool.m_speciesIndex = header.speciesIndex;
+	genePool.m_species = std::move(species);
+	genePool.m_speciesRecord = std::move(speciesRecord);
+	genePool.m_genotypes.replace(std::move(genotypes));
+
+	const double* genotypeScores = reader.get<double>(GenotypeScores);
+	genePool.m_genotypeScores.assign(genotypeScores, genotypeScores + numGenotypes);
+	const slot_t* parentSlots = reader.get<slot_t>(ParentSlots);
+	genePool.m_parentSlots.assign(parentSlots, parentSlots + numGenotypes);
+	const uint8_t* isChampion = reader.get<uint8_t>(IsChampion);
+	genePool.m_isChampion.assign(isChampion, isChampion + numGenotypes);
+	genePool.m_generationId = header.genePoolGenerationId;
+	genePool.m_genotypeFitnessRecord = header.genotypeFitnessRecord;
+
+	population.m_generationId = header.generationId;
+	population.m_fitnessRecord = std::move(fitnessRecord);
+	const uint64_t* episodeLengths = reader.get<uint64_t>(EpisodeLengths);
+	population.m_episodeLengths.assign(episodeLengths, episodeLengths + reader.count(EpisodeLengths));
+	population.m_fitnessCache.clear();
+	population.m_bestGenotypeInGeneration = GenePool::GenotypeHandle();
+	population.m_hasBestTrajectory = false;
+
+	population.m_checkpointBasePath = path;
+	population.m_checkpointBaseGenerationId = header.generationId;
+
+	NumberGenerator::initialize(header.seed);
+	NumberGenerator::setThreadStream(header.threadStream);
+
+	replayDeltas(getDeltaPath(path), population);
+
+	return true;
+}
@@ -0,0 +1,90 @@
+#ifndef NEAT_IO_CHECKPOINT_HPP_
+#define NEAT_IO_CHECKPOINT_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Population;
+class GenePool;
+class Genotype;
+class History;
+
+/*
+ * Saves a population between generations and restores it, so a run goes on where it
+ * left off: the genotypes, the species with their representatives and stagnation
+ * counters, the innovation and neuron indices, the seed and the position of the
+ * calling thread's random stream, and the species and fitness records.
+ *
+ * A checkpoint is a header followed by the sections it lists. Every section is an
+ * array of fixed size records, aligned to 8 bytes, as they lie in the memory of the
+ * machine that wrote it. Loading maps the file and reads the records in place, so
+ * nothing is parsed and only the pages that are used are read. The version changes
+ * with every change to a record, and a file of another version is refused.
+ *
+ * The genes, nodes and connections of a genotype are written in whatever order its
+ * hash tables iterate them. Nothing that draws random numbers or adds up values walks
+ * those tables in their own order: the mutations go by innovation and neuron id, and
+ * the node order breaks ties by id. So a resumed run makes the same choices as one
+ * that was never stopped, whichever standard library built the tables.
+ *
+ * Fitness cache entries and recorded trajectories are not saved, they build up
+ * again within a generation.
+ *
+ * Between full checkpoints, a delta can be appended for every generation to a file
+ * next to the checkpoint. The next generation is a function of the current one, the
+ * scores and the random numbers alone: mating and mutation draw from streams of the
+ * generation and slot, or from the calling thread's stream. So a delta is the scores
+ * of a generation and the position of that stream before its selection. Resuming
+ * loads the full checkpoint and selects every delta's generation again, which makes
+ * the same children with the same edits. A delta is about a hundredth of a full
+ * checkpoint, as it holds a few numbers per genotype instead of its genes.
+ */
+class Checkpoint {
+public:
+	static constexpr uint32_t version = 2;
+
+public:
+	Checkpoint() = delete;
+
+	// the checkpoint as it would be written to a file
+	static std::vector<char> write(const Population& population);
+
+	static bool save(const Population& population, const std::string& path);
+
+	/*
+	 * Restores a checkpoint into a population of the same size, inputs and outputs,
+	 * which it then replaces all saved state of. Reseeds the number generator. Leaves
+	 * the population as it was if the file can not be read. Then replays the deltas
+	 * that follow the checkpoint, up to the first one that can not be read.
+	 */
+	static bool load(const std::string& path, Population& population);
+
+	// the delta of the generation that is about to be selected, which follows the full checkpoint of baseGenerationId
+	static std::vector<char> writeDelta(const Population& population, const uint64_t baseGenerationId);
+
+	static std::string getDeltaPath(const std::string& path) {
+		return path + ".deltas";
+	}
+
+	// writes next to the path first and then renames, so a crash never leaves half a checkpoint behind
+	static bool writeFile(const std::vector<char>& data, const std::string& path);
+
+	// a delta that was cut short by a crash is ignored when the deltas are replayed
+	static bool appendFile(const std::vector<char>& data, const std::string& path);
+
+private:
+	struct Writer;
+	struct Reader;
+
+	static void writeGenotype(Writer& writer, const Genotype& genotype);
+	static bool readGenotype(const Reader& reader, const uint64_t index, Genotype& genotype);
+
+	static void writeHistory(Writer& writer, const History& history, const uint32_t bucketSection, const uint32_t valueSection);
+	static bool readHistory(const Reader& reader, const uint32_t bucketSection, const uint32_t valueSection, History& history);
+
+	// selects the generations of the deltas that follow the loaded checkpoint, returns how many
+	static uint64_t replayDeltas(const std::string& path, Population& population);
+};
+
+#endif /* NEAT_IO_CHECKPOINT_HPP_ */
@@ -0,0 +1,85 @@
+#include "CheckpointWriter.hpp"
+
+#include <utility>
+
+#include "Checkpoint.hpp"
+
+CheckpointWriter::CheckpointWriter()
+	: m_mutex()
+	, m_writeSubmitted()
+	, m_writeFinished()
+	, m_pendingWrites()
+	, m_isWriting(false)
+	, m_isStopping(false)
+	, m_thread() {
+}
+
+CheckpointWriter::~CheckpointWriter() {
+	if (!m_thread.joinable()) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isStopping = true;
+	}
+	m_writeSubmitted.notify_one();
+
+	m_thread.join();
+}
+
+void CheckpointWriter::submit(std::vector<char>&& data, const std::string& path) {
+	push({path, std::move(data), false});
+}
+
+void CheckpointWriter::append(std::vector<char>&& data, const std::string& path) {
+	push({path, std::move(data), true});
+}
+
+void CheckpointWriter::push(Write&& write) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pendingWrites.push_back(std::move(write));
+
+		if (!m_thread.joinable()) {
+			m_thread = std::thread(&CheckpointWriter::run, this);
+		}
+	}
+	m_writeSubmitted.notify_one();
+}
+
+void CheckpointWriter::flush() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_writeFinished.wait(lock, [this]() {
+		return m_pendingWrites.empty() && !m_isWriting;
+	});
+}
+
+void CheckpointWriter::run() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true) {
+		m_writeSubmitted.wait(lock, [this]() {
+			return !m_pendingWrites.empty() || m_isStopping;
+		});
+
+		// what is pending is still written when stopping
+		if (m_pendingWrites.empty()) {
+			return;
+		}
+
+		Write write = std::move(m_pendingWrites.front());
+		m_pendingWrites.pop_front();
+		m_isWriting = true;
+
+		lock.unlock();
+		if (write.isAppend) {
+			Checkpoint::appendFile(write.data, write.path);
+		} else {
+			Checkpoint::writeFile(write.data, write.path);
+		}
+		lock.lock();
+
+		m_isWriting = false;
+		m_writeFinished.notify_all();
+	}
+}
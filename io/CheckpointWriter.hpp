@@ -0,0 +1,55 @@
+#ifndef NEAT_IO_CHECKPOINTWRITER_HPP_
+#define NEAT_IO_CHECKPOINTWRITER_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Writes files on a thread of its own, so training does not wait for the disk.
+ *
+ * The data is taken over by submit() and append() and written in the order it was
+ * submitted.
+ * The thread is started with the first write, and the destructor waits until all
+ * submitted writes are done.
+ */
+class CheckpointWriter {
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_writeSubmitted;
+	std::condition_variable m_writeFinished;
+	struct Write {
+		std::string path;
+		std::vector<char> data;
+		bool isAppend;
+	};
+
+	std::deque<Write> m_pendingWrites;
+	bool m_isWriting;
+	bool m_isStopping;
+
+	std::thread m_thread;
+
+private:
+	void run();
+	void push(Write&& write);
+
+public:
+	CheckpointWriter();
+	~CheckpointWriter();
+
+	CheckpointWriter(const CheckpointWriter&) = delete;
+	CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+	// replaces the file
+	void submit(std::vector<char>&& data, const std::string& path);
+	void append(std::vector<char>&& data, const std::string& path);
+
+	// waits until everything submitted so far is written
+	void flush();
+};
+
+#endif /* NEAT_IO_CHECKPOINTWRITER_HPP_ */
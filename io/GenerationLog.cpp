@@ -0,0 +1,270 @@
+#include "GenerationLog.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+
+#include "../Population.hpp"
+
+#include <iostream>
+
+const char GenerationLog::blockMagic[8] = {'N', 'E', 'A', 'T', 'L', 'O', 'G', 'B'};
+const char GenerationLog::trailerMagic[8] = {'N', 'E', 'A', 'T', 'L', 'O', 'G', 'I'};
+
+GenerationLog::GenerationLog()
+	: m_path()
+	, m_generationsPerBlock(defaultGenerationsPerBlock)
+	, m_columns()
+	, m_firstGeneration(0)
+	, m_numGenerations(0)
+	, m_index()
+	, m_fileSize(0)
+	, m_writer() {
+}
+
+GenerationLog::~GenerationLog() {
+	close();
+}
+
+void GenerationLog::pushInt(const Column column, const int64_t value) {
+	uint64_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	pushUInt(column, bits);
+}
+
+void GenerationLog::pushDouble(const Column column, const double value) {
+	uint64_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	pushUInt(column, bits);
+}
+
+bool GenerationLog::open(const std::string& path, const uint64_t generationsPerBlock) {
+	close();
+
+	m_generationsPerBlock = std::max<uint64_t>(1, generationsPerBlock);
+	m_index.clear();
+	m_fileSize = 0;
+
+	std::error_code error;
+	if (std::filesystem::exists(path, error)) {
+		std::ifstream file(path, std::ios::binary);
+		file.seekg(0, std::ios::end);
+		const uint64_t fileSize = file.tellg();
+
+		/*
+		 * A closed log ends with its index, which is dropped so the new blocks can
+		 * follow the old ones. Without one, the blocks are walked to the last complete
+		 * one.
+		 */
+		Trailer trailer = {};
+		bool hasIndex = false;
+		if (fileSize >= sizeof(Trailer)) {
+			file.seekg(fileSize - sizeof(Trailer));
+			file.read(reinterpret_cast<char*>(&trailer), sizeof(Trailer));
+			hasIndex = file && std::memcmp(trailer.magic, trailerMagic, sizeof(trailerMagic)) == 0 && trailer.version == version
+				&& trailer.indexOffset <= fileSize - sizeof(Trailer)
+				&& trailer.numBlocks == (fileSize - sizeof(Trailer) - trailer.indexOffset) / sizeof(IndexEntry);
+		}
+
+		if (hasIndex) {
+			m_index.resize(trailer.numBlocks);
+			file.seekg(trailer.indexOffset);
+			file.read(reinterpret_cast<char*>(m_index.data()), m_index.size() * sizeof(IndexEntry));
+			m_fileSize = trailer.indexOffset;
+		} else {
+			file.clear();
+			while (m_fileSize + sizeof(BlockHeader) <= fileSize) {
+				BlockHeader header;
+				file.seekg(m_fileSize);
+				file.read(reinterpret_cast<char*>(&header), sizeof(BlockHeader));
+				if (!file || std::memcmp(header.magic, blockMagic, sizeof(blockMagic)) != 0 || header.size < sizeof(BlockHeader) || header.size > fileSize - m_fileSize) {
+					break;
+				}
+
+				m_index.push_back({m_fileSize, header.size, header.firstGeneration, header.numGenerations});
+				m_fileSize += header.size;
+			}
+		}
+		file.close();
+
+		if (m_fileSize < fileSize) {
+			std::filesystem::resize_file(path, m_fileSize, error);
+			if (error) {
+				std::cerr << "Could not append to generation log " << path << ": " << error.message() << std::endl;
+				return false;
+			}
+		}
+	} else {
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			std::cerr << "Could not create generation log " << path << std::endl;
+			return false;
+		}
+	}
+
+	m_path = path;
+	m_numGenerations = 0;
+	for (auto& column : m_columns) {
+		column.clear();
+	}
+
+	return true;
+}
+
+void GenerationLog::close() {
+	if (!isOpen()) {
+		return;
+	}
+
+	flushBlock();
+
+	std::vector<char> footer(m_index.size() * sizeof(IndexEntry) + sizeof(Trailer));
+	if (!m_index.empty()) {
+		std::memcpy(footer.data(), m_index.data(), m_index.size() * sizeof(IndexEntry));
+	}
+
+	Trailer trailer = {};
+	trailer.indexOffset = m_fileSize;
+	trailer.numBlocks = m_index.size();
+	trailer.version = version;
+	std::memcpy(trailer.magic, trailerMagic, sizeof(trailerMagic));
+	std::memcpy(footer.data() + m_index.size() * sizeof(IndexEntry), &trailer, sizeof(Trailer));
+
+	m_writer.append(std::move(footer), m_path);
+	m_writer.flush();
+
+	m_path.clear();
+}
+
+void GenerationLog::flushBlock() {
+	if (m_numGenerations == 0) {
+		return;
+	}
+
+	constexpr size_t numColumns = static_cast<size_t>(Column::numColumns);
+
+	BlockHeader header = {};
+	std::memcpy(header.magic, blockMagic, sizeof(blockMagic));
+	header.version = version;
+	header.numColumns = numColumns;
+	header.firstGeneration = m_firstGeneration;
+	header.numGenerations = m_numGenerations;
+
+	std::vector<ColumnEntry> entries(numColumns);
+	uint64_t offset = sizeof(BlockHeader) + numColumns * sizeof(ColumnEntry);
+	for (size_t column(0); column < numColumns; ++column) {
+		entries[column].column = column;
+		entries[column].offset = offset;
+		entries[column].count = m_columns[column].size();
+		offset += m_columns[column].size() * sizeof(uint64_t);
+	}
+	header.size = offset;
+
+	std::vector<char> block(header.size);
+	std::memcpy(block.data(), &header, sizeof(BlockHeader));
+	std::memcpy(block.data() + sizeof(BlockHeader), entries.data(), numColumns * sizeof(ColumnEntry));
+	for (size_t column(0); column < numColumns; ++column) {
+		if (!m_columns[column].empty()) {
+			std::memcpy(block.data() + entries[column].offset, m_columns[column].data(), m_columns[column].size() * sizeof(uint64_t));
+		}
+		m_columns[column].clear();
+	}
+
+	m_index.push_back({m_fileSize, header.size, m_firstGeneration, m_numGenerations});
+	m_fileSize += header.size;
+	m_numGenerations = 0;
+
+	m_writer.append(std::move(block), m_path);
+}
+
+void GenerationLog::recordScoring(const Population& population, const double scoringSeconds) {
+	if (!isOpen()) {
+		return;
+	}
+
+	// the offsets columns start every block with 0
+	if (m_numGenerations == 0) {
+		m_firstGeneration = population.getGenerationId();
+		pushUInt(Column::SpeciesOffsets, 0);
+		pushUInt(Column::ChampionSynapseOffsets, 0);
+		pushUInt(Column::ChampionNeuronOffsets, 0);
+	}
+
+	const GenePool& genePool = population.getGenePool();
+
+	std::vector<double> scores = genePool.getGenotypeScores();
+	double meanScore = 0;
+	double quantiles[5] = {};
+	if (!scores.empty()) {
+		meanScore = std::accumulate(scores.begin(), scores.end(), 0.0) / scores.size();
+
+		std::sort(scores.begin(), scores.end());
+		for (size_t i(0); i < 5; ++i) {
+			quantiles[i] = scores[i * (scores.size() - 1) / 4];
+		}
+	}
+
+	pushUInt(Column::GenerationId, population.getGenerationId());
+	pushDouble(Column::TopScore, population.m_topGenerationFitness);
+	pushDouble(Column::FitnessRecord, genePool.getGenotypeFitnessRecord());
+	pushDouble(Column::MeanScore, meanScore);
+	pushDouble(Column::MinScore, quantiles[0]);
+	pushDouble(Column::LowerQuartileScore, quantiles[1]);
+	pushDouble(Column::MedianScore, quantiles[2]);
+	pushDouble(Column::UpperQuartileScore, quantiles[3]);
+	pushDouble(Column::MaxScore, quantiles[4]);
+	pushDouble(Column::ScoringSeconds, scoringSeconds);
+	pushDouble(Column::ScoringUtilisation, population.getScoringStats().getUtilisation());
+	pushDouble(Column::CostCorrelation, population.getCostRecord().getCorrelation());
+
+	// the genes in order of innovation, which is the order the genotype keeps them in
+	const Genotype* champion = population.getBestGenotypeInGeneration();
+	if (champion != nullptr) {
+		const auto& synapseGenes = champion->getSynapseGenes();
+		for (const innov_t innovation : champion->getInnovations()) {
+			const SynapseGene& synapseGene = synapseGenes.find(innovation)->second;
+
+			pushUInt(Column::ChampionInnovation, innovation);
+			pushInt(Column::ChampionInputId, synapseGene.getInputOutputIds().first);
+			pushInt(Column::ChampionOutputId, synapseGene.getInputOutputIds().second);
+			pushDouble(Column::ChampionWeight, synapseGene.getWeight());
+			pushUInt(Column::ChampionEnabled, synapseGene.isEnabled());
+		}
+
+		std::vector<std::pair<id_t, double>> neuronGenes(champion->getNeuronGenes().begin(), champion->getNeuronGenes().end());
+		std::sort(neuronGenes.begin(), neuronGenes.end());
+		for (const auto& neuronGene : neuronGenes) {
+			pushInt(Column::ChampionNeuronId, neuronGene.first);
+			pushDouble(Column::ChampionBias, neuronGene.second);
+		}
+	}
+	pushUInt(Column::ChampionSynapseOffsets, getColumn(Column::ChampionInnovation).size());
+	pushUInt(Column::ChampionNeuronOffsets, getColumn(Column::ChampionNeuronId).size());
+}
+
+void GenerationLog::recordSelection(const Population& population, const double selectionSeconds) {
+	if (!isOpen()) {
+		return;
+	}
+
+	const GenePool& genePool = population.getGenePool();
+
+	pushDouble(Column::SelectionSeconds, selectionSeconds);
+	pushUInt(Column::NumSpecies, genePool.m_species.size());
+
+	for (const auto& species : genePool.m_species) {
+		pushInt(Column::SpeciesId, species.id);
+		pushDouble(Column::SpeciesAdjustedFitness, species.adjustedFitness);
+		pushDouble(Column::SpeciesFitnessRecord, species.speciesGenotypeFitnessRecord);
+		pushUInt(Column::SpeciesStagnation, species.generationsWithoutImprovement);
+		pushUInt(Column::SpeciesOffspring, species.numberOfNextGeneration);
+	}
+	pushUInt(Column::SpeciesOffsets, getColumn(Column::SpeciesId).size());
+
+	++m_numGenerations;
+	if (m_numGenerations >= m_generationsPerBlock) {
+		flushBlock();
+	}
+}
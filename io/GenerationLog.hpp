@@ -0,0 +1,162 @@
+#ifndef NEAT_IO_GENERATIONLOG_HPP_
+#define NEAT_IO_GENERATIONLOG_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "CheckpointWriter.hpp"
+
+class Population;
+
+/*
+ * An append-only binary log of every generation, for analysis after the run.
+ *
+ * Every generation adds a row of numbers to the columns of the current block: the
+ * scores and their distribution, the timing of scoring and selection, a row per
+ * species, and the genes of the best genotype. Recording only copies numbers into
+ * vectors; nothing is formatted. Every generationsPerBlock generations the block
+ * is handed to a background writer and appended to the file.
+ *
+ * A block is a header, a table of its columns and the columns themselves, each an
+ * array of 8 byte values. Columns of per-species and per-gene values come with an
+ * offsets column of one entry per generation and one more, which delimit the rows
+ * of every generation. Closing the log appends an index of the blocks and a trailer
+ * that points to it. Opening an existing log drops its index and appends after the
+ * last complete block, so a log cut short by a crash loses at most the block that
+ * was being written.
+ *
+ * GenerationLogReader reads the log a block at a time.
+ */
+class GenerationLog {
+public:
+	static constexpr uint32_t version = 1;
+	static constexpr uint64_t defaultGenerationsPerBlock = 64;
+
+	enum class Column : uint32_t {
+		// one value per generation
+		GenerationId,            // uint64
+		TopScore,                // double, the best score of the generation
+		FitnessRecord,           // double, the best score of any generation so far
+		MeanScore,               // double
+		MinScore,                // double
+		LowerQuartileScore,      // double
+		MedianScore,             // double
+		UpperQuartileScore,      // double
+		MaxScore,                // double
+		NumSpecies,              // uint64
+		ScoringSeconds,          // double
+		SelectionSeconds,        // double
+		ScoringUtilisation,      // double, of the worker threads
+		CostCorrelation,         // double, of predicted and actual scoring cost
+
+		// one row per generation, delimited by SpeciesOffsets
+		SpeciesOffsets,          // uint64
+		SpeciesId,               // int64
+		SpeciesAdjustedFitness,  // double
+		SpeciesFitnessRecord,    // double
+		SpeciesStagnation,       // uint64, generations without improvement
+		SpeciesOffspring,        // uint64, genotypes in the next generation
+
+		// the best genotype of every generation, delimited by the offsets
+		ChampionSynapseOffsets,  // uint64
+		ChampionInnovation,      // uint64
+		ChampionInputId,         // int64
+		ChampionOutputId,        // int64
+		ChampionWeight,          // double
+		ChampionEnabled,         // uint64
+		ChampionNeuronOffsets,   // uint64
+		ChampionNeuronId,        // int64
+		ChampionBias,            // double
+
+		numColumns
+	};
+
+	struct BlockHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t numColumns;
+		uint64_t size; // of the whole block
+		uint64_t firstGeneration;
+		uint64_t numGenerations;
+	};
+
+	// follows the block header, once for every column
+	struct ColumnEntry {
+		uint32_t column;
+		uint32_t padding;
+		uint64_t offset; // from the start of the block
+		uint64_t count;
+	};
+
+	struct IndexEntry {
+		uint64_t offset;
+		uint64_t size;
+		uint64_t firstGeneration;
+		uint64_t numGenerations;
+	};
+
+	// the last bytes of a closed log
+	struct Trailer {
+		uint64_t indexOffset;
+		uint64_t numBlocks;
+		uint32_t version;
+		uint32_t padding;
+		char magic[8];
+	};
+
+	static const char blockMagic[8];
+	static const char trailerMagic[8];
+
+private:
+	std::string m_path;
+	uint64_t m_generationsPerBlock;
+
+	std::vector<uint64_t> m_columns[static_cast<size_t>(Column::numColumns)];
+	uint64_t m_firstGeneration;
+	uint64_t m_numGenerations;
+
+	std::vector<IndexEntry> m_index;
+	uint64_t m_fileSize;
+
+	CheckpointWriter m_writer;
+
+private:
+	std::vector<uint64_t>& getColumn(const Column column) {
+		return m_columns[static_cast<size_t>(column)];
+	}
+
+	void pushUInt(const Column column, const uint64_t value) {
+		getColumn(column).push_back(value);
+	}
+
+	void pushInt(const Column column, const int64_t value);
+	void pushDouble(const Column column, const double value);
+
+	void flushBlock();
+
+public:
+	GenerationLog();
+	~GenerationLog();
+
+	GenerationLog(const GenerationLog&) = delete;
+	GenerationLog& operator=(const GenerationLog&) = delete;
+
+	// appends to the log at the path, or starts one
+	bool open(const std::string& path, const uint64_t generationsPerBlock = defaultGenerationsPerBlock);
+
+	// writes what is left of the current block and the index
+	void close();
+
+	bool isOpen() const {
+		return !m_path.empty();
+	}
+
+	// after scoring, before the selection replaces the genotypes
+	void recordScoring(const Population& population, const double scoringSeconds);
+
+	// after the selection, completes the generation
+	void recordSelection(const Population& population, const double selectionSeconds);
+};
+
+#endif /* NEAT_IO_GENERATIONLOG_HPP_ */
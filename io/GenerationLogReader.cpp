@@ -0,0 +1,159 @@
+#include "GenerationLogReader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <iostream>
+
+GenerationLogReader::GenerationLogReader()
+	: m_file()
+	, m_blocks()
+	, m_block()
+	, m_columns(static_cast<size_t>(Column::numColumns))
+	, m_firstGeneration(0)
+	, m_numGenerations(0) {
+}
+
+bool GenerationLogReader::open(const std::string& path) {
+	close();
+
+	m_file.open(path, std::ios::binary);
+	if (!m_file) {
+		std::cerr << "Could not open generation log " << path << std::endl;
+		return false;
+	}
+
+	m_file.seekg(0, std::ios::end);
+	const uint64_t fileSize = m_file.tellg();
+
+	GenerationLog::Trailer trailer = {};
+	if (fileSize >= sizeof(GenerationLog::Trailer)) {
+		m_file.seekg(fileSize - sizeof(GenerationLog::Trailer));
+		m_file.read(reinterpret_cast<char*>(&trailer), sizeof(GenerationLog::Trailer));
+	}
+
+	if (m_file && std::memcmp(trailer.magic, GenerationLog::trailerMagic, sizeof(trailer.magic)) == 0 && trailer.version == GenerationLog::version
+		&& trailer.indexOffset <= fileSize - sizeof(GenerationLog::Trailer)
+		&& trailer.numBlocks == (fileSize - sizeof(GenerationLog::Trailer) - trailer.indexOffset) / sizeof(BlockInfo)) {
+		m_blocks.resize(trailer.numBlocks);
+		m_file.seekg(trailer.indexOffset);
+		m_file.read(reinterpret_cast<char*>(m_blocks.data()), m_blocks.size() * sizeof(BlockInfo));
+		return static_cast<bool>(m_file);
+	}
+
+	// not closed, the blocks up to the first incomplete one are read
+	m_file.clear();
+	uint64_t offset = 0;
+	while (offset + sizeof(GenerationLog::BlockHeader) <= fileSize) {
+		GenerationLog::BlockHeader header;
+		m_file.seekg(offset);
+		m_file.read(reinterpret_cast<char*>(&header), sizeof(GenerationLog::BlockHeader));
+		if (!m_file || std::memcmp(header.magic, GenerationLog::blockMagic, sizeof(header.magic)) != 0 || header.size < sizeof(GenerationLog::BlockHeader) || header.size > fileSize - offset) {
+			break;
+		}
+
+		m_blocks.push_back({offset, header.size, header.firstGeneration, header.numGenerations});
+		offset += header.size;
+	}
+	m_file.clear();
+
+	return true;
+}
+
+void GenerationLogReader::close() {
+	if (m_file.is_open()) {
+		m_file.close();
+	}
+	m_file.clear();
+
+	m_blocks.clear();
+	m_block.clear();
+	std::fill(m_columns.begin(), m_columns.end(), GenerationLog::ColumnEntry());
+	m_firstGeneration = 0;
+	m_numGenerations = 0;
+}
+
+size_t GenerationLogReader::findBlock(const uint64_t generationId) const {
+	// the blocks are in order of generation
+	const auto it = std::upper_bound(m_blocks.begin(), m_blocks.end(), generationId, [](const uint64_t generationId, const BlockInfo& block) {
+		return generationId < block.firstGeneration;
+	});
+
+	if (it == m_blocks.begin() || generationId >= std::prev(it)->firstGeneration + std::prev(it)->numGenerations) {
+		return m_blocks.size();
+	}
+
+	return std::prev(it) - m_blocks.begin();
+}
+
+bool GenerationLogReader::readBlock(const size_t blockIndex) {
+	std::fill(m_columns.begin(), m_columns.end(), GenerationLog::ColumnEntry());
+	m_firstGeneration = 0;
+	m_numGenerations = 0;
+
+	if (blockIndex >= m_blocks.size()) {
+		return false;
+	}
+
+	const BlockInfo& blockInfo = m_blocks[blockIndex];
+	m_block.resize(blockInfo.size);
+	m_file.seekg(blockInfo.offset);
+	m_file.read(m_block.data(), m_block.size());
+	if (!m_file || m_block.size() < sizeof(GenerationLog::BlockHeader)) {
+		m_file.clear();
+		std::cerr << "Could not read block " << blockIndex << " of the generation log" << std::endl;
+		return false;
+	}
+
+	GenerationLog::BlockHeader header;
+	std::memcpy(&header, m_block.data(), sizeof(GenerationLog::BlockHeader));
+	if (std::memcmp(header.magic, GenerationLog::blockMagic, sizeof(header.magic)) != 0 || header.version != GenerationLog::version
+		|| sizeof(GenerationLog::BlockHeader) + header.numColumns * sizeof(GenerationLog::ColumnEntry) > m_block.size()) {
+		std::cerr << "Block " << blockIndex << " of the generation log is invalid" << std::endl;
+		return false;
+	}
+
+	// columns this version does not know are skipped
+	for (uint32_t i(0); i < header.numColumns; ++i) {
+		GenerationLog::ColumnEntry entry;
+		std::memcpy(&entry, m_block.data() + sizeof(GenerationLog::BlockHeader) + i * sizeof(GenerationLog::ColumnEntry), sizeof(GenerationLog::ColumnEntry));
+		if (entry.offset > m_block.size() || entry.count > (m_block.size() - entry.offset) / sizeof(uint64_t)) {
+			std::cerr << "Block " << blockIndex << " of the generation log is invalid" << std::endl;
+			std::fill(m_columns.begin(), m_columns.end(), GenerationLog::ColumnEntry());
+			return false;
+		}
+
+		if (entry.column < m_columns.size()) {
+			m_columns[entry.column] = entry;
+		}
+	}
+
+	m_firstGeneration = header.firstGeneration;
+	m_numGenerations = header.numGenerations;
+
+	return true;
+}
+
+uint64_t GenerationLogReader::getBits(const Column column, const size_t row) const {
+	const GenerationLog::ColumnEntry& entry = m_columns[static_cast<size_t>(column)];
+
+	uint64_t bits;
+	std::memcpy(&bits, m_block.data() + entry.offset + row * sizeof(uint64_t), sizeof(bits));
+	return bits;
+}
+
+int64_t GenerationLogReader::getInt(const Column column, const size_t row) const {
+	const uint64_t bits = getBits(column, row);
+
+	int64_t value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+double GenerationLogReader::getDouble(const Column column, const size_t row) const {
+	const uint64_t bits = getBits(column, row);
+
+	double value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
@@ -0,0 +1,86 @@
+#ifndef NEAT_IO_GENERATIONLOGREADER_HPP_
+#define NEAT_IO_GENERATIONLOGREADER_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "GenerationLog.hpp"
+
+/*
+ * Reads a GenerationLog one block at a time, so a log of any length is read in the
+ * memory of a single block. The blocks are found through the index at the end of a
+ * closed log, or by walking the block headers of a log that was not closed.
+ *
+ * The values of the current block are read by column and row. The rows of the
+ * per-species and per-gene columns of a generation are given by getRows with the
+ * offsets column that delimits them.
+ */
+class GenerationLogReader {
+public:
+	using Column = GenerationLog::Column;
+	using BlockInfo = GenerationLog::IndexEntry;
+
+private:
+	std::ifstream m_file;
+	std::vector<BlockInfo> m_blocks;
+
+	std::vector<char> m_block;
+	std::vector<GenerationLog::ColumnEntry> m_columns; // by column, with a count of 0 for columns the block does not have
+	uint64_t m_firstGeneration;
+	uint64_t m_numGenerations;
+
+private:
+	uint64_t getBits(const Column column, const size_t row) const;
+
+public:
+	GenerationLogReader();
+
+	GenerationLogReader(const GenerationLogReader&) = delete;
+	GenerationLogReader& operator=(const GenerationLogReader&) = delete;
+
+	bool open(const std::string& path);
+	void close();
+
+	size_t getNumBlocks() const {
+		return m_blocks.size();
+	}
+
+	const BlockInfo& getBlockInfo(const size_t blockIndex) const {
+		return m_blocks[blockIndex];
+	}
+
+	// the block that holds the generation, or getNumBlocks() if none does
+	size_t findBlock(const uint64_t generationId) const;
+
+	// makes the block the current one, false if it can not be read
+	bool readBlock(const size_t blockIndex);
+
+	uint64_t getFirstGeneration() const {
+		return m_firstGeneration;
+	}
+
+	uint64_t getNumGenerations() const {
+		return m_numGenerations;
+	}
+
+	size_t getCount(const Column column) const {
+		return m_columns[static_cast<size_t>(column)].count;
+	}
+
+	uint64_t getUInt(const Column column, const size_t row) const {
+		return getBits(column, row);
+	}
+
+	int64_t getInt(const Column column, const size_t row) const;
+	double getDouble(const Column column, const size_t row) const;
+
+	// the first and one past the last row of the generation of the block in the columns delimited by the offsets column
+	std::pair<size_t, size_t> getRows(const Column offsetsColumn, const size_t generationIndex) const {
+		return {getUInt(offsetsColumn, generationIndex), getUInt(offsetsColumn, generationIndex + 1)};
+	}
+};
+
+#endif /* NEAT_IO_GENERATIONLOGREADER_HPP_ */
@@ -0,0 +1,332 @@
+#include "HallOfFame.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+
+#include "MappedFile.hpp"
+#include "NetworkExport.hpp"
+#include "../Phenotype.hpp"
+#include "../Population.hpp"
+#include "../util/Hash.hpp"
+
+#include <iostream>
+
+const char HallOfFame::indexMagic[8] = {'N', 'E', 'A', 'T', 'H', 'O', 'F', 'I'};
+const char HallOfFame::trailerMagic[8] = {'N', 'E', 'A', 'T', 'H', 'O', 'F', 'T'};
+
+namespace {
+	uint64_t align(const uint64_t offset) {
+		return (offset + 7) & ~uint64_t(7);
+	}
+
+	template <typename T>
+	void copyArray(std::vector<char>& data, const size_t recordOffset, const uint64_t arrayOffset, const T* values, const size_t count) {
+		if (count > 0) {
+			std::memcpy(data.data() + recordOffset + arrayOffset, values, count * sizeof(T));
+		}
+	}
+
+	template <typename T>
+	void appendArray(std::vector<char>& data, const T* values, const size_t count) {
+		const size_t offset = data.size();
+		data.resize(offset + count * sizeof(T));
+		copyArray(data, offset, 0, values, count);
+	}
+}
+
+HallOfFame::HallOfFame()
+	: m_path()
+	, m_recordsPerGeneration(defaultRecordsPerGeneration)
+	, m_entries()
+	, m_firstGeneration(0)
+	, m_numGenerations(0)
+	, m_dataSize(0)
+	, m_writer() {
+}
+
+HallOfFame::~HallOfFame() {
+	close();
+}
+
+HallOfFame::Layout HallOfFame::getLayout(const RecordHeader& header) {
+	Layout layout;
+	layout.synapseGenes = sizeof(RecordHeader);
+	layout.neuronGenes = layout.synapseGenes + header.numSynapseGenes * sizeof(SynapseGeneRecord);
+	layout.network = layout.neuronGenes + header.numNeuronGenes * sizeof(NeuronGeneRecord);
+	layout.size = align(layout.network + header.networkSize);
+	return layout;
+}
+
+size_t HallOfFame::getBucket(const uint64_t structuralHash, const uint64_t hashTableSize) {
+	return mix64(structuralHash) & (hashTableSize - 1);
+}
+
+void HallOfFame::writeRecord(std::vector<char>& data, const Genotype& genotype, const Entry& entry) {
+	const std::vector<char> network = NetworkExport::write(Phenotype(genotype));
+
+	RecordHeader header = {};
+	header.generationId = entry.generationId;
+	header.fitness = entry.fitness;
+	header.structuralHash = entry.structuralHash;
+	header.contentHash = entry.contentHash;
+	header.rank = entry.rank;
+	header.numSynapseGenes = genotype.getInnovations().size();
+	header.numNeuronGenes = genotype.getNeuronGenes().size();
+	header.networkSize = network.size();
+
+	const Layout layout = getLayout(header);
+	header.size = layout.size;
+
+	const size_t recordOffset = data.size();
+	data.resize(recordOffset + layout.size, 0);
+	std::memcpy(data.data() + recordOffset, &header, sizeof(RecordHeader));
+
+	std::vector<SynapseGeneRecord> synapseGenes;
+	synapseGenes.reserve(header.numSynapseGenes);
+	for (const innov_t innovation : genotype.getInnovations()) {
+		const SynapseGene& synapseGene = genotype.getSynapseGenes().find(innovation)->second;
+		synapseGenes.push_back({innovation, synapseGene.isEnabled(), synapseGene.getInputOutputIds().first, synapseGene.getInputOutputIds().second, synapseGene.getWeight()});
+	}
+
+	std::vector<NeuronGeneRecord> neuronGenes;
+	neuronGenes.reserve(header.numNeuronGenes);
+	for (const auto& neuronGene : genotype.getNeuronGenes()) {
+		neuronGenes.push_back({neuronGene.first, 0, neuronGene.second});
+	}
+	std::sort(neuronGenes.begin(), neuronGenes.end(), [](const NeuronGeneRecord& a, const NeuronGeneRecord& b) {
+		return a.id < b.id;
+	});
+
+	copyArray(data, recordOffset, layout.synapseGenes, synapseGenes.data(), synapseGenes.size());
+	copyArray(data, recordOffset, layout.neuronGenes, neuronGenes.data(), neuronGenes.size());
+	copyArray(data, recordOffset, layout.network, network.data(), network.size());
+}
+
+HallOfFame::Lookup HallOfFame::buildLookup(const Entry* entries, const size_t numEntries) {
+	Lookup lookup;
+
+	// equal fitness keeps the older entry first
+	lookup.byFitness.resize(numEntries);
+	std::iota(lookup.byFitness.begin(), lookup.byFitness.end(), 0);
+	std::stable_sort(lookup.byFitness.begin(), lookup.byFitness.end(), [entries](const uint32_t a, const uint32_t b) {
+		return entries[a].fitness > entries[b].fitness;
+	});
+
+	lookup.structureEntries.resize(numEntries);
+	std::iota(lookup.structureEntries.begin(), lookup.structureEntries.end(), 0);
+	std::stable_sort(lookup.structureEntries.begin(), lookup.structureEntries.end(), [entries](const uint32_t a, const uint32_t b) {
+		return entries[a].structuralHash < entries[b].structuralHash;
+	});
+
+	size_t numStructures = 0;
+	for (size_t i(0); i < numEntries; ++i) {
+		numStructures += i == 0 || entries[lookup.structureEntries[i]].structuralHash != entries[lookup.structureEntries[i - 1]].structuralHash;
+	}
+
+	// at most half full, so a probe ends after a bucket or two however many copies a structure has
+	uint64_t hashTableSize = 1;
+	while (hashTableSize < 2 * numStructures) {
+		hashTableSize *= 2;
+	}
+
+	lookup.hashTable.assign(hashTableSize, StructureBucket());
+	for (size_t first(0), last(0); first < numEntries; first = last) {
+		const uint64_t structuralHash = entries[lookup.structureEntries[first]].structuralHash;
+		while (last < numEntries && entries[lookup.structureEntries[last]].structuralHash == structuralHash) {
+			++last;
+		}
+
+		size_t bucket = getBucket(structuralHash, hashTableSize);
+		while (lookup.hashTable[bucket].numEntries != 0) {
+			bucket = (bucket + 1) & (hashTableSize - 1);
+		}
+		lookup.hashTable[bucket] = {structuralHash, static_cast<uint32_t>(first), static_cast<uint32_t>(last - first)};
+	}
+
+	return lookup;
+}
+
+std::vector<char> HallOfFame::writeLookup() const {
+	const Lookup lookup = buildLookup(m_entries.data(), m_entries.size());
+
+	Trailer trailer = {};
+	trailer.numEntries = m_entries.size();
+	trailer.hashTableSize = lookup.hashTable.size();
+	trailer.version = version;
+	std::memcpy(trailer.magic, trailerMagic, sizeof(trailerMagic));
+
+	std::vector<char> data;
+	appendArray(data, lookup.byFitness.data(), lookup.byFitness.size());
+	appendArray(data, lookup.structureEntries.data(), lookup.structureEntries.size());
+	appendArray(data, lookup.hashTable.data(), lookup.hashTable.size());
+	appendArray(data, &trailer, 1);
+
+	return data;
+}
+
+bool HallOfFame::readIndex(const std::string& path) {
+	MappedFile indexFile;
+	MappedFile generationsFile;
+	if (!indexFile.open(getIndexPath(path)) || indexFile.getSize() < sizeof(IndexHeader)
+		|| !generationsFile.open(getGenerationsPath(path)) || generationsFile.getSize() < sizeof(GenerationEntry)) {
+		return false;
+	}
+
+	IndexHeader header;
+	std::memcpy(&header, indexFile.getData(), sizeof(IndexHeader));
+	if (std::memcmp(header.magic, indexMagic, sizeof(indexMagic)) != 0 || header.version != version) {
+		return false;
+	}
+
+	const uint64_t numGenerations = generationsFile.getSize() / sizeof(GenerationEntry);
+	GenerationEntry lastGeneration;
+	std::memcpy(&lastGeneration, generationsFile.getData() + (numGenerations - 1) * sizeof(GenerationEntry), sizeof(GenerationEntry));
+
+	const uint64_t numEntries = lastGeneration.firstEntry + lastGeneration.numEntries;
+	if (indexFile.getSize() < sizeof(IndexHeader) + numEntries * sizeof(Entry)) {
+		return false;
+	}
+
+	m_entries.resize(numEntries);
+	if (numEntries > 0) {
+		std::memcpy(m_entries.data(), indexFile.getData() + sizeof(IndexHeader), numEntries * sizeof(Entry));
+	}
+
+	m_firstGeneration = header.firstGeneration;
+	m_numGenerations = numGenerations;
+	m_dataSize = lastGeneration.dataEnd;
+
+	return true;
+}
+
+bool HallOfFame::open(const std::string& path, const uint32_t recordsPerGeneration) {
+	close();
+
+	m_recordsPerGeneration = std::max<uint32_t>(1, recordsPerGeneration);
+	m_entries.clear();
+	m_firstGeneration = 0;
+	m_numGenerations = 0;
+	m_dataSize = 0;
+
+	std::error_code error;
+	if (std::filesystem::exists(path, error) && readIndex(path)) {
+		// records and entries that were appended after the last listed generation are dropped, and so are the lookup tables
+		if (std::filesystem::file_size(path, error) < m_dataSize) {
+			std::cerr << "Hall of fame " << path << " is shorter than its index" << std::endl;
+			return false;
+		}
+		std::filesystem::resize_file(path, m_dataSize, error);
+		if (!error) {
+			std::filesystem::resize_file(getIndexPath(path), sizeof(IndexHeader) + m_entries.size() * sizeof(Entry), error);
+		}
+		if (!error) {
+			std::filesystem::resize_file(getGenerationsPath(path), m_numGenerations * sizeof(GenerationEntry), error);
+		}
+	} else {
+		m_entries.clear();
+		m_firstGeneration = 0;
+		m_numGenerations = 0;
+		m_dataSize = 0;
+
+		for (const std::string& filePath : {path, getIndexPath(path), getGenerationsPath(path)}) {
+			std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+			if (!file) {
+				std::cerr << "Could not create hall of fame " << filePath << std::endl;
+				return false;
+			}
+		}
+	}
+
+	if (error) {
+		std::cerr << "Could not open hall of fame " << path << ": " << error.message() << std::endl;
+		return false;
+	}
+
+	m_path = path;
+
+	return true;
+}
+
+void HallOfFame::close() {
+	if (!isOpen()) {
+		return;
+	}
+
+	// the lookup tables are built once for the whole archive, continuing it drops them again
+	if (m_numGenerations > 0) {
+		m_writer.append(writeLookup(), getIndexPath(m_path));
+	}
+
+	m_writer.flush();
+	m_path.clear();
+}
+
+void HallOfFame::record(const Population& population) {
+	if (!isOpen()) {
+		return;
+	}
+
+	const uint64_t generationId = population.getGenerationId();
+	if (m_numGenerations > 0 && generationId < m_firstGeneration + m_numGenerations) {
+		return;
+	}
+
+	std::vector<char> index;
+	if (m_numGenerations == 0) {
+		m_firstGeneration = generationId;
+
+		IndexHeader header = {};
+		std::memcpy(header.magic, indexMagic, sizeof(indexMagic));
+		header.version = version;
+		header.recordsPerGeneration = m_recordsPerGeneration;
+		header.firstGeneration = m_firstGeneration;
+		appendArray(index, &header, 1);
+	}
+
+	const GenePool& genePool = population.getGenePool();
+	const std::vector<double>& scores = genePool.getGenotypeScores();
+
+	std::vector<slot_t> slots(scores.size());
+	std::iota(slots.begin(), slots.end(), 0);
+	const size_t numRecords = std::min<size_t>(m_recordsPerGeneration, slots.size());
+	std::partial_sort(slots.begin(), slots.begin() + numRecords, slots.end(), [&scores](const slot_t a, const slot_t b) {
+		return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+	});
+
+	// generations that were skipped keep no entries
+	std::vector<GenerationEntry> generations(generationId - m_firstGeneration - m_numGenerations, {m_entries.size(), 0, m_dataSize});
+
+	const size_t firstEntry = m_entries.size();
+	std::vector<char> data;
+	for (uint32_t rank(0); rank < numRecords; ++rank) {
+		const slot_t slot = slots[rank];
+		const Genotype& genotype = genePool.getGenotypes()[slot];
+
+		Entry entry = {};
+		entry.offset = m_dataSize + data.size();
+		entry.generationId = generationId;
+		entry.fitness = scores[slot];
+		entry.structuralHash = genotype.getStructuralHash();
+		entry.contentHash = genotype.getContentHash();
+		entry.rank = rank;
+
+		writeRecord(data, genotype, entry);
+		m_entries.push_back(entry);
+	}
+
+	m_dataSize += data.size();
+	appendArray(index, m_entries.data() + firstEntry, numRecords);
+
+	generations.push_back({firstEntry, numRecords, m_dataSize});
+	m_numGenerations += generations.size();
+
+	// the generation is listed last, after its records and entries are written
+	m_writer.append(std::move(data), m_path);
+	m_writer.append(std::move(index), getIndexPath(m_path));
+	std::vector<char> generationData;
+	appendArray(generationData, generations.data(), generations.size());
+	m_writer.append(std::move(generationData), getGenerationsPath(m_path));
+}
@@ -0,0 +1,191 @@
+#ifndef NEAT_IO_HALLOFFAME_HPP_
+#define NEAT_IO_HALLOFFAME_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "CheckpointWriter.hpp"
+
+class Population;
+class Genotype;
+
+/*
+ * An archive of the best genotypes of every generation, so a champion can be taken
+ * out of any generation of a run long after it died out of the population.
+ *
+ * The records are appended to the file at the path, one record per genotype: a
+ * header, the genes, and the phenotype it compiles to as NetworkExport writes it. A
+ * reader maps the file and runs a record's network in place with
+ * runtime/Network.hpp, without compiling or copying it.
+ *
+ * Two more files list the records, and are only ever appended to as well. The index
+ * at getIndexPath(path) lists every record with its generation, rank, fitness and
+ * hashes, and the file at getGenerationsPath(path) lists the entries of every
+ * generation by generation id. A generation is appended to the generations last, so
+ * a generation that is listed there has its entries and records written, and a
+ * reader finds the records of a generation without a search. Archiving a generation
+ * costs the same however long the run. All three files are written on a background
+ * thread.
+ *
+ * Closing the archive appends two lookup tables and a trailer to the index: all
+ * entries in order of fitness, and a hash table of the structures that were
+ * archived, each with the list of its entries. So the n-th best record and the
+ * records of a structure are found without a search too. A reader of an archive
+ * that was not closed builds them itself.
+ *
+ * Opening an existing archive continues it, dropping the lookup tables and whatever
+ * was written after the last listed generation. Only generations after the latest
+ * archived one are added, so a run that resumes from an earlier checkpoint does not
+ * archive a generation twice.
+ *
+ * HallOfFameReader reads the archive.
+ */
+class HallOfFame {
+public:
+	static constexpr uint32_t version = 3;
+	static constexpr uint32_t defaultRecordsPerGeneration = 5;
+
+	// at the start of every record, the arrays follow it as given by Layout
+	struct RecordHeader {
+		uint64_t size; // of the whole record
+		uint64_t generationId;
+		double fitness;
+		uint64_t structuralHash;
+		uint64_t contentHash;
+		uint32_t rank; // within the generation, 0 is the best
+		uint32_t numSynapseGenes;
+		uint32_t numNeuronGenes;
+		uint32_t padding;
+		uint64_t networkSize;
+	};
+
+	// in order of innovation
+	struct SynapseGeneRecord {
+		uint32_t innovation;
+		uint32_t isEnabled;
+		int32_t inputId;
+		int32_t outputId;
+		double weight;
+	};
+
+	// in order of id
+	struct NeuronGeneRecord {
+		int32_t id;
+		uint32_t padding;
+		double bias;
+	};
+
+	// offsets of the arrays from the start of a record, each aligned to 8 bytes
+	struct Layout {
+		uint64_t synapseGenes; // SynapseGeneRecord[numSynapseGenes]
+		uint64_t neuronGenes;  // NeuronGeneRecord[numNeuronGenes]
+		uint64_t network;      // networkSize bytes, see NetworkExport
+		uint64_t size;
+	};
+
+	// at the start of the index, written with the first generation
+	struct IndexHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t recordsPerGeneration; // when the archive was started
+		uint64_t firstGeneration;
+	};
+
+	// follows the index header, one for every record
+	struct Entry {
+		uint64_t offset; // of the record
+		uint64_t generationId;
+		double fitness;
+		uint64_t structuralHash;
+		uint64_t contentHash;
+		uint32_t rank;
+		uint32_t padding;
+	};
+
+	// the entries of generation firstGeneration + i, generations that were not archived have none
+	struct GenerationEntry {
+		uint64_t firstEntry;
+		uint64_t numEntries;
+		uint64_t dataEnd; // the size of the records once the generation is written
+	};
+
+	// the entries of a structure, or an empty bucket if it has none, probed linearly from getBucket()
+	struct StructureBucket {
+		uint64_t structuralHash;
+		uint32_t firstEntry; // into Lookup::structureEntries
+		uint32_t numEntries;
+	};
+
+	struct Lookup {
+		std::vector<uint32_t> byFitness;        // entry indices, best first
+		std::vector<uint32_t> structureEntries; // entry indices by structure, in the order they were archived
+		std::vector<StructureBucket> hashTable; // a power of 2 of buckets, at most half of them used
+	};
+
+	// the last bytes of the index of a closed archive, after the entries, byFitness, structureEntries and hashTable
+	struct Trailer {
+		uint64_t numEntries;
+		uint64_t hashTableSize;
+		uint32_t version;
+		uint32_t padding;
+		char magic[8];
+	};
+
+	static const char indexMagic[8];
+	static const char trailerMagic[8];
+
+private:
+	std::string m_path;
+	uint32_t m_recordsPerGeneration;
+
+	std::vector<Entry> m_entries; // kept for the lookup tables
+	uint64_t m_firstGeneration;
+	uint64_t m_numGenerations;
+	uint64_t m_dataSize;
+
+	CheckpointWriter m_writer;
+
+private:
+	static void writeRecord(std::vector<char>& data, const Genotype& genotype, const Entry& entry);
+	std::vector<char> writeLookup() const;
+	bool readIndex(const std::string& path);
+
+public:
+	HallOfFame();
+	~HallOfFame();
+
+	HallOfFame(const HallOfFame&) = delete;
+	HallOfFame& operator=(const HallOfFame&) = delete;
+
+	static std::string getIndexPath(const std::string& path) {
+		return path + ".index";
+	}
+
+	static std::string getGenerationsPath(const std::string& path) {
+		return path + ".generations";
+	}
+
+	static Layout getLayout(const RecordHeader& header);
+
+	static size_t getBucket(const uint64_t structuralHash, const uint64_t hashTableSize);
+
+	// written on close, and built by readers of archives that were not closed
+	static Lookup buildLookup(const Entry* entries, const size_t numEntries);
+
+	// continues the archive at the path, or starts one
+	bool open(const std::string& path, const uint32_t recordsPerGeneration = defaultRecordsPerGeneration);
+
+	// writes the lookup tables and waits until everything archived so far is written
+	void close();
+
+	bool isOpen() const {
+		return !m_path.empty();
+	}
+
+	// archives the best scored genotypes of the generation, after scoring and before the selection replaces them
+	void record(const Population& population);
+};
+
+#endif /* NEAT_IO_HALLOFFAME_HPP_ */
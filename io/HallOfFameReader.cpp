@@ -0,0 +1,130 @@
+#include "HallOfFameReader.hpp"
+
+#include <cstring>
+#include <limits>
+
+#include <iostream>
+
+HallOfFameReader::HallOfFameReader()
+	: m_indexFile()
+	, m_generationsFile()
+	, m_dataFile()
+	, m_header()
+	, m_numEntries(0)
+	, m_numGenerations(0)
+	, m_dataSize(0)
+	, m_entries(nullptr)
+	, m_generations(nullptr)
+	, m_lookup()
+	, m_byFitness(nullptr)
+	, m_structureEntries(nullptr)
+	, m_hashTable(nullptr)
+	, m_hashTableSize(0) {
+}
+
+bool HallOfFameReader::open(const std::string& path) {
+	close();
+
+	if (!m_indexFile.open(HallOfFame::getIndexPath(path)) || !m_generationsFile.open(HallOfFame::getGenerationsPath(path)) || !m_dataFile.open(path)) {
+		std::cerr << "Could not open hall of fame " << path << std::endl;
+		close();
+		return false;
+	}
+
+	// the generations that are listed decide how much of the other files belongs to the archive
+	const uint64_t numGenerations = m_generationsFile.getSize() / sizeof(GenerationEntry);
+	HallOfFame::IndexHeader header = {};
+	GenerationEntry lastGeneration = {};
+	if (numGenerations > 0) {
+		std::memcpy(&lastGeneration, m_generationsFile.getData() + (numGenerations - 1) * sizeof(GenerationEntry), sizeof(GenerationEntry));
+		if (m_indexFile.getSize() >= sizeof(HallOfFame::IndexHeader)) {
+			std::memcpy(&header, m_indexFile.getData(), sizeof(HallOfFame::IndexHeader));
+		}
+	}
+
+	const uint64_t numEntries = lastGeneration.firstEntry + lastGeneration.numEntries;
+	const uint64_t entriesEnd = sizeof(HallOfFame::IndexHeader) + numEntries * sizeof(Entry);
+	if (numGenerations > 0 && (std::memcmp(header.magic, HallOfFame::indexMagic, sizeof(header.magic)) != 0 || header.version != HallOfFame::version
+		|| m_indexFile.getSize() < entriesEnd || m_dataFile.getSize() < lastGeneration.dataEnd || numEntries > std::numeric_limits<uint32_t>::max())) {
+		std::cerr << "Hall of fame " << path << " is invalid" << std::endl;
+		close();
+		return false;
+	}
+
+	m_header = header;
+	m_numEntries = numEntries;
+	m_numGenerations = numGenerations;
+	m_dataSize = lastGeneration.dataEnd;
+	if (numGenerations > 0) {
+		m_entries = reinterpret_cast<const Entry*>(m_indexFile.getData() + sizeof(HallOfFame::IndexHeader));
+		m_generations = reinterpret_cast<const GenerationEntry*>(m_generationsFile.getData());
+	}
+
+	// the index of a closed archive ends with the lookup tables of exactly the entries it lists
+	HallOfFame::Trailer trailer = {};
+	if (numGenerations > 0 && m_indexFile.getSize() >= entriesEnd + sizeof(HallOfFame::Trailer)) {
+		std::memcpy(&trailer, m_indexFile.getData() + m_indexFile.getSize() - sizeof(HallOfFame::Trailer), sizeof(HallOfFame::Trailer));
+	}
+
+	const uint64_t lookupSize = 2 * numEntries * sizeof(uint32_t) + trailer.hashTableSize * sizeof(HallOfFame::StructureBucket) + sizeof(HallOfFame::Trailer);
+	const bool hasLookup = std::memcmp(trailer.magic, HallOfFame::trailerMagic, sizeof(trailer.magic)) == 0 && trailer.version == HallOfFame::version
+		&& trailer.numEntries == numEntries && trailer.hashTableSize > 0 && (trailer.hashTableSize & (trailer.hashTableSize - 1)) == 0
+		&& trailer.hashTableSize <= m_indexFile.getSize() && m_indexFile.getSize() == entriesEnd + lookupSize;
+
+	if (hasLookup) {
+		const char* position = m_indexFile.getData() + entriesEnd;
+		m_byFitness = reinterpret_cast<const uint32_t*>(position);
+		position += numEntries * sizeof(uint32_t);
+		m_structureEntries = reinterpret_cast<const uint32_t*>(position);
+		position += numEntries * sizeof(uint32_t);
+		m_hashTable = reinterpret_cast<const HallOfFame::StructureBucket*>(position);
+		m_hashTableSize = trailer.hashTableSize;
+	} else {
+		m_lookup = HallOfFame::buildLookup(m_entries, numEntries);
+		m_byFitness = m_lookup.byFitness.data();
+		m_structureEntries = m_lookup.structureEntries.data();
+		m_hashTable = m_lookup.hashTable.data();
+		m_hashTableSize = m_lookup.hashTable.size();
+	}
+
+	return true;
+}
+
+void HallOfFameReader::close() {
+	m_indexFile.close();
+	m_generationsFile.close();
+	m_dataFile.close();
+
+	m_header = HallOfFame::IndexHeader();
+	m_numEntries = 0;
+	m_numGenerations = 0;
+	m_dataSize = 0;
+	m_entries = nullptr;
+	m_generations = nullptr;
+
+	m_lookup = HallOfFame::Lookup();
+	m_byFitness = nullptr;
+	m_structureEntries = nullptr;
+	m_hashTable = nullptr;
+	m_hashTableSize = 0;
+}
+
+bool HallOfFameReader::getRecord(const size_t entryIndex, Record& record) const {
+	const uint64_t offset = m_entries[entryIndex].offset;
+	if (offset > m_dataSize || m_dataSize - offset < sizeof(HallOfFame::RecordHeader) || offset % 8 != 0) {
+		return false;
+	}
+
+	const char* data = m_dataFile.getData() + offset;
+	const HallOfFame::RecordHeader* header = reinterpret_cast<const HallOfFame::RecordHeader*>(data);
+	const HallOfFame::Layout layout = HallOfFame::getLayout(*header);
+	if (header->size != layout.size || layout.size > m_dataSize - offset) {
+		return false;
+	}
+
+	record.header = header;
+	record.synapseGenes = reinterpret_cast<const HallOfFame::SynapseGeneRecord*>(data + layout.synapseGenes);
+	record.neuronGenes = reinterpret_cast<const HallOfFame::NeuronGeneRecord*>(data + layout.neuronGenes);
+
+	return record.network.load(data + layout.network, header->networkSize);
+}
@@ -0,0 +1,117 @@
+#ifndef NEAT_IO_HALLOFFAMEREADER_HPP_
+#define NEAT_IO_HALLOFFAMEREADER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "HallOfFame.hpp"
+#include "MappedFile.hpp"
+#include "../runtime/Network.hpp"
+
+/*
+ * Reads a HallOfFame. The index and the records are mapped, so opening costs next to
+ * nothing however large the archive, and a record is read where it lies: its genes
+ * are pointers into the mapping and its Network runs the arrays in the mapping.
+ *
+ * The reader sees the archive as it was when it was opened, records that were
+ * archived since are found after opening it again. The lookup tables by fitness and
+ * by structure are mapped as well if the archive was closed, and built on opening
+ * it if not.
+ */
+class HallOfFameReader {
+public:
+	using Entry = HallOfFame::Entry;
+	using GenerationEntry = HallOfFame::GenerationEntry;
+
+	struct Record {
+		const HallOfFame::RecordHeader* header;
+		const HallOfFame::SynapseGeneRecord* synapseGenes;
+		const HallOfFame::NeuronGeneRecord* neuronGenes;
+		Network network;
+	};
+
+private:
+	MappedFile m_indexFile;
+	MappedFile m_generationsFile;
+	MappedFile m_dataFile;
+
+	HallOfFame::IndexHeader m_header;
+	uint64_t m_numEntries;
+	uint64_t m_numGenerations;
+	uint64_t m_dataSize;
+	const Entry* m_entries;
+	const GenerationEntry* m_generations;
+
+	HallOfFame::Lookup m_lookup; // built if the archive was not closed
+	const uint32_t* m_byFitness;
+	const uint32_t* m_structureEntries;
+	const HallOfFame::StructureBucket* m_hashTable;
+	uint64_t m_hashTableSize;
+
+public:
+	HallOfFameReader();
+
+	HallOfFameReader(const HallOfFameReader&) = delete;
+	HallOfFameReader& operator=(const HallOfFameReader&) = delete;
+
+	bool open(const std::string& path);
+	void close();
+
+	size_t getNumEntries() const {
+		return m_numEntries;
+	}
+
+	const Entry& getEntry(const size_t entryIndex) const {
+		return m_entries[entryIndex];
+	}
+
+	uint64_t getFirstGeneration() const {
+		return m_header.firstGeneration;
+	}
+
+	uint64_t getNumGenerations() const {
+		return m_numGenerations;
+	}
+
+	// the entries of the generation, best first, none if it was not archived
+	GenerationEntry getGeneration(const uint64_t generationId) const {
+		if (generationId < m_header.firstGeneration || generationId - m_header.firstGeneration >= m_numGenerations) {
+			return {0, 0, 0};
+		}
+
+		return m_generations[generationId - m_header.firstGeneration];
+	}
+
+	// the entry of the n-th best record of the archive, 0 is the best
+	size_t getEntryByFitness(const size_t n) const {
+		return m_byFitness[n];
+	}
+
+	// calls function(entryIndex) for every record of the structure, in the order they were archived
+	template <typename Function>
+	void forEachEntryWithStructure(const uint64_t structuralHash, Function&& function) const;
+
+	// false if the record does not lie within the archive
+	bool getRecord(const size_t entryIndex, Record& record) const;
+};
+
+template <typename Function>
+void HallOfFameReader::forEachEntryWithStructure(const uint64_t structuralHash, Function&& function) const {
+	if (m_hashTableSize == 0) {
+		return;
+	}
+
+	const uint64_t mask = m_hashTableSize - 1;
+	for (size_t bucket = HallOfFame::getBucket(structuralHash, m_hashTableSize); m_hashTable[bucket].numEntries != 0; bucket = (bucket + 1) & mask) {
+		const HallOfFame::StructureBucket& structure = m_hashTable[bucket];
+		if (structure.structuralHash == structuralHash) {
+			for (uint32_t i(structure.firstEntry); i < structure.firstEntry + structure.numEntries; ++i) {
+				function(size_t(m_structureEntries[i]));
+			}
+			return;
+		}
+	}
+}
+
+#endif /* NEAT_IO_HALLOFFAMEREADER_HPP_ */
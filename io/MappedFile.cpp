@@ -0,0 +1,131 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <iostream>
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+	: m_data(nullptr)
+	, m_size(0)
+	, m_file(INVALID_HANDLE_VALUE)
+	, m_mapping(nullptr) {
+}
+
+bool MappedFile::open(const std::string& path) {
+	close();
+
+	m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_file, &size)) {
+		close();
+		return false;
+	}
+	m_size = static_cast<size_t>(size.QuadPart);
+	if (m_size == 0) {
+		return true;
+	}
+
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping == nullptr) {
+		std::cerr << "Could not map " << path << std::endl;
+		close();
+		return false;
+	}
+
+	m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (m_data == nullptr) {
+		std::cerr << "Could not map " << path << std::endl;
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::close() {
+	if (m_data != nullptr) {
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping != nullptr) {
+		CloseHandle(m_mapping);
+	}
+	if (m_file != INVALID_HANDLE_VALUE) {
+		CloseHandle(m_file);
+	}
+
+	m_data = nullptr;
+	m_size = 0;
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile()
+	: m_data(nullptr)
+	, m_size(0)
+	, m_file(-1) {
+}
+
+bool MappedFile::open(const std::string& path) {
+	close();
+
+	m_file = ::open(path.c_str(), O_RDONLY);
+	if (m_file < 0) {
+		return false;
+	}
+
+	struct stat status;
+	if (fstat(m_file, &status) != 0) {
+		close();
+		return false;
+	}
+	m_size = static_cast<size_t>(status.st_size);
+	if (m_size == 0) {
+		return true;
+	}
+
+	void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+	if (data == MAP_FAILED) {
+		std::cerr << "Could not map " << path << std::endl;
+		close();
+		return false;
+	}
+	m_data = static_cast<const char*>(data);
+
+	return true;
+}
+
+void MappedFile::close() {
+	if (m_data != nullptr) {
+		munmap(const_cast<char*>(m_data), m_size);
+	}
+	if (m_file >= 0) {
+		::close(m_file);
+	}
+
+	m_data = nullptr;
+	m_size = 0;
+	m_file = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
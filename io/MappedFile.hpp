@@ -0,0 +1,44 @@
+#ifndef NEAT_IO_MAPPEDFILE_HPP_
+#define NEAT_IO_MAPPEDFILE_HPP_
+
+#include <cstddef>
+#include <string>
+
+/*
+ * A whole file mapped read only into memory. The pages are read in by the operating
+ * system when they are first touched, so opening a large file costs next to nothing
+ * and only the parts that are used are ever read.
+ */
+class MappedFile {
+private:
+	const char* m_data;
+	size_t m_size;
+
+#ifdef _WIN32
+	void* m_file;
+	void* m_mapping;
+#else
+	int m_file;
+#endif
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// false if the file can not be opened or mapped, an empty file maps to no data
+	bool open(const std::string& path);
+	void close();
+
+	const char* getData() const {
+		return m_data;
+	}
+
+	size_t getSize() const {
+		return m_size;
+	}
+};
+
+#endif /* NEAT_IO_MAPPEDFILE_HPP_ */
@@ -0,0 +1,234 @@
+#include "NetworkExport.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include "Checkpoint.hpp"
+#include "../Phenotype.hpp"
+#include "../runtime/Network.hpp"
+
+#include <iostream>
+
+namespace {
+	template <typename T>
+	void copyArray(std::vector<char>& data, const uint64_t offset, const std::vector<T>& values) {
+		if (!values.empty()) {
+			std::memcpy(data.data() + offset, values.data(), values.size() * sizeof(T));
+		}
+	}
+
+	// C++ does not allow arrays of no elements, an empty one is written with a single unused 0
+	template <typename T>
+	void writeArray(std::ostream& stream, const char* type, const char* name, const std::vector<T>& values) {
+		stream << "constexpr " << type << " " << name << "[] = {";
+		for (size_t i(0); i < values.size(); ++i) {
+			stream << (i % 8 == 0 ? "\n\t" : " ") << +values[i] << (i + 1 < values.size() ? "," : "");
+		}
+		stream << (values.empty() ? "0};\n" : "\n};\n");
+	}
+
+	bool isIdentifier(const std::string& name) {
+		if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+			return false;
+		}
+
+		return std::all_of(name.begin(), name.end(), [](const char c) {
+			return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+		});
+	}
+}
+
+NetworkExport::PrunedNetwork NetworkExport::prune(const Phenotype& phenotype) {
+	const size_t numNodes = phenotype.getNumNodes();
+	const std::vector<uint8_t>& isInput = phenotype.getIsInput();
+	const std::vector<uint8_t>& isOutput = phenotype.getIsOutput();
+	const std::vector<uint32_t>& connectionOffsets = phenotype.getConnectionOffsets();
+	const std::vector<uint32_t>& connectionTargets = phenotype.getConnectionTargets();
+
+	// connections only lead forward, so walking the nodes backwards sees every target before its sources
+	std::vector<uint8_t> reachesOutput(numNodes, 0);
+	std::vector<uint8_t> isKept(numNodes, 0);
+	for (size_t nodeIndex(numNodes); nodeIndex-- > 0;) {
+		reachesOutput[nodeIndex] = isOutput[nodeIndex];
+		for (uint32_t connection(connectionOffsets[nodeIndex]); connection < connectionOffsets[nodeIndex + 1]; ++connection) {
+			reachesOutput[nodeIndex] |= reachesOutput[connectionTargets[connection]];
+		}
+		isKept[nodeIndex] = reachesOutput[nodeIndex] || isInput[nodeIndex];
+	}
+
+	PrunedNetwork network;
+
+	std::vector<uint32_t> newIndices(numNodes, std::numeric_limits<uint32_t>::max());
+	for (size_t nodeIndex(0); nodeIndex < numNodes; ++nodeIndex) {
+		if (isKept[nodeIndex]) {
+			newIndices[nodeIndex] = network.biases.size();
+			network.biases.push_back(phenotype.getBiases()[nodeIndex]);
+			network.nodeKinds.push_back(isOutput[nodeIndex] ? Network::Output : isInput[nodeIndex] ? Network::Input : Network::Hidden);
+		}
+	}
+
+	// the connections keep their order, as the kept nodes keep theirs
+	network.connectionOffsets.push_back(0);
+	for (size_t nodeIndex(0); nodeIndex < numNodes; ++nodeIndex) {
+		if (!isKept[nodeIndex]) {
+			continue;
+		}
+
+		for (uint32_t connection(connectionOffsets[nodeIndex]); connection < connectionOffsets[nodeIndex + 1]; ++connection) {
+			const uint32_t target = connectionTargets[connection];
+			if (isKept[target]) {
+				network.connectionTargets.push_back(newIndices[target]);
+				network.weights.push_back(phenotype.getWeights()[connection]);
+			}
+		}
+		network.connectionOffsets.push_back(network.connectionTargets.size());
+	}
+
+	for (const uint32_t inputIndex : phenotype.getInputIndices()) {
+		network.inputIndices.push_back(newIndices[inputIndex]);
+	}
+
+	for (const uint32_t outputIndex : phenotype.getOutputIndices()) {
+		network.outputIndices.push_back(newIndices[outputIndex]);
+	}
+
+	return network;
+}
+
+std::vector<char> NetworkExport::write(const Phenotype& phenotype) {
+	const PrunedNetwork network = prune(phenotype);
+
+	NetworkHeader header = {};
+	std::memcpy(header.magic, Network::magic, sizeof(header.magic));
+	header.version = Network::version;
+	header.numNodes = network.biases.size();
+	header.numConnections = network.weights.size();
+	header.numInputs = network.inputIndices.size();
+	header.numOutputs = network.outputIndices.size();
+
+	const NetworkLayout layout = Network::getLayout(header);
+	header.size = layout.size;
+
+	std::vector<char> data(layout.size, 0);
+	std::memcpy(data.data(), &header, sizeof(NetworkHeader));
+	copyArray(data, layout.biases, network.biases);
+	copyArray(data, layout.weights, network.weights);
+	copyArray(data, layout.connectionOffsets, network.connectionOffsets);
+	copyArray(data, layout.connectionTargets, network.connectionTargets);
+	copyArray(data, layout.inputIndices, network.inputIndices);
+	copyArray(data, layout.outputIndices, network.outputIndices);
+	copyArray(data, layout.nodeKinds, network.nodeKinds);
+
+	return data;
+}
+
+bool NetworkExport::save(const Genotype& genotype, const std::string& path) {
+	return Checkpoint::writeFile(write(Phenotype(genotype)), path);
+}
+
+std::string NetworkExport::writeHeader(const Phenotype& phenotype, const std::string& name) {
+	const PrunedNetwork network = prune(phenotype);
+
+	std::string guard = "NEAT_EXPORTED_" + name + "_HPP_";
+	std::transform(guard.begin(), guard.end(), guard.begin(), [](const char c) {
+		return std::toupper(static_cast<unsigned char>(c));
+	});
+
+	std::ostringstream stream;
+	stream << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+	stream << "/*\n"
+		<< " * A network of " << network.inputIndices.size() << " inputs, " << network.outputIndices.size() << " outputs, " << network.biases.size() << " nodes and " << network.weights.size() << " connections, exported by NetworkExport.\n"
+		<< " *\n"
+		<< " * " << name << "::execute(inputs, outputs) loads inputs[i] into input node -(i+1) and writes the outputs\n"
+		<< " * in ascending id order, as Phenotype::execute does. Every node and connection is a statement of\n"
+		<< " * its own, unrolled at compile time. The additions are made in the order Phenotype makes them, so\n"
+		<< " * the outputs are the same bit for bit, as long as both are compiled with the same floating point\n"
+		<< " * settings, neither with -ffast-math, and both with -ffp-contract=off: otherwise a multiplication\n"
+		<< " * and the addition after it may be fused into one instruction that rounds once, as it is by\n"
+		<< " * default at -O3 -march=native on targets with FMA. Needs C++17.\n"
+		<< " */\n"
+		<< "#ifndef " << guard << "\n"
+		<< "#define " << guard << "\n"
+		<< "\n"
+		<< "#include <cmath>\n"
+		<< "#include <cstddef>\n"
+		<< "#include <cstdint>\n"
+		<< "#include <utility>\n"
+		<< "\n"
+		<< "namespace " << name << " {\n"
+		<< "\n"
+		<< "constexpr std::size_t numInputs = " << network.inputIndices.size() << ";\n"
+		<< "constexpr std::size_t numOutputs = " << network.outputIndices.size() << ";\n"
+		<< "constexpr std::size_t numNodes = " << network.biases.size() << ";\n"
+		<< "\n"
+		<< "// 0 hidden, 1 input, 2 output\n";
+
+	writeArray(stream, "std::uint8_t", "nodeKinds", network.nodeKinds);
+	writeArray(stream, "double", "biases", network.biases);
+	writeArray(stream, "std::uint32_t", "connectionOffsets", network.connectionOffsets);
+	writeArray(stream, "std::uint32_t", "connectionTargets", network.connectionTargets);
+	writeArray(stream, "double", "weights", network.weights);
+	writeArray(stream, "std::uint32_t", "inputIndices", network.inputIndices);
+	writeArray(stream, "std::uint32_t", "outputIndices", network.outputIndices);
+
+	stream << "\n"
+		<< "namespace detail {\n"
+		<< "\n"
+		<< "inline double activateSigmoid(const double input) {\n"
+		<< "\treturn 1.0 / (1 + std::exp(-4.9 * input));\n"
+		<< "}\n"
+		<< "\n"
+		<< "template <std::size_t node, std::size_t... connections>\n"
+		<< "inline void runConnections(double* nodeInputs, const double output, std::index_sequence<connections...>) {\n"
+		<< "\t((nodeInputs[connectionTargets[connectionOffsets[node] + connections]] += weights[connectionOffsets[node] + connections] * output), ...);\n"
+		<< "}\n"
+		<< "\n"
+		<< "template <std::size_t node>\n"
+		<< "inline void runNode(double* nodeInputs) {\n"
+		<< "\tconst double rawOutput = nodeInputs[node] + biases[node];\n"
+		<< "\n"
+		<< "\t// outputs are read without activation, so they keep their raw value, and inputs are not activated\n"
+		<< "\tif constexpr (nodeKinds[node] == 2) {\n"
+		<< "\t\tnodeInputs[node] = rawOutput;\n"
+		<< "\t} else if constexpr (nodeKinds[node] == 1) {\n"
+		<< "\t\trunConnections<node>(nodeInputs, rawOutput, std::make_index_sequence<connectionOffsets[node + 1] - connectionOffsets[node]>());\n"
+		<< "\t} else {\n"
+		<< "\t\trunConnections<node>(nodeInputs, activateSigmoid(rawOutput), std::make_index_sequence<connectionOffsets[node + 1] - connectionOffsets[node]>());\n"
+		<< "\t}\n"
+		<< "}\n"
+		<< "\n"
+		<< "template <std::size_t... inputs, std::size_t... nodes, std::size_t... outputs>\n"
+		<< "inline void execute(const double* inputValues, double* outputValues, std::index_sequence<inputs...>, std::index_sequence<nodes...>, std::index_sequence<outputs...>) {\n"
+		<< "\tdouble nodeInputs[numNodes] = {};\n"
+		<< "\t((nodeInputs[inputIndices[inputs]] = inputValues[inputs]), ...);\n"
+		<< "\t(runNode<nodes>(nodeInputs), ...);\n"
+		<< "\t((outputValues[outputs] = nodeInputs[outputIndices[outputs]]), ...);\n"
+		<< "}\n"
+		<< "\n"
+		<< "} // namespace detail\n"
+		<< "\n"
+		<< "inline void execute(const double* inputs, double* outputs) {\n"
+		<< "\tdetail::execute(inputs, outputs, std::make_index_sequence<numInputs>(), std::make_index_sequence<numNodes>(), std::make_index_sequence<numOutputs>());\n"
+		<< "}\n"
+		<< "\n"
+		<< "} // namespace " << name << "\n"
+		<< "\n"
+		<< "#endif /* " << guard << " */\n";
+
+	return stream.str();
+}
+
+bool NetworkExport::saveHeader(const Genotype& genotype, const std::string& path, const std::string& name) {
+	if (!isIdentifier(name)) {
+		std::cerr << "Can not export a network as " << name << ", which is not a C++ identifier" << std::endl;
+		return false;
+	}
+
+	const std::string header = writeHeader(Phenotype(genotype), name);
+	return Checkpoint::writeFile(std::vector<char>(header.begin(), header.end()), path);
+}
@@ -0,0 +1,57 @@
+#ifndef NEAT_IO_NETWORKEXPORT_HPP_
+#define NEAT_IO_NETWORKEXPORT_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Genotype;
+class Phenotype;
+
+/*
+ * Exports compiled phenotypes for runtime/Network.hpp, which runs them without the
+ * rest of the project.
+ *
+ * The nodes that can not reach an output are left out with their connections, as
+ * nothing they compute is ever read. They only feed nodes that can not reach an
+ * output either, so every node that is kept receives the same inputs in the same
+ * order, and the exported network computes the same outputs bit for bit. The
+ * inputs are always kept, so they are loaded by position as before.
+ *
+ * A network can also be exported as a C++ header of its own, for controllers that
+ * should not even read a file. The arrays are constexpr and the inference is
+ * unrolled through templates into a statement per node and connection, so the
+ * compiler sees every index and weight and can optimise the whole network. It has
+ * to be compiled with -ffp-contract=off to compute the same outputs bit for bit,
+ * which exportcheck.cpp checks.
+ */
+class NetworkExport {
+private:
+	// the arrays of the exported network, see runtime/Network.hpp
+	struct PrunedNetwork {
+		std::vector<double> biases;
+		std::vector<uint8_t> nodeKinds;
+		std::vector<uint32_t> connectionOffsets;
+		std::vector<uint32_t> connectionTargets;
+		std::vector<double> weights;
+		std::vector<uint32_t> inputIndices;
+		std::vector<uint32_t> outputIndices;
+	};
+
+	static PrunedNetwork prune(const Phenotype& phenotype);
+
+public:
+	NetworkExport() = delete;
+
+	// the exported network as it would be written to a file
+	static std::vector<char> write(const Phenotype& phenotype);
+
+	static bool save(const Genotype& genotype, const std::string& path);
+
+	// the header that defines name::execute(inputs, outputs), name has to be a C++ identifier
+	static std::string writeHeader(const Phenotype& phenotype, const std::string& name);
+
+	static bool saveHeader(const Genotype& genotype, const std::string& path, const std::string& name);
+};
+
+#endif /* NEAT_IO_NETWORKEXPORT_HPP_ */
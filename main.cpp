@@ -1,9 +1,9 @@
 #include <iostream>
-#include <SFML/Graphics.hpp>
 #include "util/NumberGenerator.hpp"
 #include "Interface.hpp"
 
 #include "Population.hpp"
+#include "rendering/AsyncVisualizer.hpp"
 
 int main() {
 	NumberGenerator::initialize();
@@ -11,44 +11,24 @@ int main() {
 
 	const int width = 800;
 	const int height = 600;
-	sf::RenderWindow window(sf::VideoMode(width, height), "NEAT");
 
 	Population population(200, 7, 4); // Snake : (8, 3), Flappy bird : (3, 1) // Drone : (7, 4)
 
+	// the best episode of every generation is recorded, so the visualizer replays it instead of playing it again
+	population.setNumRecordedTrajectories(1);
+
 	for (int i(0); i < 0; ++i) {
 		NumberGenerator::getSym(1.0);
 	}
 
-	bool showFitnessRecord = true;
-	bool showSpeciesRecord = false;
-	bool showGenotype = true;
-	bool showPerformance = true;
-	double msPerFrame = 10;
-
-	while (window.isOpen()) {
-		sf::Event event;
-		while (window.pollEvent(event)) {
-			switch (event.type) {
-			case sf::Event::Closed:
-				window.close();
-				break;
-			case sf::Event::KeyPressed:
-				if (event.key.code == sf::Keyboard::P) {
-					showPerformance = !showPerformance;
-				} else if (event.key.code == sf::Keyboard::Escape)
-					window.close();
-				break;
-			default:
-				break;
-			}
-		}
+	// the champions are replayed on a thread of their own, evolution goes on in the meantime
+	AsyncVisualizer visualizer(width, height, "NEAT");
 
+	while (visualizer.isOpen()) {
 //		std::cout << "Scoring Generation!!" << std::endl;
 		population.scoreGenerationThreaded();
 //		std::cout << "Scored Generation!!" << std::endl;
-		if (showPerformance) {
-			population.perform(window, showFitnessRecord, showSpeciesRecord, showGenotype, showPerformance, msPerFrame);
-		}
+		visualizer.submit(population);
 		population.selection();
 	}
 
@@ -0,0 +1,76 @@
+#include "AsyncVisualizer.hpp"
+
+#include <chrono>
+
+AsyncVisualizer::AsyncVisualizer(const unsigned width, const unsigned height, const std::string& title)
+	: m_width(width)
+	, m_height(height)
+	, m_title(title)
+	, m_mutex()
+	, m_championSubmitted()
+	, m_pendingChampion()
+	, m_isOpen(true)
+	, m_isStopping(false)
+	, m_thread() {
+
+	m_thread = std::thread(&AsyncVisualizer::run, this);
+}
+
+AsyncVisualizer::~AsyncVisualizer() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isStopping = true;
+	}
+	m_championSubmitted.notify_one();
+
+	m_thread.join();
+}
+
+void AsyncVisualizer::submit(const Population& population) {
+	// the copy is made on the calling thread, the population is not touched by the render thread
+	std::unique_ptr<NEATVisualizer::Champion> champion = NEATVisualizer::takeChampion(population);
+	if (!champion) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pendingChampion = std::move(champion);
+	}
+	m_championSubmitted.notify_one();
+}
+
+void AsyncVisualizer::run() {
+	sf::RenderWindow window(sf::VideoMode(m_width, m_height), m_title);
+	NEATVisualizer visualizer;
+	NEATVisualizer::Settings settings;
+
+	while (window.isOpen() && !m_isStopping) {
+		NEATVisualizer::handleEvents(window, settings);
+
+		/*
+		 * The wait is bounded by a frame, so the window still answers to its events
+		 * while there is nothing to replay.
+		 */
+		std::unique_ptr<NEATVisualizer::Champion> champion;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_championSubmitted.wait_for(lock, std::chrono::microseconds(static_cast<int64_t>(settings.msPerFrame * 1000)), [this, &settings]() {
+				return (m_pendingChampion && settings.showPerformance) || m_isStopping;
+			});
+
+			if (settings.showPerformance) {
+				champion = std::move(m_pendingChampion);
+			}
+		}
+
+		if (champion) {
+			visualizer.replay(window, *champion, settings, m_isStopping);
+		}
+	}
+
+	if (window.isOpen()) {
+		window.close();
+	}
+	m_isOpen = false;
+}
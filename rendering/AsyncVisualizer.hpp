@@ -0,0 +1,59 @@
+#ifndef NEAT_RENDERING_ASYNCVISUALIZER_HPP_
+#define NEAT_RENDERING_ASYNCVISUALIZER_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "NEATVisualizer.hpp"
+
+class Population;
+
+/*
+ * Replays champions on a thread of its own, so evolution does not wait for the
+ * replay. The window is created, drawn and polled on that thread only.
+ *
+ * The training thread hands over every scored generation with submit(), which
+ * copies the champion and the records and returns right away. The render thread
+ * replays the newest champion it has when the previous replay ends, champions that
+ * were replaced before their turn are never shown. Between replays the render
+ * thread waits for the next champion without spinning.
+ */
+class AsyncVisualizer {
+private:
+	const unsigned m_width;
+	const unsigned m_height;
+	const std::string m_title;
+
+	std::mutex m_mutex;
+	std::condition_variable m_championSubmitted;
+	std::unique_ptr<NEATVisualizer::Champion> m_pendingChampion;
+
+	std::atomic<bool> m_isOpen;
+	std::atomic<bool> m_isStopping;
+
+	std::thread m_thread;
+
+private:
+	void run();
+
+public:
+	AsyncVisualizer(const unsigned width, const unsigned height, const std::string& title);
+	~AsyncVisualizer();
+
+	AsyncVisualizer(const AsyncVisualizer&) = delete;
+	AsyncVisualizer& operator=(const AsyncVisualizer&) = delete;
+
+	// called after scoring, before selection replaces the genotypes
+	void submit(const Population& population);
+
+	// false once the window was closed
+	bool isOpen() const {
+		return m_isOpen;
+	}
+};
+
+#endif /* NEAT_RENDERING_ASYNCVISUALIZER_HPP_ */
@@ -2,9 +2,11 @@
 
 #include <unordered_map>
 #include <utility>
+#include <string>
 
 #include "../DirectedAcyclicGraph.hpp"
 #include "../util/NumberGenerator.hpp"
+#include "../util/Hash.hpp"
 
 #include <iostream>
 
@@ -12,12 +14,45 @@ DAGRenderer::DAGRenderer()
 	: m_position({0, 0})
 	, m_nodeSpacing(0)
 	, m_layerSpacing(0)
-	, m_nodeRadius(0) {}
+	, m_nodeRadius(0)
+	, m_layouts()
+	, m_loadedHash(0)
+	, m_loadCounter(0) {}
+
+const sf::Font& DAGRenderer::getFont() {
+	static const sf::Font font = []() {
+		sf::Font loadedFont;
+		if (!loadedFont.loadFromFile("C:\\Windows\\Fonts\\arial.ttf")) {
+			std::cerr << "NO FONT" << std::endl;
+		}
+		return loadedFont;
+	}();
+
+	return font;
+}
+
+uint64_t DAGRenderer::hashDAG(const DirectedAcyclicGraph &dag, const float width, const float height) {
+	/*
+	 * The node order and depths decide where the nodes go. The connections are
+	 * summed, as the order of an unordered set says nothing about the graph.
+	 */
+	const auto &nodes = dag.getNodes();
 
-void DAGRenderer::addDrawableNode(const uint32_t depth, const id_t id) {
-	const std::vector<DrawableNode>& nodesInLayer = m_nodes[depth];
-	const uint32_t numNodesInLayer = nodesInLayer.size();
+	uint64_t hash = hashCombine(static_cast<uint64_t>(width * 1000), static_cast<uint64_t>(height * 1000));
+	uint64_t connectionHash = 0;
+	for (const id_t nodeId : dag.getNodeOrder()) {
+		const auto &node = nodes.find(nodeId)->second;
+		hash = hashCombine(hashCombine(hash, static_cast<uint64_t>(nodeId)), node.depth);
+
+		for (const id_t outputNodeId : node.outputNodeIds) {
+			connectionHash += mix64(hashCombine(static_cast<uint64_t>(nodeId), static_cast<uint64_t>(outputNodeId)));
+		}
+	}
+
+	return hashCombine(hash, connectionHash);
+}
 
+sf::Vector2f DAGRenderer::placeNode(const uint32_t depth, const uint32_t numNodesInLayer) const {
 	double y = 0.0;
 	if (numNodesInLayer > 0) {
 	    if (numNodesInLayer & 1) { // odd
@@ -34,15 +69,116 @@ void DAGRenderer::addDrawableNode(const uint32_t depth, const id_t id) {
 	const float randomDepthOffset = NumberGenerator::getSym(m_layerSpacing*0.1);
 	depthDistance += randomDepthOffset;
 
-	const sf::Vector2f nodePosition = m_position + sf::Vector2f(depthDistance, y);
-	DrawableNode node(nodePosition, m_nodeRadius, id);
+	return m_position + sf::Vector2f(depthDistance, y);
+}
+
+void DAGRenderer::addNode(Layout& layout, const sf::Vector2f& position, const id_t id) const {
+	// the circle as a fan of triangles around its center
+	for (unsigned i(0); i < circlePointCount; ++i) {
+		const double angle0 = i * 2 * M_PI / circlePointCount - M_PI / 2;
+		const double angle1 = (i + 1) * 2 * M_PI / circlePointCount - M_PI / 2;
+
+		layout.nodes.append(sf::Vertex(position, sf::Color::White));
+		layout.nodes.append(sf::Vertex(position + sf::Vector2f(std::cos(angle0) * m_nodeRadius, std::sin(angle0) * m_nodeRadius), sf::Color::White));
+		layout.nodes.append(sf::Vertex(position + sf::Vector2f(std::cos(angle1) * m_nodeRadius, std::sin(angle1) * m_nodeRadius), sf::Color::White));
+	}
+
+	/*
+	 * The label is laid out glyph by glyph like sf::Text does, and then centered on
+	 * the node by the bounds of its glyphs.
+	 */
+	const sf::Font& font = getFont();
+	const std::string label = std::to_string(id);
+	const size_t firstVertex = layout.labels.getVertexCount();
+
+	float x = 0;
+	float left = 0, top = 0, right = 0, bottom = 0;
+	for (size_t i(0); i < label.size(); ++i) {
+		if (i > 0) {
+			x += font.getKerning(label[i - 1], label[i], layout.characterSize);
+		}
+
+		const sf::Glyph& glyph = font.getGlyph(label[i], layout.characterSize, false);
+
+		const float x0 = x + glyph.bounds.left;
+		const float y0 = glyph.bounds.top;
+		const float x1 = x0 + glyph.bounds.width;
+		const float y1 = y0 + glyph.bounds.height;
+
+		const float u0 = glyph.textureRect.left;
+		const float v0 = glyph.textureRect.top;
+		const float u1 = u0 + glyph.textureRect.width;
+		const float v1 = v0 + glyph.textureRect.height;
+
+		const sf::Color black(0, 0, 0);
+		layout.labels.append(sf::Vertex(sf::Vector2f(x0, y0), black, sf::Vector2f(u0, v0)));
+		layout.labels.append(sf::Vertex(sf::Vector2f(x1, y0), black, sf::Vector2f(u1, v0)));
+		layout.labels.append(sf::Vertex(sf::Vector2f(x0, y1), black, sf::Vector2f(u0, v1)));
+		layout.labels.append(sf::Vertex(sf::Vector2f(x0, y1), black, sf::Vector2f(u0, v1)));
+		layout.labels.append(sf::Vertex(sf::Vector2f(x1, y0), black, sf::Vector2f(u1, v0)));
+		layout.labels.append(sf::Vertex(sf::Vector2f(x1, y1), black, sf::Vector2f(u1, v1)));
+
+		if (i == 0) {
+			left = x0;
+			top = y0;
+			right = x1;
+			bottom = y1;
+		} else {
+			left = std::min(left, x0);
+			top = std::min(top, y0);
+			right = std::max(right, x1);
+			bottom = std::max(bottom, y1);
+		}
+
+		x += glyph.advance;
+	}
 
-	m_nodes[depth].push_back(node);
+	const sf::Vector2f offset = position - sf::Vector2f(left + (right - left) / 2.0f, top + (bottom - top) / 2.0f);
+	for (size_t i(firstVertex); i < layout.labels.getVertexCount(); ++i) {
+		layout.labels[i].position += offset;
+	}
 }
 
-void DAGRenderer::loadDAG(const DirectedAcyclicGraph &dag, const float width, const float height) {
-	m_nodes.clear();
-	m_connections.clear();
+void DAGRenderer::addConnection(Layout& layout, const sf::Vector2f& startPosition, const sf::Vector2f& endPosition) const {
+	const float dx = endPosition.x - startPosition.x;
+	const float dy = endPosition.y - startPosition.y;
+
+	const float width = std::sqrt(dx*dx + dy*dy);
+	if (width <= 0) {
+		return;
+	}
+
+	const sf::Vector2f direction(dx / width, dy / width);
+	const sf::Vector2f normal(-direction.y, direction.x);
+
+	// the body is a rectangle along the connection, 2 triangles
+	const float halfHeight = 0.5f * m_nodeRadius / 5.0f;
+	const sf::Vector2f a = startPosition + normal * halfHeight;
+	const sf::Vector2f b = startPosition - normal * halfHeight;
+	const sf::Vector2f c = endPosition + normal * halfHeight;
+	const sf::Vector2f d = endPosition - normal * halfHeight;
+
+	layout.connections.append(sf::Vertex(a, sf::Color::White));
+	layout.connections.append(sf::Vertex(b, sf::Color::White));
+	layout.connections.append(sf::Vertex(c, sf::Color::White));
+	layout.connections.append(sf::Vertex(c, sf::Color::White));
+	layout.connections.append(sf::Vertex(b, sf::Color::White));
+	layout.connections.append(sf::Vertex(d, sf::Color::White));
+
+	// the head is a triangle pointing along the connection, just outside the end node
+	const float radius = 2 * m_nodeRadius / 5.0;
+	const sf::Vector2f headPosition = startPosition + (endPosition - startPosition) * ((width - m_nodeRadius - radius*0.6f) / width);
+	const double angle = std::atan2(dy, dx);
+	for (unsigned i(0); i < 3; ++i) {
+		const double pointAngle = angle + i * 2 * M_PI / 3;
+		layout.connections.append(sf::Vertex(headPosition + sf::Vector2f(std::cos(pointAngle) * radius, std::sin(pointAngle) * radius), sf::Color::White));
+	}
+}
+
+void DAGRenderer::buildLayout(Layout& layout, const DirectedAcyclicGraph &dag, const float width, const float height) {
+	layout.connections.setPrimitiveType(sf::Triangles);
+	layout.nodes.setPrimitiveType(sf::Triangles);
+	layout.labels.setPrimitiveType(sf::Triangles);
 
 	m_position = sf::Vector2f(width * 0.15, height / 2.0);
 
@@ -59,7 +195,6 @@ void DAGRenderer::loadDAG(const DirectedAcyclicGraph &dag, const float width, co
 
 		if (nodeDepth > graphDepth) {
 			++graphDepth;
-			m_nodes.push_back(std::vector<DrawableNode>());
 
 			numNodesInLayer.push_back(nodeCounter);
 			nodeCounter = 0;
@@ -95,56 +230,73 @@ void DAGRenderer::loadDAG(const DirectedAcyclicGraph &dag, const float width, co
 
 	// node radius
 	m_nodeRadius = std::min(m_nodeSpacing / 5.0, m_layerSpacing / 5.0);
+	layout.characterSize = static_cast<int>(m_nodeRadius * 1.5);
 
-	// Add drawable nodes
-	std::unordered_map<int, std::pair<int, int>> nodeIndexToPlace;
+	// Place nodes
+	std::vector<uint32_t> numPlacedInLayer(graphDepth + 1, 0);
+	std::unordered_map<id_t, sf::Vector2f> nodePositions;
 	for (id_t nodeIndex : nodeOrder) {
 		const auto &node = nodes.find(nodeIndex)->second;
 		const int nodeDepth = node.depth;
 
-		addDrawableNode(nodeDepth, nodeIndex);
-
-		const id_t nodeIndexAtDepth = m_nodes[nodeDepth].size() - 1;
-		nodeIndexToPlace[nodeIndex] = std::make_pair(nodeDepth, nodeIndexAtDepth);
+		const sf::Vector2f position = placeNode(nodeDepth, numPlacedInLayer[nodeDepth]++);
+		nodePositions[nodeIndex] = position;
+		addNode(layout, position, nodeIndex);
 	}
 
 //	int numConnections = 0;
 	for (id_t nodeIndex : nodeOrder) {
 		const auto &node = nodes.find(nodeIndex)->second;
-		const auto &outputNodeIndices = node.outputNodeIds;
+		const sf::Vector2f& startPosition = nodePositions[nodeIndex];
 
-		const auto& nodePlace = nodeIndexToPlace[nodeIndex];
-		const int depth = nodePlace.first;
-		const int index = nodePlace.second;
-		const sf::Vector2f& startPosition = m_nodes[depth][index].circle.getPosition();
+		for (id_t outputNodeIndex : node.outputNodeIds) {
+			addConnection(layout, startPosition, nodePositions[outputNodeIndex]);
 
-		for (id_t outputNodeIndex : outputNodeIndices) {
-			const auto& outputNodePlace = nodeIndexToPlace[outputNodeIndex];
-			const int outputDepth = outputNodePlace.first;
-			const int outputIndex = outputNodePlace.second;
-			const sf::Vector2f& endPosition = m_nodes[outputDepth][outputIndex].circle.getPosition();
+//			++numConnections;
+		}
+	}
 
-			m_connections.push_back(DrawableConnection(startPosition, endPosition, m_nodeRadius));
+//	std::cout << "Has loaded: " << nodeOrder.size() << " nodes into: " << graphDepth + 1 << " layers, with: " << numConnections << " connections!" << std::endl;
+}
 
-//			++numConnections;
+void DAGRenderer::loadDAG(const DirectedAcyclicGraph &dag, const float width, const float height) {
+	const uint64_t hash = hashDAG(dag, width, height);
+	++m_loadCounter;
+	m_loadedHash = hash;
+
+	const auto& layoutIt = m_layouts.find(hash);
+	if (layoutIt != m_layouts.end()) {
+		layoutIt->second.lastUsed = m_loadCounter;
+		return;
+	}
+
+	// make room by dropping the layout that was loaded longest ago
+	if (m_layouts.size() >= maxCachedLayouts) {
+		auto oldestIt = m_layouts.begin();
+		for (auto it = m_layouts.begin(); it != m_layouts.end(); ++it) {
+			if (it->second.lastUsed < oldestIt->second.lastUsed) {
+				oldestIt = it;
+			}
 		}
+		m_layouts.erase(oldestIt);
 	}
 
-//	std::cout << "Has loaded: " << numNodes << " nodes into: " << m_nodes.size() << " layers, with: " << numConnections << " connections!" << std::endl;
+	Layout& layout = m_layouts[hash];
+	buildLayout(layout, dag, width, height);
+	layout.lastUsed = m_loadCounter;
 }
 
 void DAGRenderer::render(sf::RenderWindow &window) {
-	for (const auto& connection : m_connections) {
-		window.draw(connection.arrowBody);
-		window.draw(connection.arrowHead);
+	const auto& layoutIt = m_layouts.find(m_loadedHash);
+	if (layoutIt == m_layouts.end()) {
+		return;
 	}
 
-	for (auto &nodesInLayer : m_nodes) {
-		for (auto &node : nodesInLayer) {
-			window.draw(node.circle);
+	const Layout& layout = layoutIt->second;
+	window.draw(layout.connections);
+	window.draw(layout.nodes);
 
-			node.text.setFont(node.font);
-			window.draw(node.text);
-		}
-	}
+	sf::RenderStates labelStates;
+	labelStates.texture = &getFont().getTexture(layout.characterSize);
+	window.draw(layout.labels, labelStates);
 }
@@ -3,73 +3,36 @@
 
 #include <vector>
 #include <cmath>
+#include <unordered_map>
 
 #include <SFML/Graphics.hpp>
 
 #include "../util/types.hpp"
 
-#include <iostream>
-
 class DirectedAcyclicGraph;
 
+/*
+ * Draws a graph as nodes in layers of equal depth with arrows between them.
+ *
+ * All shapes of a graph are built into three vertex arrays, the arrows, the node
+ * circles and the node labels, so a graph takes three draw calls however large it
+ * is. The labels are glyph quads on the texture of the one shared font. The built
+ * arrays are cached by a hash of the graph structure and the size they were laid
+ * out for, so loading a graph that was seen before (the champion of the previous
+ * generation, say) costs a hash and keeps the layout it had.
+ */
 class DAGRenderer {
 private:
-	struct DrawableNode {
-		sf::CircleShape circle;
-		sf::Font font;
-		sf::Text text;
-
-		DrawableNode(const sf::Vector2f& position, const double radius, const id_t id)
-			: circle(radius, 20), font(), text() {
-
-			circle.setOrigin(radius, radius);
-			circle.setPosition(position);
-
-			if (!font.loadFromFile("C:\\Windows\\Fonts\\arial.ttf")) {
-				std::cerr << "NO FONT" << std::endl;
-			}
-			text.setString(std::to_string(id));
-			text.setCharacterSize(static_cast<int>(radius * 1.5));
-			text.setFont(font);
-			sf::FloatRect textRect = text.getLocalBounds();
-			text.setOrigin(textRect.left + textRect.width/2.0f, textRect.top  + textRect.height/2.0f);
-			text.setPosition(position);
-			text.setFillColor(sf::Color(0, 0, 0));
-		}
+	struct Layout {
+		sf::VertexArray connections;
+		sf::VertexArray nodes;
+		sf::VertexArray labels;
+		unsigned characterSize = 0;
+		uint64_t lastUsed = 0;
 	};
 
-	struct DrawableConnection {
-		sf::RectangleShape arrowBody;
-		sf::CircleShape arrowHead;
-
-		DrawableConnection(const sf::Vector2f &startPosition, const sf::Vector2f &endPosition, const float nodeRadius) {
-			float x0, y0, x1, y1, dx, dy, width, height;
-			x0 = startPosition.x;
-			y0 = startPosition.y;
-			x1 = endPosition.x;
-			y1 = endPosition.y;
-
-			dx = x1 - x0;
-			dy = y1 - y0;
-
-			double angle = std::atan2(dy, dx)  * 180.0 / M_PI;
-
-			width = std::sqrt(dx*dx + dy*dy);
-			height = 1 * nodeRadius / 5.0;
-
-			arrowBody.setSize(sf::Vector2f(width, height));
-			arrowBody.setOrigin(0, 0.5*height);
-			arrowBody.setPosition(x0, y0);
-			arrowBody.setRotation(angle);
-
-			arrowHead.setPointCount(3);
-			const float radius = 2 * nodeRadius / 5.0;
-			arrowHead.setRadius(radius);
-			arrowHead.setOrigin(radius, radius);
-			arrowHead.setRotation(angle + 90);
-			arrowHead.setPosition(startPosition + (endPosition - startPosition) * (width - nodeRadius - radius*0.6f) / width);
-		}
-	};
+	static constexpr size_t maxCachedLayouts = 64;
+	static constexpr unsigned circlePointCount = 20;
 
 	sf::Vector2f m_position;
 
@@ -77,15 +40,24 @@ private:
 	float m_layerSpacing;
 	float m_nodeRadius;
 
-	std::vector<std::vector<DrawableNode>> m_nodes;
-	std::vector<DrawableConnection> m_connections;
+	std::unordered_map<uint64_t, Layout> m_layouts;
+	uint64_t m_loadedHash;
+	uint64_t m_loadCounter;
 
 private:
-	void addDrawableNode(const uint32_t depth, const id_t id);
+	static uint64_t hashDAG(const DirectedAcyclicGraph &dag, const float width, const float height);
+
+	sf::Vector2f placeNode(const uint32_t depth, const uint32_t numNodesInLayer) const;
+	void addNode(Layout& layout, const sf::Vector2f& position, const id_t id) const;
+	void addConnection(Layout& layout, const sf::Vector2f& startPosition, const sf::Vector2f& endPosition) const;
+	void buildLayout(Layout& layout, const DirectedAcyclicGraph &dag, const float width, const float height);
 
 public:
 	DAGRenderer();
 
+	// loaded from disk the first time it is asked for, and shared by everything that draws text
+	static const sf::Font& getFont();
+
 	void loadDAG(const DirectedAcyclicGraph &dag, const float width, const float height);
 	void render(sf::RenderWindow& window);
 };
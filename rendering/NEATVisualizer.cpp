@@ -1,2 +1,171 @@
 #include "NEATVisualizer.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <thread>
+
+#include "../Population.hpp"
+#include "../evaluation/ModelEvaluator.hpp"
+
+#include "Interface.hpp"
+#include "mvc/Model.hpp"
+
+#include <iostream>
+
+NEATVisualizer::Champion::Champion(const Genotype& genotype, const Population& population)
+	: genotype(genotype)
+	, phenotype(genotype)
+	, trajectory()
+	, fitnessRecord(population.getFitnessRecord())
+	, speciesRecord(population.getGenePool().getSpeciesRecord()) {
+}
+
+NEATVisualizer::NEATVisualizer()
+	: m_scoringVisualizer({0.4, 0.0, 0.6, 1.0})
+	, m_speciesRecordViewer(0.0, 0.5, 0.4, 0.5)
+	, m_fitnessRecordViewer(0.0, 0.0, 0.4, 0.5) {
+}
+
+std::unique_ptr<NEATVisualizer::Champion> NEATVisualizer::takeChampion(const Population& population) {
+	const Genotype* bestGenotype = population.getBestGenotypeInGeneration();
+	if (bestGenotype == nullptr) {
+		return nullptr;
+	}
+
+	std::unique_ptr<Champion> champion = std::make_unique<Champion>(*bestGenotype, population);
+
+	const Trajectory* trajectory = population.getBestTrajectory();
+	if (trajectory != nullptr) {
+		champion->trajectory = std::make_unique<Trajectory>(*trajectory);
+	}
+
+	return champion;
+}
+
+bool NEATVisualizer::handleEvents(sf::RenderWindow& window, Settings& settings) {
+	bool skip = false;
+
+	sf::Event event;
+	while (window.pollEvent(event)) {
+		switch (event.type) {
+		case sf::Event::Closed:
+			window.close();
+			break;
+		case sf::Event::KeyPressed:
+			if (event.key.code == sf::Keyboard::F) {
+				settings.showFitnessRecord = !settings.showFitnessRecord;
+			} else if (event.key.code == sf::Keyboard::S) {
+				settings.showSpeciesRecord = !settings.showSpeciesRecord;
+			} else if (event.key.code == sf::Keyboard::G) {
+				settings.showGenotype = !settings.showGenotype;
+			} else if (event.key.code == sf::Keyboard::P) {
+				settings.showPerformance = !settings.showPerformance;
+				skip = true;
+			} else if (event.key.code == sf::Keyboard::Space) {
+				skip = true;
+			} else if (event.key.code == sf::Keyboard::A) {
+				settings.msPerFrame = std::max(1.0, settings.msPerFrame - 1);
+			} else if (event.key.code == sf::Keyboard::D) {
+				settings.msPerFrame = std::min(100.0, settings.msPerFrame + 1);
+			} else if (event.key.code == sf::Keyboard::Escape) {
+				window.close();
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	return skip;
+}
+
+void NEATVisualizer::perform(sf::RenderWindow& window, const Population& population, bool& showFitnessRecord, bool& showSpeciesRecord, bool& showGenotype, bool& showPerformance, double& msPerFrame) {
+	std::unique_ptr<Champion> champion = takeChampion(population);
+	if (!champion) {
+		std::cerr << "There was no best genotype in this generation to perform!" << std::endl;
+		return;
+	}
+
+	Settings settings;
+	settings.showFitnessRecord = showFitnessRecord;
+	settings.showSpeciesRecord = showSpeciesRecord;
+	settings.showGenotype = showGenotype;
+	settings.showPerformance = showPerformance;
+	settings.msPerFrame = msPerFrame;
+
+	const std::atomic<bool> stop(false);
+	replay(window, *champion, settings, stop);
+
+	showFitnessRecord = settings.showFitnessRecord;
+	showSpeciesRecord = settings.showSpeciesRecord;
+	showGenotype = settings.showGenotype;
+	showPerformance = settings.showPerformance;
+	msPerFrame = settings.msPerFrame;
+}
+
+void NEATVisualizer::replay(sf::RenderWindow& window, Champion& champion, Settings& settings, const std::atomic<bool>& stop) {
+	m_scoringVisualizer.loadGenotype(window, champion.genotype);
+
+	// a recorded episode replays under the stream it was scored with, which the model is built under as well
+	const Trajectory* trajectory = champion.trajectory.get();
+	std::optional<NumberGenerator::ScopedStream> stream;
+	if (trajectory != nullptr) {
+		stream.emplace(trajectory->stream);
+	}
+
+//	FBModel model;
+//	Model model(Interface::getRandomSnake());
+	Model model;
+	uint64_t steps = 0;
+
+	auto nextFrame = std::chrono::steady_clock::now();
+
+	while (!model.gameIsOver() && window.isOpen() && !stop) {
+		// sleep until the next frame is due, instead of spinning on a clock
+		std::this_thread::sleep_until(nextFrame);
+		nextFrame = std::chrono::steady_clock::now() + std::chrono::microseconds(static_cast<int64_t>(settings.msPerFrame * 1000));
+
+		if (handleEvents(window, settings)) {
+			window.clear();
+			window.display();
+			break;
+		}
+
+		if (trajectory != nullptr) {
+			if (steps == trajectory->steps) {
+				break;
+			}
+			ModelEvaluator::replay(*trajectory, model, steps);
+		} else {
+			const std::unordered_map<id_t, double> inputs = Interface::generateInputs(model);
+//			const std::unordered_map<id_t, double> inputs = FBInterface::generateInputs(model);
+
+			const auto& outputs = champion.phenotype.execute(inputs);
+
+			Interface::interpretOutputs(model, outputs);
+//			FBInterface::interpretOutputs(model, outputs);
+		}
+
+		++steps;
+
+		window.clear();
+
+		if (settings.showGenotype) {
+			m_scoringVisualizer.renderGenotype(window);
+		}
+
+
+		m_scoringVisualizer.renderScoreboard(window, model.getScore());
+		m_scoringVisualizer.renderSimulation(window, model);
+
+		if (settings.showSpeciesRecord) {
+			m_speciesRecordViewer.renderSpeciesRecord(window, champion.speciesRecord);
+		}
+		if (settings.showFitnessRecord) {
+			m_fitnessRecordViewer.renderFitnessRecord(window, champion.fitnessRecord);
+		}
+
+		window.display();
+	}
+}
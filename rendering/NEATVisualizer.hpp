@@ -1,16 +1,73 @@
 #ifndef NEAT_RENDERING_NEATVISUALIZER_HPP_
 #define NEAT_RENDERING_NEATVISUALIZER_HPP_
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
 #include "ScoringVisualizer.hpp"
 #include "RecordViewer.hpp"
+#include "../Genotype.hpp"
+#include "../Phenotype.hpp"
+#include "../evaluation/Trajectory.hpp"
+
+class Population;
 
+/*
+ * Everything that draws the population. The population itself does not know about
+ * SFML, so training without a display only needs the core.
+ */
 class NEATVisualizer {
+public:
+	struct Settings {
+		bool showFitnessRecord = true;
+		bool showSpeciesRecord = false;
+		bool showGenotype = true;
+		bool showPerformance = true;
+		double msPerFrame = 10;
+	};
+
+	/*
+	 * A copy of everything a replay needs, so the champion can be replayed while the
+	 * population already moves on to the next generation.
+	 */
+	struct Champion {
+		Genotype genotype;
+		Phenotype phenotype;
+		std::unique_ptr<Trajectory> trajectory; // the scored episode, if it was recorded
+		History fitnessRecord;
+		History speciesRecord;
+
+		Champion(const Genotype& genotype, const Population& population);
+	};
+
 private:
 	ScoringVisualizer m_scoringVisualizer;
-	RecordViewer m_recordViewer;
+
+	RecordViewer m_speciesRecordViewer;
+	RecordViewer m_fitnessRecordViewer;
 
 public:
+	NEATVisualizer();
+
+	// the best genotype of the latest scored generation, or nullptr if there is none
+	static std::unique_ptr<Champion> takeChampion(const Population& population);
+
+	// returns whether the current replay should be skipped
+	static bool handleEvents(sf::RenderWindow& window, Settings& settings);
+
+	// plays the best genotype of the latest scored generation in the window
+	void perform(sf::RenderWindow& window, const Population& population, bool& showFitnessRecord, bool& showSpeciesRecord, bool& showGenotype, bool& showPerformance, double& msPerFrame);
 
+	/*
+	 * Plays the champion at the frame rate of the settings until its episode ends,
+	 * the window is closed, the replay is skipped or stop is set. Sleeps between
+	 * frames instead of spinning. A recorded episode is played back as it was scored,
+	 * otherwise the champion plays a new one.
+	 */
+	void replay(sf::RenderWindow& window, Champion& champion, Settings& settings, const std::atomic<bool>& stop);
 };
 
 #endif /* NEAT_RENDERING_NEATVISUALIZER_HPP_ */
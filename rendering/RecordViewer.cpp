@@ -1,47 +1,96 @@
 #include "RecordViewer.hpp"
 
+#include <algorithm>
+
 RecordViewer::RecordViewer(float x0, float y0, float x1, float y1)
-	: m_view() {
+	: m_view()
+	, m_speciesColumns()
+	, m_fitnessColumns()
+	, m_maxFitness(0) {
 	m_view.setViewport(sf::FloatRect(x0, y0, x1, y1));
-}
 
-void RecordViewer::renderSpeciesRecord(sf::RenderWindow& window, const std::vector<std::vector<double>>& speciesRecord) const {
-    // Calculate the total height of each row
-	const float rowHeight = m_view.getSize().y;
+	m_speciesColumns.vertices.setPrimitiveType(sf::Quads);
+	m_fitnessColumns.vertices.setPrimitiveType(sf::LineStrip);
+}
 
-    // Calculate row widths
-    const float viewWidth = m_view.getSize().x;
-    const float rowWidth = viewWidth / speciesRecord.size();
+size_t RecordViewer::getMaxColumns(const sf::RenderWindow& window) const {
+	// two columns per pixel, so a column only gets wider once the record has filled the view twice over
+	return 2 * std::max(1, window.getViewport(m_view).width);
+}
 
-    // Create a vertex array for drawing
-    sf::VertexArray bars(sf::Quads);
+void RecordViewer::resetColumns(Columns& columns, const uint64_t numGenerations, const size_t maxColumns) {
+	// a shorter record belongs to a different run
+	bool rebuild = numGenerations < columns.numGenerations;
+	if (rebuild) {
+		columns.generationsPerColumn = 1;
+	}
+
+	while ((numGenerations + columns.generationsPerColumn - 1) / columns.generationsPerColumn > maxColumns) {
+		columns.generationsPerColumn *= 2;
+		rebuild = true;
+	}
+
+	if (rebuild) {
+		columns.vertices.clear();
+		columns.numGenerations = 0;
+		columns.nextColumn = 0;
+	}
+}
 
+void RecordViewer::appendSpeciesColumn(const std::vector<double>& shares, const float x, const float width) {
     // Set up colors
     sf::Color color1 = sf::Color::Blue;
     sf::Color color2 = sf::Color::Red;
 
-    // Position and draw the bars
-    float xPosition = 0.0f;
-    float yPosition = 0.0f;
-    for (const auto& row : speciesRecord) {
-        float yOffset = 0.0f;
-        for (size_t i = 0; i < row.size(); ++i) {
-            float height = row[i] * rowHeight; // Scale the height
-            sf::Color color = (i % 2 == 0) ? color1 : color2;
-
-            // Add vertices for the bar
-            bars.append(sf::Vertex(sf::Vector2f(xPosition, yPosition + yOffset), color));
-            bars.append(sf::Vertex(sf::Vector2f(xPosition + rowWidth, yPosition + yOffset), color));
-            bars.append(sf::Vertex(sf::Vector2f(xPosition + rowWidth, yPosition + yOffset + height), color));
-            bars.append(sf::Vertex(sf::Vector2f(xPosition, yPosition + yOffset + height), color));
-
-            yOffset += height;
-        }
-        xPosition += rowWidth; // Spacing between bars
+    float yOffset = 0.0f;
+    for (size_t i = 0; i < shares.size(); ++i) {
+        float height = shares[i];
+        sf::Color color = (i % 2 == 0) ? color1 : color2;
+
+        // Add vertices for the bar
+        m_speciesColumns.vertices.append(sf::Vertex(sf::Vector2f(x, yOffset), color));
+        m_speciesColumns.vertices.append(sf::Vertex(sf::Vector2f(x + width, yOffset), color));
+        m_speciesColumns.vertices.append(sf::Vertex(sf::Vector2f(x + width, yOffset + height), color));
+        m_speciesColumns.vertices.append(sf::Vertex(sf::Vector2f(x, yOffset + height), color));
+
+        yOffset += height;
     }
+}
+
+void RecordViewer::updateSpeciesColumns(const History& speciesRecord, const size_t maxColumns) {
+	Columns& columns = m_speciesColumns;
+	resetColumns(columns, speciesRecord.getNumGenerations(), maxColumns);
+
+	const uint64_t generationsPerColumn = columns.generationsPerColumn;
+
+	// a column is added with the first bucket in it, and is as wide as the columns that bucket reaches into
+	speciesRecord.forEachBucket([&](const History::Bucket& bucket) {
+		const uint64_t column = std::max(bucket.firstGeneration, columns.numGenerations) / generationsPerColumn;
+		if (column < columns.nextColumn) {
+			return;
+		}
+
+		const uint64_t endGeneration = bucket.firstGeneration + bucket.numGenerations;
+		columns.nextColumn = (endGeneration + generationsPerColumn - 1) / generationsPerColumn;
+		appendSpeciesColumn(bucket.mean, column * generationsPerColumn, (columns.nextColumn - column) * generationsPerColumn);
+	}, columns.numGenerations);
+
+	columns.numGenerations = speciesRecord.getNumGenerations();
+}
+
+void RecordViewer::renderSpeciesRecord(sf::RenderWindow& window, const History& speciesRecord) {
+	if (speciesRecord.empty()) {
+		return;
+	}
+
+	updateSpeciesColumns(speciesRecord, getMaxColumns(window));
+
+	// generations are stretched over the width of the view, fractions over its height
+	sf::Transform transform;
+	transform.scale(m_view.getSize().x / speciesRecord.getNumGenerations(), m_view.getSize().y);
 
     window.setView(m_view);
-    window.draw(bars);
+    window.draw(m_speciesColumns.vertices, sf::RenderStates(transform));
 }
 
 //void RecordViewer::renderSpeciesRecord(sf::RenderWindow& window, const std::vector<std::vector<double>>& speciesRecord) const {
@@ -92,27 +141,59 @@ void RecordViewer::renderSpeciesRecord(sf::RenderWindow& window, const std::vect
 //    window.draw(bars);
 //}
 
-void RecordViewer::renderFitnessRecord(sf::RenderWindow &window, const std::vector<double>& fitnessRecord) const {
-    sf::VertexArray line(sf::LineStrip);
-
-    const float viewHeight = m_view.getSize().y;
-    const float middleHeight = viewHeight / 2.0f;
-    const float viewWidth = m_view.getSize().x;
-    const float width = viewWidth / fitnessRecord.size();
-
-    float max = *std::max_element(fitnessRecord.begin(), fitnessRecord.end());
+void RecordViewer::updateFitnessColumns(const History& fitnessRecord, const size_t maxColumns) {
+	Columns& columns = m_fitnessColumns;
+	resetColumns(columns, fitnessRecord.getNumGenerations(), maxColumns);
+	if (columns.numGenerations == 0) {
+		m_maxFitness = 0;
+	}
+
+	const uint64_t generationsPerColumn = columns.generationsPerColumn;
+
+	/*
+	 * Every column is a pair of vertices, its minimum and its maximum, which are
+	 * widened in place while the generations of the last column come in.
+	 */
+	fitnessRecord.forEachBucket([&](const History::Bucket& bucket) {
+		const float min = bucket.min.front();
+		const float max = bucket.max.front();
+		m_maxFitness = std::max(m_maxFitness, max);
+
+		const uint64_t column = std::max(bucket.firstGeneration, columns.numGenerations) / generationsPerColumn;
+		if (column < columns.nextColumn) {
+			const size_t lastVertex = columns.vertices.getVertexCount() - 1;
+			columns.vertices[lastVertex - 1].position.y = std::min(columns.vertices[lastVertex - 1].position.y, min);
+			columns.vertices[lastVertex].position.y = std::max(columns.vertices[lastVertex].position.y, max);
+			return;
+		}
+
+		const float x = column * generationsPerColumn;
+		columns.vertices.append(sf::Vertex(sf::Vector2f(x, min), sf::Color::Blue));
+		columns.vertices.append(sf::Vertex(sf::Vector2f(x, max), sf::Color::Blue));
+
+		const uint64_t endGeneration = bucket.firstGeneration + bucket.numGenerations;
+		columns.nextColumn = (endGeneration + generationsPerColumn - 1) / generationsPerColumn;
+	}, columns.numGenerations);
+
+	columns.numGenerations = fitnessRecord.getNumGenerations();
+}
 
-    for (size_t i = 0; i < fitnessRecord.size(); ++i) {
-        const float x = static_cast<float>(i * width);
+void RecordViewer::renderFitnessRecord(sf::RenderWindow &window, const History& fitnessRecord) {
+	if (fitnessRecord.empty()) {
+		return;
+	}
 
-        float y = static_cast<float>(fitnessRecord[i]);
-        y = y/max * viewHeight;
+	updateFitnessColumns(fitnessRecord, getMaxColumns(window));
 
-        y = 2*middleHeight - y; // flip
+    const float viewHeight = m_view.getSize().y;
+    const float viewWidth = m_view.getSize().x;
+    const float max = m_maxFitness > 0 ? m_maxFitness : 1.0f;
 
-        line.append(sf::Vertex(sf::Vector2f(x, y), sf::Color::Blue));
-    }
+	// the fitness is scaled by the best so far and flipped, so it grows upwards
+	sf::Transform transform;
+	transform.translate(0, viewHeight);
+	transform.scale(viewWidth / fitnessRecord.getNumGenerations(), -viewHeight / max);
 
     window.setView(m_view);
-    window.draw(line);
+    window.draw(m_fitnessColumns.vertices, sf::RenderStates(transform));
 }
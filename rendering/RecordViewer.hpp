@@ -6,16 +6,55 @@
 #include <SFML/Graphics.hpp>
 
 #include "../util/types.hpp"
+#include "../util/History.hpp"
 
+/*
+ * Draws the species and fitness records as they grow.
+ *
+ * The vertices are kept from frame to frame in record units (generations along x,
+ * fractions or fitness along y) and only the generations added since the last
+ * frame are appended. Fitting the record into the view is left to the transform
+ * it is drawn with.
+ *
+ * Once a record has more generations than the view has pixels across, every column
+ * covers a power of two of generations instead of one, so the buffers never hold
+ * more than about two columns per pixel. The fitness column keeps the minimum and
+ * the maximum of its generations, so no spike gets lost. The species column shows
+ * the mean shares of the first bucket it covers. Buckets the history has already
+ * merged into more generations than a column get a column as wide as they are.
+ * Whenever the columns get twice as wide, the buffer is rebuilt once at the new
+ * width.
+ */
 class RecordViewer {
 private:
+	struct Columns {
+		uint64_t generationsPerColumn = 1;
+		uint64_t numGenerations = 0; // generations of the record in the buffer
+		uint64_t nextColumn = 0;     // index of the first column that is not in the buffer
+		sf::VertexArray vertices;
+	};
+
 	sf::View m_view;
 
+	Columns m_speciesColumns;
+
+	Columns m_fitnessColumns;
+	float m_maxFitness;
+
+private:
+	size_t getMaxColumns(const sf::RenderWindow& window) const;
+
+	static void resetColumns(Columns& columns, const uint64_t numGenerations, const size_t maxColumns);
+
+	void appendSpeciesColumn(const std::vector<double>& shares, const float x, const float width);
+	void updateSpeciesColumns(const History& speciesRecord, const size_t maxColumns);
+	void updateFitnessColumns(const History& fitnessRecord, const size_t maxColumns);
+
 public:
 	RecordViewer(float x0, float y0, float x1, float y1);
 
-	void renderSpeciesRecord(sf::RenderWindow& window, const std::vector<std::vector<double>>& speciesRecord) const;
-	void renderFitnessRecord(sf::RenderWindow& window, const std::vector<double>& fitnessRecord) const;
+	void renderSpeciesRecord(sf::RenderWindow& window, const History& speciesRecord);
+	void renderFitnessRecord(sf::RenderWindow& window, const History& fitnessRecord);
 };
 
 #endif /* NEAT_RENDERING_RECORDVIEWER_HPP_ */
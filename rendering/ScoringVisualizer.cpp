@@ -8,8 +8,7 @@
 #include <iostream>
 
 ScoringVisualizer::ScoringVisualizer(const std::array<double, 4>& boundingRect)
-	: m_font()
-	, m_width(0)
+	: m_width(0)
 	, m_height(1)
 	, m_dagRenderer()
 	, m_scoreboardView()
@@ -21,10 +20,6 @@ ScoringVisualizer::ScoringVisualizer(const std::array<double, 4>& boundingRect)
 	m_width = boundingRect[2];
 	m_height = boundingRect[3];
 
-	if (!m_font.loadFromFile("C:\\Windows\\Fonts\\arial.ttf")) {
-		std::cerr << "NO FONT" << std::endl;
-	}
-
 	m_scoreboardView.setViewport(sf::FloatRect(x0 + 0.3 * m_width, y0, 0.7 * m_width, 0.2 * m_height));
 	m_genotypeView.setViewport(sf::FloatRect(x0, y0, 0.3 * m_width, m_height));
 	m_simulationView.setViewport(sf::FloatRect(x0 + 0.3 * m_width, y0 + 0.2*m_height, 0.7 * m_width, 0.8 * m_height));
@@ -42,7 +37,7 @@ void ScoringVisualizer::renderScoreboard(sf::RenderWindow &window, const double
 	sf::Text scoreText;
 	scoreText.setString("Score " + std::to_string(score));
 	scoreText.setCharacterSize(static_cast<int>(std::min(height / 2.0, width / 10.0)));
-	scoreText.setFont(m_font);
+	scoreText.setFont(DAGRenderer::getFont());
 	sf::Vector2f position(width / 10.0, height / 10.0);
 	scoreText.setPosition(position);
 	scoreText.setFillColor(sf::Color(200, 200, 200));
@@ -11,8 +11,6 @@ class Genotype;
 
 class ScoringVisualizer {
 private:
-	sf::Font m_font;
-
 	double m_width;
 	double m_height;
 
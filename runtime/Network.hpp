@@ -0,0 +1,353 @@
+#ifndef NEAT_RUNTIME_NETWORK_HPP_
+#define NEAT_RUNTIME_NETWORK_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Runs exported networks, for programs that only need to use a trained network. This
+ * header stands alone: it needs nothing of the rest of the project, so it can be
+ * copied into any program that should run one.
+ *
+ * An exported network is a compiled Phenotype with the nodes that can not reach an
+ * output left out, written by NetworkExport. The nodes are in execution order and
+ * the connections leaving node i are [connectionOffsets[i], connectionOffsets[i+1]),
+ * pointing at the index of the node they feed into, as in Phenotype. A file is a
+ * NetworkHeader followed by the arrays given by getLayout(), each aligned to 8 bytes,
+ * so a mapped file is run where it lies.
+ *
+ * Network runs the arrays of an exported network wherever they are in memory, and
+ * MappedNetwork maps a file to run. Executing writes only to the node inputs the
+ * caller provides, so it allocates nothing and any number of threads can run the
+ * same network. The outputs are the same, bit for bit, as those of
+ * Phenotype::execute(inputs, outputs) on the phenotype that was exported.
+ */
+struct NetworkHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t numNodes;
+	uint32_t numConnections;
+	uint32_t numInputs;
+	uint32_t numOutputs;
+	uint32_t padding;
+	uint64_t size; // of the whole network, header included
+};
+
+// offsets of the arrays from the start of the header
+struct NetworkLayout {
+	uint64_t biases;            // double[numNodes]
+	uint64_t weights;           // double[numConnections]
+	uint64_t connectionOffsets; // uint32_t[numNodes + 1]
+	uint64_t connectionTargets; // uint32_t[numConnections]
+	uint64_t inputIndices;      // uint32_t[numInputs], node index of input -1, -2, ...
+	uint64_t outputIndices;     // uint32_t[numOutputs], node index of the outputs in ascending id order
+	uint64_t nodeKinds;         // uint8_t[numNodes]
+	uint64_t size;
+};
+
+class Network {
+public:
+	static constexpr uint32_t version = 1;
+	static constexpr char magic[8] = {'N', 'E', 'A', 'T', 'N', 'E', 'T', 'W'};
+
+	// inputs are not activated and outputs keep their raw value, as in Phenotype
+	enum NodeKind : uint8_t {
+		Hidden,
+		Input,
+		Output
+	};
+
+private:
+	uint32_t m_numNodes;
+	uint32_t m_numConnections;
+	uint32_t m_numInputs;
+	uint32_t m_numOutputs;
+
+	const double* m_biases;
+	const double* m_weights;
+	const uint32_t* m_connectionOffsets;
+	const uint32_t* m_connectionTargets;
+	const uint32_t* m_inputIndices;
+	const uint32_t* m_outputIndices;
+	const uint8_t* m_nodeKinds;
+
+private:
+	static uint64_t align(const uint64_t offset) {
+		return (offset + 7) & ~uint64_t(7);
+	}
+
+	// the same function as Phenotype::activateSigmoid
+	static double activateSigmoid(const double input) {
+		return 1.0 / (1 + std::exp(-4.9 * input));
+	}
+
+public:
+	Network()
+		: m_numNodes(0)
+		, m_numConnections(0)
+		, m_numInputs(0)
+		, m_numOutputs(0)
+		, m_biases(nullptr)
+		, m_weights(nullptr)
+		, m_connectionOffsets(nullptr)
+		, m_connectionTargets(nullptr)
+		, m_inputIndices(nullptr)
+		, m_outputIndices(nullptr)
+		, m_nodeKinds(nullptr) {
+	}
+
+	static NetworkLayout getLayout(const NetworkHeader& header) {
+		NetworkLayout layout;
+		layout.biases = sizeof(NetworkHeader);
+		layout.weights = layout.biases + header.numNodes * sizeof(double);
+		layout.connectionOffsets = layout.weights + header.numConnections * sizeof(double);
+		layout.connectionTargets = align(layout.connectionOffsets + (header.numNodes + uint64_t(1)) * sizeof(uint32_t));
+		layout.inputIndices = align(layout.connectionTargets + header.numConnections * sizeof(uint32_t));
+		layout.outputIndices = align(layout.inputIndices + header.numInputs * sizeof(uint32_t));
+		layout.nodeKinds = align(layout.outputIndices + header.numOutputs * sizeof(uint32_t));
+		layout.size = align(layout.nodeKinds + header.numNodes);
+		return layout;
+	}
+
+	/*
+	 * Runs the exported network at data, which has to stay where it is for as long as
+	 * the network is run, aligned to 8 bytes. Checks that every index points into the
+	 * network, so a damaged file is refused instead of run. False if the data is not
+	 * a network of this version.
+	 */
+	bool load(const char* data, const size_t size) {
+		*this = Network();
+
+		NetworkHeader header;
+		if (data == nullptr || size < sizeof(NetworkHeader) || reinterpret_cast<uintptr_t>(data) % 8 != 0) {
+			return false;
+		}
+		std::memcpy(&header, data, sizeof(NetworkHeader));
+
+		const NetworkLayout layout = getLayout(header);
+		if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version || header.size != layout.size || layout.size > size) {
+			return false;
+		}
+
+		const uint32_t* connectionOffsets = reinterpret_cast<const uint32_t*>(data + layout.connectionOffsets);
+		const uint32_t* connectionTargets = reinterpret_cast<const uint32_t*>(data + layout.connectionTargets);
+		const uint32_t* inputIndices = reinterpret_cast<const uint32_t*>(data + layout.inputIndices);
+		const uint32_t* outputIndices = reinterpret_cast<const uint32_t*>(data + layout.outputIndices);
+
+		// connections only lead forward, which is what lets execute() run the nodes in order
+		if (connectionOffsets[0] != 0 || connectionOffsets[header.numNodes] != header.numConnections) {
+			return false;
+		}
+		for (uint32_t nodeIndex(0); nodeIndex < header.numNodes; ++nodeIndex) {
+			if (connectionOffsets[nodeIndex] > connectionOffsets[nodeIndex + 1]) {
+				return false;
+			}
+			for (uint32_t connection(connectionOffsets[nodeIndex]); connection < connectionOffsets[nodeIndex + 1]; ++connection) {
+				if (connectionTargets[connection] <= nodeIndex || connectionTargets[connection] >= header.numNodes) {
+					return false;
+				}
+			}
+		}
+		for (uint32_t i(0); i < header.numInputs; ++i) {
+			if (inputIndices[i] >= header.numNodes) {
+				return false;
+			}
+		}
+		for (uint32_t i(0); i < header.numOutputs; ++i) {
+			if (outputIndices[i] >= header.numNodes) {
+				return false;
+			}
+		}
+
+		m_numNodes = header.numNodes;
+		m_numConnections = header.numConnections;
+		m_numInputs = header.numInputs;
+		m_numOutputs = header.numOutputs;
+		m_biases = reinterpret_cast<const double*>(data + layout.biases);
+		m_weights = reinterpret_cast<const double*>(data + layout.weights);
+		m_connectionOffsets = connectionOffsets;
+		m_connectionTargets = connectionTargets;
+		m_inputIndices = inputIndices;
+		m_outputIndices = outputIndices;
+		m_nodeKinds = reinterpret_cast<const uint8_t*>(data + layout.nodeKinds);
+
+		return true;
+	}
+
+	uint32_t getNumNodes() const {
+		return m_numNodes;
+	}
+
+	uint32_t getNumConnections() const {
+		return m_numConnections;
+	}
+
+	uint32_t getNumInputs() const {
+		return m_numInputs;
+	}
+
+	uint32_t getNumOutputs() const {
+		return m_numOutputs;
+	}
+
+	// the number of node inputs execute() needs
+	size_t getScratchSize() const {
+		return m_numNodes;
+	}
+
+	/*
+	 * Executes the network with inputs[i] loaded into input node -(i+1), writing the
+	 * outputs in ascending id order. nodeInputs holds getScratchSize() values.
+	 */
+	void execute(const double* inputs, double* outputs, double* nodeInputs) const {
+		std::fill(nodeInputs, nodeInputs + m_numNodes, 0.0);
+
+		for (uint32_t i(0); i < m_numInputs; ++i) {
+			nodeInputs[m_inputIndices[i]] = inputs[i];
+		}
+
+		for (uint32_t nodeIndex(0); nodeIndex < m_numNodes; ++nodeIndex) {
+			const double rawOutput = nodeInputs[nodeIndex] + m_biases[nodeIndex];
+
+			if (m_nodeKinds[nodeIndex] == Output) {
+				nodeInputs[nodeIndex] = rawOutput;
+				continue;
+			}
+
+			const double output = m_nodeKinds[nodeIndex] == Input ? rawOutput : activateSigmoid(rawOutput);
+
+			const uint32_t end = m_connectionOffsets[nodeIndex + 1];
+			for (uint32_t connection(m_connectionOffsets[nodeIndex]); connection < end; ++connection) {
+				nodeInputs[m_connectionTargets[connection]] += m_weights[connection] * output;
+			}
+		}
+
+		for (uint32_t i(0); i < m_numOutputs; ++i) {
+			outputs[i] = nodeInputs[m_outputIndices[i]];
+		}
+	}
+};
+
+/*
+ * An exported network file, mapped read only. The pages are shared with every other
+ * program that maps the same file.
+ */
+class MappedNetwork {
+private:
+	const char* m_data;
+	size_t m_size;
+
+#ifdef _WIN32
+	HANDLE m_file;
+	HANDLE m_mapping;
+#else
+	int m_file;
+#endif
+
+	Network m_network;
+
+public:
+	MappedNetwork()
+		: m_data(nullptr)
+		, m_size(0)
+#ifdef _WIN32
+		, m_file(INVALID_HANDLE_VALUE)
+		, m_mapping(nullptr)
+#else
+		, m_file(-1)
+#endif
+		, m_network() {
+	}
+
+	~MappedNetwork() {
+		close();
+	}
+
+	MappedNetwork(const MappedNetwork&) = delete;
+	MappedNetwork& operator=(const MappedNetwork&) = delete;
+
+	// false if the file can not be mapped or is not a network of this version
+	bool open(const std::string& path) {
+		close();
+
+#ifdef _WIN32
+		m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		LARGE_INTEGER size;
+		if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+			close();
+			return false;
+		}
+		m_size = static_cast<size_t>(size.QuadPart);
+
+		m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		m_data = m_mapping != nullptr ? static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+#else
+		m_file = ::open(path.c_str(), O_RDONLY);
+		struct stat status;
+		if (m_file < 0 || fstat(m_file, &status) != 0 || status.st_size == 0) {
+			close();
+			return false;
+		}
+		m_size = static_cast<size_t>(status.st_size);
+
+		void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+		m_data = data != MAP_FAILED ? static_cast<const char*>(data) : nullptr;
+#endif
+
+		if (m_data == nullptr || !m_network.load(m_data, m_size)) {
+			close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void close() {
+#ifdef _WIN32
+		if (m_data != nullptr) {
+			UnmapViewOfFile(m_data);
+		}
+		if (m_mapping != nullptr) {
+			CloseHandle(m_mapping);
+		}
+		if (m_file != INVALID_HANDLE_VALUE) {
+			CloseHandle(m_file);
+		}
+		m_file = INVALID_HANDLE_VALUE;
+		m_mapping = nullptr;
+#else
+		if (m_data != nullptr) {
+			munmap(const_cast<char*>(m_data), m_size);
+		}
+		if (m_file >= 0) {
+			::close(m_file);
+		}
+		m_file = -1;
+#endif
+
+		m_data = nullptr;
+		m_size = 0;
+		m_network = Network();
+	}
+
+	const Network& getNetwork() const {
+		return m_network;
+	}
+};
+
+#endif /* NEAT_RUNTIME_NETWORK_HPP_ */
@@ -0,0 +1,22 @@
+#ifndef NEAT_UTIL_HASH_HPP_
+#define NEAT_UTIL_HASH_HPP_
+
+#include <cstdint>
+
+/*
+ * 64 bit hashing helpers. mix64 is the splitmix64 finalizer, which spreads every
+ * input bit over the whole output, so sums and combinations of mixed values stay
+ * well distributed.
+ */
+inline uint64_t mix64(uint64_t z) {
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+// order dependent: combining a, b differs from combining b, a
+inline uint64_t hashCombine(const uint64_t hash, const uint64_t value) {
+	return mix64(hash + 0x9E3779B97F4A7C15ULL + mix64(value));
+}
+
+#endif /* NEAT_UTIL_HASH_HPP_ */
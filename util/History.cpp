@@ -0,0 +1,94 @@
+#include "History.hpp"
+
+#include <algorithm>
+
+History::History(const size_t bucketsPerLevel, const size_t numLevels)
+	: m_levels(std::max<size_t>(1, numLevels))
+	, m_bucketsPerLevel(std::max<size_t>(2, bucketsPerLevel))
+	, m_numGenerations(0) {
+}
+
+void History::merge(Bucket& into, const Bucket& bucket) {
+	const size_t numValues = std::max(into.mean.size(), bucket.mean.size());
+	into.min.resize(numValues, 0.0);
+	into.max.resize(numValues, 0.0);
+	into.mean.resize(numValues, 0.0);
+
+	const double weight = static_cast<double>(bucket.numGenerations) / static_cast<double>(into.numGenerations + bucket.numGenerations);
+	for (size_t i(0); i < numValues; ++i) {
+		const bool hasValue = i < bucket.mean.size();
+		const double min = hasValue ? bucket.min[i] : 0.0;
+		const double max = hasValue ? bucket.max[i] : 0.0;
+		const double mean = hasValue ? bucket.mean[i] : 0.0;
+
+		into.min[i] = std::min(into.min[i], min);
+		into.max[i] = std::max(into.max[i], max);
+		into.mean[i] += (mean - into.mean[i]) * weight;
+	}
+
+	into.firstGeneration = std::min(into.firstGeneration, bucket.firstGeneration);
+	into.numGenerations += bucket.numGenerations;
+}
+
+void History::compact(const size_t level) {
+	std::deque<Bucket>& buckets = m_levels[level];
+	if (buckets.size() <= m_bucketsPerLevel) {
+		return;
+	}
+
+	// the last level has nowhere to go, so it halves itself
+	if (level + 1 == m_levels.size()) {
+		std::deque<Bucket> merged;
+		for (size_t i(0); i + 1 < buckets.size(); i += 2) {
+			merge(buckets[i], buckets[i + 1]);
+			merged.push_back(std::move(buckets[i]));
+		}
+		if (buckets.size() & 1) {
+			merged.push_back(std::move(buckets.back()));
+		}
+		buckets = std::move(merged);
+		return;
+	}
+
+	Bucket bucket = std::move(buckets.front());
+	buckets.pop_front();
+	merge(bucket, buckets.front());
+	buckets.pop_front();
+
+	// the next level holds older generations, so the bucket is its newest
+	m_levels[level + 1].push_back(std::move(bucket));
+	compact(level + 1);
+}
+
+void History::push(const std::vector<double>& values) {
+	Bucket bucket;
+	bucket.firstGeneration = m_numGenerations;
+	bucket.numGenerations = 1;
+	bucket.min = values;
+	bucket.max = values;
+	bucket.mean = values;
+
+	m_levels.front().push_back(std::move(bucket));
+	++m_numGenerations;
+
+	compact(0);
+}
+
+void History::push(const double value) {
+	push(std::vector<double>(1, value));
+}
+
+void History::clear() {
+	for (auto& buckets : m_levels) {
+		buckets.clear();
+	}
+	m_numGenerations = 0;
+}
+
+size_t History::getNumBuckets() const {
+	size_t numBuckets = 0;
+	for (const auto& buckets : m_levels) {
+		numBuckets += buckets.size();
+	}
+	return numBuckets;
+}
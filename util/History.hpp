@@ -0,0 +1,77 @@
+#ifndef NEAT_UTIL_HISTORY_HPP_
+#define NEAT_UTIL_HISTORY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/*
+ * A record of one row of values per generation, in bounded memory.
+ *
+ * The buckets are kept in levels of at most bucketsPerLevel buckets each. Level 0
+ * holds the newest generations, one per bucket. When a level is full, its two oldest
+ * buckets are merged into one bucket, which moves on to the next level. The buckets
+ * of a level therefore cover twice as many generations as the buckets of the level
+ * before. The last level merges its buckets pairwise in place when it is full. So the
+ * record never holds more than bucketsPerLevel * numLevels buckets, however long the
+ * run: the latest generations at full resolution, and older ones ever coarser.
+ *
+ * A bucket keeps the minimum, the maximum and the mean of every value over its
+ * generations. Rows can differ in length. A value that is missing from a row counts
+ * as 0.
+ */
+class History {
+	friend class Checkpoint;
+
+public:
+	struct Bucket {
+		uint64_t firstGeneration = 0;
+		uint64_t numGenerations = 0;
+		std::vector<double> min;
+		std::vector<double> max;
+		std::vector<double> mean;
+	};
+
+private:
+	std::vector<std::deque<Bucket>> m_levels; // newest first, the buckets of a level oldest first
+	size_t m_bucketsPerLevel;
+	uint64_t m_numGenerations;
+
+private:
+	static void merge(Bucket& into, const Bucket& bucket);
+
+	void compact(const size_t level);
+
+public:
+	History(const size_t bucketsPerLevel = 512, const size_t numLevels = 8);
+
+	void push(const std::vector<double>& values);
+	void push(const double value);
+
+	void clear();
+
+	// calls function with every bucket, oldest first, starting with the bucket that holds the given generation
+	template <typename Function>
+	void forEachBucket(Function&& function, const uint64_t fromGeneration = 0) const {
+		for (size_t level(m_levels.size()); level-- > 0;) {
+			for (const Bucket& bucket : m_levels[level]) {
+				if (bucket.firstGeneration + bucket.numGenerations > fromGeneration) {
+					function(bucket);
+				}
+			}
+		}
+	}
+
+	uint64_t getNumGenerations() const {
+		return m_numGenerations;
+	}
+
+	size_t getNumBuckets() const;
+
+	bool empty() const {
+		return m_numGenerations == 0;
+	}
+};
+
+#endif /* NEAT_UTIL_HISTORY_HPP_ */
@@ -1,6 +1,91 @@
 #include "NumberGenerator.hpp"
 
+#include <vector>
+
+#include "Hash.hpp"
+
 std::random_device NumberGenerator::rd;
-std::mt19937 NumberGenerator::gen;
-std::uniform_real_distribution<float> NumberGenerator::sym_distribution;
-std::uniform_real_distribution<float> NumberGenerator::asym_distribution;
+uint64_t NumberGenerator::seed = 0;
+std::atomic<uint64_t> NumberGenerator::seedEpoch(1);
+std::atomic<uint64_t> NumberGenerator::threadCounter(0);
+thread_local NumberGenerator::ThreadState NumberGenerator::threadState;
+
+void RandomStream::fillSym(double* values, const size_t count, const double range) {
+	fillASym(values, count, 2.0 * range);
+	for (size_t i(0); i < count; ++i) {
+		values[i] -= range;
+	}
+}
+
+void RandomStream::fillASym(double* values, const size_t count, const double range) {
+	/*
+	 * The raw outputs are generated a whole Philox block at a time into a scratch
+	 * buffer before being converted, which lets the conversion loop vectorize.
+	 */
+	static thread_local std::vector<Philox4x32::result_type> raw;
+	raw.resize(count);
+	m_engine.fill(raw.data(), count);
+
+	const double factor = range * scale;
+	for (size_t i(0); i < count; ++i) {
+		values[i] = raw[i] * factor;
+	}
+}
+
+NumberGenerator::ScopedStream::ScopedStream(const RandomStream& stream)
+	: m_stream(stream)
+	, m_previous(threadState.current) {
+	threadState.current = &m_stream;
+}
+
+NumberGenerator::ScopedStream::ScopedStream(const uint64_t generation, const uint64_t genomeId, const Purpose purpose)
+	: ScopedStream(createStream(generation, genomeId, purpose)) {}
+
+NumberGenerator::ScopedStream::~ScopedStream() {
+	threadState.current = m_previous;
+}
+
+NumberGenerator::StreamBinding::StreamBinding(RandomStream& stream)
+	: m_previous(threadState.current) {
+	threadState.current = &stream;
+}
+
+NumberGenerator::StreamBinding::~StreamBinding() {
+	threadState.current = m_previous;
+}
+
+uint64_t NumberGenerator::mixKey(const uint64_t key, const Purpose purpose) {
+	return mix64(key + (static_cast<uint64_t>(purpose) + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+void NumberGenerator::resetThreadStream(ThreadState& state) {
+	if (state.epoch == 0) {
+		state.ordinal = threadCounter.fetch_add(1);
+	}
+	state.epoch = seedEpoch.load();
+	state.defaultStream = createStream(0, state.ordinal, Purpose::Thread);
+}
+
+void NumberGenerator::initialize(const uint64_t newSeed) {
+	seed = newSeed;
+	++seedEpoch;
+
+	// The calling thread is re-seeded right away, the rest do so lazily.
+	resetThreadStream(threadState);
+}
+
+RandomStream NumberGenerator::getThreadStream() {
+	ThreadState& state = threadState;
+	if (state.epoch != seedEpoch.load(std::memory_order_relaxed)) {
+		resetThreadStream(state);
+	}
+	return state.defaultStream;
+}
+
+void NumberGenerator::setThreadStream(const RandomStream& stream) {
+	ThreadState& state = threadState;
+	if (state.epoch != seedEpoch.load(std::memory_order_relaxed)) {
+		resetThreadStream(state);
+	}
+	state.defaultStream = stream;
+}
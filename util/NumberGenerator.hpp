@@ -1,31 +1,192 @@
 #ifndef INCLUDE_NUMBERGENERATOR_HPP_
 #define INCLUDE_NUMBERGENERATOR_HPP_
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <random>
 
+#include "Philox.hpp"
+
+/*
+ * A single stream of uniformly distributed numbers.
+ *
+ * Streams are cheap value types. Two streams created from the same key and stream
+ * id produce identical sequences, no matter which thread they are used on.
+ */
+class RandomStream {
+private:
+	static constexpr double scale = 1.0 / 4294967296.0; // 2^-32
+
+	Philox4x32 m_engine;
+
+public:
+	RandomStream() : m_engine() {}
+	RandomStream(const uint64_t key, const uint64_t stream) : m_engine(key, stream) {}
+
+	// [0, 1)
+	double getUniform() {
+		return m_engine() * scale;
+	}
+
+	// [-range, range)
+	double getSym(double range) {
+		return range * (2.0 * getUniform() - 1.0);
+	}
+
+	// [0, range)
+	double getASym(double range) {
+		return range * getUniform();
+	}
+
+	void fillSym(double* values, const size_t count, const double range);
+	void fillASym(double* values, const size_t count, const double range);
+
+	Philox4x32& getEngine() {
+		return m_engine;
+	}
+
+	const Philox4x32& getEngine() const {
+		return m_engine;
+	}
+};
+
+/*
+ * Process wide access to random numbers.
+ *
+ * Every thread draws from its own stream, so the static interface is safe to call
+ * from anywhere. Work that has to be reproducible regardless of thread count or
+ * scheduling installs a ScopedStream derived from (seed, generation, genome id)
+ * for its duration, since the default per-thread streams depend on the order in
+ * which threads first ask for a number.
+ */
 class NumberGenerator {
+public:
+	/*
+	 * Separates the streams used for different steps on the same genome, so that
+	 * e.g. the crossover and the mutation of a child never share numbers.
+	 */
+	enum class Purpose : uint32_t {
+		Thread = 0,
+		Crossover,
+		StructuralMutation,
+		SplitSynapse,
+		GrowSynapse,
+		WeightMutation,
+		Evaluation,
+		SharedSeed // environment seeds every genome of a generation is evaluated on
+	};
+
+	class ScopedStream {
+	private:
+		RandomStream m_stream;
+		RandomStream* m_previous;
+
+	public:
+		ScopedStream(const RandomStream& stream);
+		ScopedStream(const uint64_t generation, const uint64_t genomeId, const Purpose purpose);
+		~ScopedStream();
+
+		ScopedStream(const ScopedStream&) = delete;
+		ScopedStream& operator=(const ScopedStream&) = delete;
+	};
+
+	/*
+	 * Like ScopedStream, but draws from a stream the caller keeps, so its position
+	 * carries over from one binding to the next. Lets interleaved work resume each
+	 * of its streams where it left off.
+	 */
+	class StreamBinding {
+	private:
+		RandomStream* m_previous;
+
+	public:
+		explicit StreamBinding(RandomStream& stream);
+		~StreamBinding();
+
+		StreamBinding(const StreamBinding&) = delete;
+		StreamBinding& operator=(const StreamBinding&) = delete;
+	};
+
+private:
+	static std::random_device rd;
+	static uint64_t seed;
+	static std::atomic<uint64_t> seedEpoch;
+	static std::atomic<uint64_t> threadCounter;
+
+	struct ThreadState {
+		RandomStream defaultStream;
+		RandomStream* current = nullptr;
+		uint64_t epoch = 0;
+		uint64_t ordinal = 0;
+	};
+
+	static thread_local ThreadState threadState;
+
 private:
-    static std::random_device rd;
-    static std::mt19937 gen;
-    static std::uniform_real_distribution<float> sym_distribution;
-    static std::uniform_real_distribution<float> asym_distribution;
+	static uint64_t mixKey(const uint64_t key, const Purpose purpose);
+	static void resetThreadStream(ThreadState& state);
+
+	static RandomStream& getStream() {
+		ThreadState& state = threadState;
+		if (state.current != nullptr) {
+			return *state.current;
+		}
+		if (state.epoch != seedEpoch.load(std::memory_order_relaxed)) {
+			resetThreadStream(state);
+		}
+		return state.defaultStream;
+	}
 
 public:
-    NumberGenerator() = delete; // Prevent instantiation
+	NumberGenerator() = delete; // Prevent instantiation
+
+	static void initialize() {
+		initialize((static_cast<uint64_t>(rd()) << 32) | rd());
+	}
+
+	/*
+	 * Must be called before any worker threads start drawing numbers.
+	 */
+	static void initialize(const uint64_t newSeed);
+
+	static uint64_t getSeed() {
+		return seed;
+	}
+
+	/*
+	 * The default stream of the calling thread, where it is now. Saved and restored
+	 * by checkpoints, so the draws that are not made on a ScopedStream go on where
+	 * they left off. Restoring has to follow initialize with the seed of the run.
+	 */
+	static RandomStream getThreadStream();
+	static void setThreadStream(const RandomStream& stream);
+
+	static RandomStream createStream(const uint64_t generation, const uint64_t genomeId, const Purpose purpose) {
+		return RandomStream(mixKey(seed, purpose), (generation << 32) | (genomeId & 0xFFFFFFFF));
+	}
+
+	// one of several independent streams for the same genome and purpose, index 0 is the stream above
+	static RandomStream createStream(const uint64_t generation, const uint64_t genomeId, const Purpose purpose, const uint64_t index) {
+		const uint64_t key = index == 0 ? mixKey(seed, purpose) : mixKey(mixKey(seed, purpose) ^ index, purpose);
+		return RandomStream(key, (generation << 32) | (genomeId & 0xFFFFFFFF));
+	}
+
+	static double getSym(double range) {
+		return getStream().getSym(range);
+	}
 
-    static void initialize() {
-        gen = std::mt19937(rd());
-        sym_distribution = std::uniform_real_distribution<float>(-1.0, 1.0);
-        asym_distribution = std::uniform_real_distribution<float>(0.0, 1.0);
-    }
+	static double getASym(double range) {
+		return getStream().getASym(range);
+	}
 
-    static double getSym(double range) {
-        return range * sym_distribution(gen);
-    }
+	static void fillSym(double* values, const size_t count, const double range) {
+		getStream().fillSym(values, count, range);
+	}
 
-    static double getASym(double range) {
-        return range * asym_distribution(gen);
-    }
+	static void fillASym(double* values, const size_t count, const double range) {
+		getStream().fillASym(values, count, range);
+	}
 };
 
 #endif /* INCLUDE_NUMBERGENERATOR_HPP_ */
@@ -0,0 +1,153 @@
+#ifndef NEAT_UTIL_PHILOX_HPP_
+#define NEAT_UTIL_PHILOX_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/*
+ * Philox4x32-10 counter-based random number generator (Salmon et al., "Parallel
+ * random numbers: as easy as 1, 2, 3").
+ *
+ * Every block of four outputs is a pure function of a 64 bit key and a 128 bit
+ * counter. The upper half of the counter selects the stream and the lower half is
+ * the position within it, so any stream can be created, or jumped ahead, in
+ * constant time without touching any shared state.
+ */
+class Philox4x32 {
+public:
+	using result_type = uint32_t;
+
+private:
+	static constexpr uint32_t multiplier0 = 0xD2511F53;
+	static constexpr uint32_t multiplier1 = 0xCD9E8D57;
+	static constexpr uint32_t weyl0 = 0x9E3779B9;
+	static constexpr uint32_t weyl1 = 0xBB67AE85;
+	static constexpr int rounds = 10;
+
+	std::array<uint32_t, 2> m_key;
+	uint64_t m_stream;
+	uint64_t m_position;
+
+	std::array<uint32_t, 4> m_block;
+	uint8_t m_blockIndex;
+
+private:
+	static void multiplyHighLow(const uint32_t a, const uint32_t b, uint32_t& high, uint32_t& low) {
+		const uint64_t product = static_cast<uint64_t>(a) * static_cast<uint64_t>(b);
+		high = static_cast<uint32_t>(product >> 32);
+		low = static_cast<uint32_t>(product);
+	}
+
+	void generateBlock() {
+		std::array<uint32_t, 4> counter = {
+			static_cast<uint32_t>(m_position),
+			static_cast<uint32_t>(m_position >> 32),
+			static_cast<uint32_t>(m_stream),
+			static_cast<uint32_t>(m_stream >> 32)
+		};
+		std::array<uint32_t, 2> key = m_key;
+
+		for (int round(0); round < rounds; ++round) {
+			uint32_t high0, low0, high1, low1;
+			multiplyHighLow(multiplier0, counter[0], high0, low0);
+			multiplyHighLow(multiplier1, counter[2], high1, low1);
+
+			counter = {high1 ^ counter[1] ^ key[0], low1, high0 ^ counter[3] ^ key[1], low0};
+
+			key[0] += weyl0;
+			key[1] += weyl1;
+		}
+
+		m_block = counter;
+		m_blockIndex = 0;
+		++m_position;
+	}
+
+public:
+	Philox4x32() : Philox4x32(0, 0) {}
+
+	Philox4x32(const uint64_t key, const uint64_t stream)
+		: m_key({static_cast<uint32_t>(key), static_cast<uint32_t>(key >> 32)})
+		, m_stream(stream)
+		, m_position(0)
+		, m_block()
+		, m_blockIndex(4) {}
+
+	static constexpr result_type min() {
+		return 0;
+	}
+
+	static constexpr result_type max() {
+		return std::numeric_limits<result_type>::max();
+	}
+
+	result_type operator()() {
+		if (m_blockIndex == 4) {
+			generateBlock();
+		}
+		return m_block[m_blockIndex++];
+	}
+
+	/*
+	 * Writes count raw outputs, a whole block at a time where possible.
+	 */
+	void fill(result_type* values, const size_t count) {
+		size_t i = 0;
+		while (i < count && m_blockIndex < 4) {
+			values[i++] = m_block[m_blockIndex++];
+		}
+		while (count - i >= 4) {
+			generateBlock();
+			values[i] = m_block[0];
+			values[i+1] = m_block[1];
+			values[i+2] = m_block[2];
+			values[i+3] = m_block[3];
+			m_blockIndex = 4;
+			i += 4;
+		}
+		while (i < count) {
+			values[i++] = (*this)();
+		}
+	}
+
+	/*
+	 * Skips ahead by a number of outputs in constant time.
+	 */
+	void discard(const uint64_t count) {
+		const uint64_t buffered = 4 - m_blockIndex;
+		if (count <= buffered) {
+			m_blockIndex += count;
+			return;
+		}
+
+		const uint64_t remaining = count - buffered;
+		m_position += remaining / 4;
+		m_blockIndex = 4;
+
+		const uint64_t offset = remaining % 4;
+		if (offset > 0) {
+			generateBlock();
+			m_blockIndex = offset;
+		}
+	}
+
+	uint64_t getKey() const {
+		return static_cast<uint64_t>(m_key[0]) | (static_cast<uint64_t>(m_key[1]) << 32);
+	}
+
+	uint64_t getStream() const {
+		return m_stream;
+	}
+
+	/*
+	 * The number of outputs consumed so far. Together with the key and the stream
+	 * this is the complete state of the generator.
+	 */
+	uint64_t getOffset() const {
+		return m_position * 4 - (4 - m_blockIndex);
+	}
+};
+
+#endif /* NEAT_UTIL_PHILOX_HPP_ */
@@ -0,0 +1,100 @@
+#ifndef NEAT_UTIL_SLOTPOOL_HPP_
+#define NEAT_UTIL_SLOTPOOL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "types.hpp"
+
+/*
+ * A dense array of items addressed by slot index.
+ *
+ * The whole contents are replaced at once, which bumps the pool generation. A
+ * handle remembers the generation it was taken in, so a handle held over from an
+ * earlier generation is recognised as stale instead of silently pointing at
+ * whatever item now occupies its slot. Data that belongs to the items (scores,
+ * flags, ...) lives in plain vectors indexed by the same slots.
+ */
+template<typename T>
+class SlotPool {
+public:
+	struct Handle {
+		slot_t slot = 0;
+		uint32_t generation = 0; // pools start at generation 1, so a default handle is never valid
+
+		bool operator==(const Handle& other) const {
+			return slot == other.slot && generation == other.generation;
+		}
+
+		bool operator!=(const Handle& other) const {
+			return !(*this == other);
+		}
+	};
+
+private:
+	std::vector<T> m_items;
+	uint32_t m_generation;
+
+public:
+	SlotPool() : m_items(), m_generation(0) {}
+
+	size_t size() const {
+		return m_items.size();
+	}
+
+	bool empty() const {
+		return m_items.empty();
+	}
+
+	T& operator[](const slot_t slot) {
+		return m_items[slot];
+	}
+
+	const T& operator[](const slot_t slot) const {
+		return m_items[slot];
+	}
+
+	typename std::vector<T>::iterator begin() {
+		return m_items.begin();
+	}
+
+	typename std::vector<T>::iterator end() {
+		return m_items.end();
+	}
+
+	typename std::vector<T>::const_iterator begin() const {
+		return m_items.begin();
+	}
+
+	typename std::vector<T>::const_iterator end() const {
+		return m_items.end();
+	}
+
+	uint32_t getGeneration() const {
+		return m_generation;
+	}
+
+	Handle getHandle(const slot_t slot) const {
+		return {slot, m_generation};
+	}
+
+	bool isValid(const Handle& handle) const {
+		return handle.generation == m_generation && handle.slot < m_items.size();
+	}
+
+	T& get(const Handle& handle) {
+		return m_items[handle.slot];
+	}
+
+	const T& get(const Handle& handle) const {
+		return m_items[handle.slot];
+	}
+
+	void replace(std::vector<T>&& items) {
+		m_items = std::move(items);
+		++m_generation;
+	}
+};
+
+#endif /* NEAT_UTIL_SLOTPOOL_HPP_ */
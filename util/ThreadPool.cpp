@@ -0,0 +1,199 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	double secondsBetween(const Clock::time_point start, const Clock::time_point end) {
+		return std::chrono::duration<double>(end - start).count();
+	}
+}
+
+double ThreadPool::Stats::getUtilisation() const {
+	if (workers.empty() || wallSeconds <= 0) {
+		return 0;
+	}
+
+	double busySeconds = 0;
+	for (const auto& worker : workers) {
+		busySeconds += worker.busySeconds;
+	}
+
+	return busySeconds / (wallSeconds * workers.size());
+}
+
+ThreadPool::ThreadPool(unsigned numThreads)
+	: m_queues()
+	, m_threads()
+	, m_mutex()
+	, m_startCondition()
+	, m_doneCondition()
+	, m_batchIndex(0)
+	, m_numWorkersDone(0)
+	, m_stopping(false)
+	, m_task(nullptr)
+	, m_numTasksLeft(0)
+	, m_stats() {
+
+	if (numThreads == 0) {
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	for (unsigned i(0); i < numThreads; ++i) {
+		m_queues.push_back(std::make_unique<WorkerQueue>());
+	}
+
+	// worker 0 is whichever thread calls run()
+	for (unsigned i(1); i < numThreads; ++i) {
+		m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_startCondition.notify_all();
+
+	for (auto& thread : m_threads) {
+		thread.join();
+	}
+}
+
+bool ThreadPool::popOwn(const unsigned workerIndex, size_t& taskIndex) {
+	WorkerQueue& queue = *m_queues[workerIndex];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+
+	if (queue.taskIndices.empty()) {
+		return false;
+	}
+
+	taskIndex = queue.taskIndices.front();
+	queue.taskIndices.pop_front();
+	return true;
+}
+
+bool ThreadPool::steal(const unsigned workerIndex, size_t& taskIndex) {
+	/*
+	 * Victims are visited starting from the next worker over, so that thieves
+	 * spread out instead of all queueing up on worker 0. Stealing takes from the
+	 * front like the owner does, so that when the tasks are ordered by priority a
+	 * thief picks up the most important task left instead of the least important.
+	 */
+	const unsigned numWorkers = m_queues.size();
+	for (unsigned offset(1); offset < numWorkers; ++offset) {
+		WorkerQueue& queue = *m_queues[(workerIndex + offset) % numWorkers];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (!queue.taskIndices.empty()) {
+			taskIndex = queue.taskIndices.front();
+			queue.taskIndices.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void ThreadPool::work(const unsigned workerIndex) {
+	WorkerStats& stats = m_stats.workers[workerIndex];
+
+	/*
+	 * No tasks are added while a batch is running, so once neither the own queue
+	 * nor any other queue has anything left this worker is finished.
+	 */
+	while (m_numTasksLeft.load(std::memory_order_acquire) > 0) {
+		size_t taskIndex;
+		if (popOwn(workerIndex, taskIndex)) {
+			// own task
+		} else if (steal(workerIndex, taskIndex)) {
+			++stats.tasksStolen;
+		} else {
+			break;
+		}
+
+		const Clock::time_point start = Clock::now();
+		(*m_task)(taskIndex, workerIndex);
+		stats.busySeconds += secondsBetween(start, Clock::now());
+		++stats.tasksExecuted;
+
+		m_numTasksLeft.fetch_sub(1, std::memory_order_acq_rel);
+	}
+}
+
+void ThreadPool::workerLoop(const unsigned workerIndex) {
+	uint64_t seenBatchIndex = 0;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_startCondition.wait(lock, [this, seenBatchIndex]() {
+				return m_stopping || m_batchIndex != seenBatchIndex;
+			});
+
+			if (m_stopping) {
+				return;
+			}
+			seenBatchIndex = m_batchIndex;
+		}
+
+		work(workerIndex);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			++m_numWorkersDone;
+		}
+		m_doneCondition.notify_one();
+	}
+}
+
+void ThreadPool::run(const std::vector<size_t>& order, const Task& task) {
+	const unsigned numWorkers = m_queues.size();
+	const Clock::time_point start = Clock::now();
+
+	m_stats.workers.assign(numWorkers, WorkerStats());
+
+	if (order.empty()) {
+		m_stats.wallSeconds = 0;
+		return;
+	}
+
+	// deal the tasks out round-robin, so every worker starts at the front of the order
+	for (size_t i(0); i < order.size(); ++i) {
+		m_queues[i % numWorkers]->taskIndices.push_back(order[i]);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_task = &task;
+		m_numTasksLeft.store(order.size(), std::memory_order_release);
+		m_numWorkersDone = 0;
+		++m_batchIndex;
+	}
+	m_startCondition.notify_all();
+
+	work(0);
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_doneCondition.wait(lock, [this, numWorkers]() {
+			return m_numWorkersDone == numWorkers - 1;
+		});
+		m_task = nullptr;
+	}
+
+	m_stats.wallSeconds = secondsBetween(start, Clock::now());
+	for (auto& workerStats : m_stats.workers) {
+		workerStats.idleSeconds = m_stats.wallSeconds - workerStats.busySeconds;
+	}
+}
+
+void ThreadPool::run(const size_t numTasks, const Task& task) {
+	std::vector<size_t> order(numTasks);
+	std::iota(order.begin(), order.end(), 0);
+	run(order, task);
+}
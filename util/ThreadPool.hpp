@@ -0,0 +1,97 @@
+#ifndef NEAT_UTIL_THREADPOOL_HPP_
+#define NEAT_UTIL_THREADPOOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * A fixed set of worker threads that live as long as the pool.
+ *
+ * Work is submitted as a batch of indexed tasks. The tasks are dealt out to
+ * per-worker deques, and a worker that runs out of work steals from another
+ * worker's deque, so a few long tasks no longer hold up the whole batch.
+ * The calling thread takes part as worker 0 and run() returns once every task of
+ * the batch has finished.
+ */
+class ThreadPool {
+public:
+	using Task = std::function<void(const size_t taskIndex, const unsigned workerIndex)>;
+
+	struct WorkerStats {
+		uint64_t tasksExecuted = 0;
+		uint64_t tasksStolen = 0;
+		double busySeconds = 0;
+		double idleSeconds = 0;
+	};
+
+	/*
+	 * Statistics of the latest call to run().
+	 */
+	struct Stats {
+		double wallSeconds = 0;
+		std::vector<WorkerStats> workers;
+
+		// fraction of the available worker time spent executing tasks
+		double getUtilisation() const;
+	};
+
+private:
+	struct WorkerQueue {
+		std::mutex mutex;
+		std::deque<size_t> taskIndices;
+	};
+
+	std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+	std::vector<std::thread> m_threads;
+
+	std::mutex m_mutex;
+	std::condition_variable m_startCondition;
+	std::condition_variable m_doneCondition;
+	uint64_t m_batchIndex;
+	unsigned m_numWorkersDone;
+	bool m_stopping;
+
+	const Task* m_task;
+	std::atomic<size_t> m_numTasksLeft;
+
+	Stats m_stats;
+
+private:
+	bool popOwn(const unsigned workerIndex, size_t& taskIndex);
+	bool steal(const unsigned workerIndex, size_t& taskIndex);
+	void work(const unsigned workerIndex);
+	void workerLoop(const unsigned workerIndex);
+
+public:
+	// 0 threads means one per hardware thread
+	explicit ThreadPool(unsigned numThreads = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	unsigned getNumWorkers() const {
+		return m_queues.size();
+	}
+
+	/*
+	 * Runs task(i, worker) for every i in order. The order is a hint of which
+	 * tasks to start first; tasks are dealt round-robin in that order, so every
+	 * worker begins at the front of the list.
+	 */
+	void run(const std::vector<size_t>& order, const Task& task);
+	void run(const size_t numTasks, const Task& task);
+
+	const Stats& getStats() const {
+		return m_stats;
+	}
+};
+
+#endif /* NEAT_UTIL_THREADPOOL_HPP_ */
@@ -7,6 +7,7 @@
 
 using innov_t = uint32_t;
 using id_t = int;
+using slot_t = uint32_t;
 
 struct SzudzikHash {
     std::size_t operator()(const std::pair<uint32_t, uint32_t>& p) const {